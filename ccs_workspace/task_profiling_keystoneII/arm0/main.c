@@ -10,7 +10,7 @@
  |                for analyzing the effect of different
  |                benchmarks on the system.
  |
- |  Version: 1.0V
+ |  Version: 1.2V
  |
  | Contact:
  | alfonso.mascarenas-gonzalez@isae-supaero.fr
@@ -26,6 +26,7 @@
 #include "benchmarks.h"
 #include "MMU.h"
 #include "PMH.h"
+#include "pmu_counter_source.h"
 #include "UART.h"
 #include "MSMC.h"
 #include "DDR3MemoryController.h"
@@ -35,6 +36,7 @@
 void ARM_disable_caches();
 void ARM_init(unsigned tlb1_pos);
 void counters_init();
+void counters_calibrate(unsigned nb_runs);
 void critical_task_start_eval();
 void critical_task_end_eval();
 void DDR_configure_eval(unsigned filter_events);
@@ -47,6 +49,8 @@ void configure_AXI(unsigned priority);
 
 // Iteration number
 #define  MAX_ITERATIONS 100
+// Number of empty start/stop pairs used to measure the probe cost
+#define PMU_CALIBRATION_RUNS 1000
 // ARM configuration mode. 0 = only L1 instruction cache, 1 = all caches plus others (MMU, branch predictor...)
 #define ARM_INIT_CONFIGURATION   0
 
@@ -88,8 +92,13 @@ void configure_AXI(unsigned priority);
 #define event_id_4   0x17
 #define event_id_5   0x10
 
+// Events tracked by counters 0 to 5
+const unsigned counters_event_ids[PMU_NB_EVT_COUNTERS] = {event_id_0, event_id_1, event_id_2, event_id_3, event_id_4, event_id_5};
+
 // ARM performance counter final read variables
 unsigned long value0f = 0, value1f = 0, value2f = 0, value3f = 0, value4f = 0, value5f = 0, valueCf = 0;
+// ARM performance counter probe cost, zero until counters_calibrate is called, then removed from every measurement
+struct pmu_snapshot pmu_overhead;
 // EMIF0 performance counters initial and final read variables
 unsigned t1_ddr_cycles_emif0,t2_ddr_cycles_emif0, result_ddr_cycles_emif0, t1_ddr_evt0_emif0, t2_ddr_evt0_emif0, result_ddr_evt0_emif0, t1_ddr_evt1_emif0, t2_ddr_evt1_emif0, result_ddr_evt1_emif0;
 
@@ -127,12 +136,18 @@ int main(void)
     // Configure ARM Cortex A15 performance counters
     counters_init();
 
+    // Measure the probe cost, which is then removed from every PMU measurement
+    counters_calibrate(PMU_CALIBRATION_RUNS);
+
     write_UART_THR("Task profiling: Start-Stop pattern on ARMs \n\r");
     write_UART_THR("Task profiling: Start-Read pattern on memory controller \n\r");
 
     unsigned i = 0;
     char data_str[128];
 
+    sprintf(data_str, "PMU probe cost (subtracted): %u %u %u %u %u %u %u \n\r", pmu_overhead.cycles, pmu_overhead.evt[0], pmu_overhead.evt[1], pmu_overhead.evt[2], pmu_overhead.evt[3], pmu_overhead.evt[4], pmu_overhead.evt[5]);
+    write_UART_THR(data_str);
+
 
     /* Start tasks profiling */
     /*************************/
@@ -277,6 +292,46 @@ void configure_AXI(unsigned priority){
 
 }
 
+/* armv7_init, armv7_start, armv7_stop, armv7_read
+ *
+ * Description: ARMv7 PMU implementation of the counter source, so that the probe cost is calibrated and removed
+ *              by pmu_calibrate and pmu_subtract_overhead as in the other profiling projects
+ *
+ * */
+static int armv7_init(const unsigned* events, unsigned nb_events){
+    unsigned i;
+
+    if(nb_events > PMU_NB_EVT_COUNTERS)
+        return -1;
+
+    for(i = 0; i < nb_events; i++){
+        select_evt_counter(i);
+        event_track(events[i]);
+    }
+
+    return 0;
+}
+
+static void armv7_start(void){
+    critical_task_start_eval();
+}
+
+static void armv7_stop(struct pmu_snapshot* snapshot){
+
+    // Disable counters
+    disable_all_counters(0x3F);
+
+    // Read the cycle counter and the six event counters back-to-back
+    read_all_counters(&snapshot->cycles, snapshot->evt);
+}
+
+static void armv7_read(struct pmu_snapshot* snapshot){
+    read_all_counters(&snapshot->cycles, snapshot->evt);
+}
+
+const struct pmu_counter_source pmu_armv7_source = {"armv7", armv7_init, armv7_start, armv7_stop, armv7_read};
+
+
 /* counters_init
  *
  * Description: Sets the events for each ARM Cortex A15 performance counters
@@ -287,28 +342,23 @@ void configure_AXI(unsigned priority){
  *
  * */
 volatile void counters_init(){
-    // Select counter to program: counter_number can be between 0-5
-    select_evt_counter(counter_id_0);
-
-    // Select event to track in selected counter: event_id numbers are in the ARM A15 TRM
-    event_track(event_id_0);
-
-    select_evt_counter(counter_id_1);
-    event_track(event_id_1);
-
-    select_evt_counter(counter_id_2);
-    event_track(event_id_2);
-
-    select_evt_counter(counter_id_3);
-    event_track(event_id_3);
-
-    select_evt_counter(counter_id_4);
-    event_track(event_id_4);
-
-    select_evt_counter(counter_id_5);
-    event_track(event_id_5);
+    armv7_init(counters_event_ids, PMU_NB_EVT_COUNTERS);
+}
 
 
+/* counters_calibrate
+ *
+ * Description: Measures the probe cost through empty start/stop pairs of the ARMv7 counter source (see pmu_calibrate).
+ *              From then on, critical_task_end_eval subtracts it from every value read.
+ *
+ * Parameter:
+ *              - unsigned nb_runs: Number of empty start/stop pairs measured
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_calibrate(unsigned nb_runs){
+    pmu_calibrate(&pmu_armv7_source, nb_runs, &pmu_overhead);
 }
 
 
@@ -359,7 +409,8 @@ volatile void critical_task_start_eval(){
 
 /* critical_task_end_eval
  *
- * Description: Deactivates all performance counters at once and reads the event values for each of them
+ * Description: Deactivates all performance counters at once, reads the event values for each of them in a single pass
+ *              and removes the calibrated probe cost
  *
  * Parameter:   None
  *
@@ -367,33 +418,20 @@ volatile void critical_task_start_eval(){
  *
  * */
 volatile void critical_task_end_eval(){
+    struct pmu_snapshot snapshot;
 
-    // Disable counters
-    disable_all_counters(0x3F);
-
-    // Select general performance counter to read from
-    select_evt_counter(counter_id_0);
-
-    // Read value
-    value0f=read_evt_counter();
-
-    select_evt_counter(counter_id_1);
-    value1f=read_evt_counter();
+    armv7_stop(&snapshot);
 
-    select_evt_counter(counter_id_2);
-    value2f=read_evt_counter();
-
-    select_evt_counter(counter_id_3);
-    value3f=read_evt_counter();
-
-    select_evt_counter(counter_id_4);
-    value4f=read_evt_counter();
-
-    select_evt_counter(counter_id_5);
-    value5f=read_evt_counter();
+    // Remove the probe cost
+    pmu_subtract_overhead(&snapshot, &pmu_overhead);
 
-    // Read from the dedicated execution cycles performance counter
-    valueCf = read_cycle_counter();
+    valueCf = snapshot.cycles;
+    value0f = snapshot.evt[counter_id_0];
+    value1f = snapshot.evt[counter_id_1];
+    value2f = snapshot.evt[counter_id_2];
+    value3f = snapshot.evt[counter_id_3];
+    value4f = snapshot.evt[counter_id_4];
+    value5f = snapshot.evt[counter_id_5];
 
 }
 
@@ -0,0 +1,73 @@
+/*--------------------------- pmu_counter_source.h -----------------------
+ |  File pmu_counter_source.h
+ |
+ |  Description: Abstract performance counter source. A source groups
+ |               the cycle counter and up to six event counters that are
+ |               started and read together (ARMv7 PMU on bare metal,
+ |               perf_event on Linux). The probe-overhead calibration
+ |               only relies on this interface and is therefore portable.
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_COUNTER_SOURCE_H_
+#define PMU_COUNTER_SOURCE_H_
+
+// Number of programmable event counters of the ARM Cortex A15
+#define PMU_NB_EVT_COUNTERS 6
+
+// Values of all the counters of a source taken at the same probe point
+struct pmu_snapshot{
+    unsigned cycles;
+    unsigned evt[PMU_NB_EVT_COUNTERS];
+};
+
+// Counter source operations
+struct pmu_counter_source{
+    const char* name;
+
+    // Programs the given events (nb_events <= PMU_NB_EVT_COUNTERS). Returns 0 on success
+    int (*init)(const unsigned* event_ids, unsigned nb_events);
+
+    // Resets and starts all counters at once
+    void (*start)(void);
+
+    // Stops all counters at once and retrieves their raw values
+    void (*stop)(struct pmu_snapshot* snapshot);
+
+    // Retrieves the values of the running counters (counted since start) without stopping them
+    void (*read)(struct pmu_snapshot* snapshot);
+};
+
+
+/* pmu_calibrate
+ *
+ * Description: Measures the cost of the probes themselves by running empty start/stop pairs.
+ *              The minimum of each counter over all the runs is kept, since any larger value
+ *              comes from a perturbation (interrupt, cache miss on the probe code) and not from the probe.
+ *
+ * Parameter:
+ *              - const struct pmu_counter_source* source: Counter source to calibrate (already initialized)
+ *              - unsigned nb_runs: Number of empty start/stop pairs to measure
+ *              - struct pmu_snapshot* overhead: Where the measured probe cost is written
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_calibrate(const struct pmu_counter_source* source, unsigned nb_runs, struct pmu_snapshot* overhead);
+
+
+/* pmu_subtract_overhead
+ *
+ * Description: Removes the calibrated probe cost from a measurement. Values are saturated at 0.
+ *
+ * Parameter:
+ *              - struct pmu_snapshot* snapshot: Measurement to correct
+ *              - const struct pmu_snapshot* overhead: Probe cost given by pmu_calibrate
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_subtract_overhead(struct pmu_snapshot* snapshot, const struct pmu_snapshot* overhead);
+
+#endif /* PMU_COUNTER_SOURCE_H_ */
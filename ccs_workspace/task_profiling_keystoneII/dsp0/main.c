@@ -10,7 +10,7 @@
  |                for analyzing the effect of different
  |                benchmarks on the system.
  |
- |  Version: 1.1V
+ |  Version: 1.4V
  |
  | Contact:
  | alfonso.mascarenas-gonzalez@isae-supaero.fr
@@ -35,6 +35,7 @@
 #include <string.h>
 
 #include "DSP_arbitration.h"
+#include "stream_kernels.h"
 #include "../arm0/DDR3MemoryController.h"
 #include "../arm0/UART.h"
 #include "../arm0/MSMC.h"
@@ -47,6 +48,8 @@ void critical_task_end_eval();
 void DDR_configure_eval(unsigned filter_events);
 void DDR_start_eval();
 void DDR_end_eval();
+void measurement_start();
+void measurement_end();
 
 
 // Iteration number
@@ -83,6 +86,22 @@ const unsigned DDR_BANK_1 = 0x88034000;
 const unsigned DDR_BANK_2 = 0x88036000;
 const unsigned DDR_BANK_3 = 0x88038000;
 
+// STREAM bandwidth kernels (copy, scale, add, triad), STREAM_RUNS runs each, then the bandwidth ceiling. 0 = disabled, 1 = enabled
+#define STREAM_BANDWIDTH 0
+#define STREAM_RUNS 10
+
+// STREAM arrays placement: first word, words per array and words between two arrays
+#define STREAM_ARRAYS_ADDRESS 0x90000000
+#define STREAM_ARRAY_WORDS (1024*1024)
+#define STREAM_ARRAY_OFFSET_WORDS 0
+
+// C66x cycles (TSC) at 1200 MHz. DDR3A: PERF_CNT_TIM at 800 MHz, 64-byte accesses (burst of 8 on the 64-bit bus), 16 bytes per cycle at the peak
+const struct stream_platform STREAM_PLATFORM = {"k2_c66x_ddr3a", 1200, 800, 64, 16};
+
+struct stream_arrays stream_arrays;
+// Run of highest bandwidth of each kernel
+struct stream_result stream_best[STREAM_NB_KERNELS];
+
 
 
 /* DSP_init
@@ -132,8 +151,7 @@ int main(void)
     // Configure EMIF performance counters
     DDR_configure_eval(1);
 
-    write_UART_THR("Task profiling: Start-Read pattern on DSPs \n\r");
-    write_UART_THR("Task profiling: Start-Read pattern on EMIFs \n\r");
+    write_UART_THR("Task profiling: Start-Read pattern on DSPs and EMIFs (same runs) \n\r");
 
     TSCL = 0; // Initiate CPU timer by writing any value to TSCL
 
@@ -145,58 +163,33 @@ int main(void)
     /*************************/
 
     // Intended for no data caches implementation
-    write_UART_THR("Store burst on DDR SDRAM bank 0: Execution time (cycles) \n\r");
+    write_UART_THR("Store burst on DDR SDRAM bank 0: Execution time (cycles), EMIF utilization time (cycles), number of accesses and actives \n\r");
 
     for(i=0; i < MAX_ITERATIONS; i++){
-        critical_task_start_eval();
+        measurement_start();
         cpu_microbenchmark_store(DDR_BANK_0, 0xFF00FF);
-        critical_task_end_eval();
-        sprintf(data_str, "%u %llu \n\r", i, result);
-        write_UART_THR(data_str);
-
-    }
+        measurement_end();
 
-    // Intended for no data caches implementation
-    write_UART_THR("Store burst on DDR SDRAM bank 0: Utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
-
-    for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
-        cpu_microbenchmark_store(DDR_BANK_0, 0xFF00FF);
-        DDR_end_eval();
-
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
+        sprintf(data_str, "%u %llu %u %u %u \n\r", i, result, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
         write_UART_THR(data_str);
     }
 
 
     // Intended for no data caches implementation
-    write_UART_THR("Load burst on DDR SDRAM bank 0: Execution time (cycles) \n\r");
+    write_UART_THR("Load burst on DDR SDRAM bank 0: Execution time (cycles), EMIF utilization time (cycles), number of accesses and actives \n\r");
 
     for(i=0; i < MAX_ITERATIONS; i++){
-        critical_task_start_eval();
+        measurement_start();
         cpu_microbenchmark_load(DDR_BANK_1);
-        critical_task_end_eval();
+        measurement_end();
 
-        sprintf(data_str, "%u %llu \n\r", i, result);
-        write_UART_THR(data_str);
-
-    }
-
-    // Intended for no data caches implementation
-    write_UART_THR("Load burst on DDR SDRAM bank 0: Utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
-
-    for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
-        cpu_microbenchmark_load(DDR_BANK_1);
-        DDR_end_eval();
-
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
+        sprintf(data_str, "%u %llu %u %u %u \n\r", i, result, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
         write_UART_THR(data_str);
     }
 
 
     // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("Pointer chasing cache stress: Execution time (cycles) \n\r");
+    write_UART_THR("Pointer chasing cache stress: Execution time (cycles), EMIF utilization time (cycles), number of accesses and actives \n\r");
 
     #define VECTOR_SIZE 8*1024*1024
     #define STRIDE_SIZE 16
@@ -204,30 +197,17 @@ int main(void)
     unsigned pointer_chasing_vector[VECTOR_SIZE]; // Pass as an argument of the function "cpu_pointer_chasing_microbenchmark" to avoid the use of __vla_alloc
 
     for(i=0; i < MAX_ITERATIONS; i++){
-        critical_task_start_eval();
-        cpu_pointer_chasing_microbenchmark(100000, STRIDE_SIZE, VECTOR_SIZE, pointer_chasing_vector);
-        critical_task_end_eval();
-
-        sprintf(data_str, "%u %llu \n\r", i, result);
-        write_UART_THR(data_str);
-
-    }
-
-    // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("Pointer chasing cache stress: Utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
-
-    for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
+        measurement_start();
         cpu_pointer_chasing_microbenchmark(100000, STRIDE_SIZE, VECTOR_SIZE, pointer_chasing_vector);
-        DDR_end_eval();
+        measurement_end();
 
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
+        sprintf(data_str, "%u %llu %u %u %u \n\r", i, result, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
         write_UART_THR(data_str);
     }
 
 
     // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("System stress matrix: Execution time (cycles)\n\r");
+    write_UART_THR("System stress matrix: Execution time (cycles), EMIF utilization time (cycles), number of accesses and actives \n\r");
 
     #define MATRIX_SIZE 512
 
@@ -235,25 +215,45 @@ int main(void)
     int in1[MATRIX_SIZE][MATRIX_SIZE]; // Pass as an argument of the function "matrix_stress2_task" to avoid the use of __vla_alloc
 
     for(i=0; i < MAX_ITERATIONS; i++){
-        critical_task_start_eval();
+        measurement_start();
         matrix_stress2_task(MATRIX_SIZE, in0, in1);
-        critical_task_end_eval();
+        measurement_end();
 
-        sprintf(data_str, "%u %llu \n\r", i, result);
+        sprintf(data_str, "%u %llu %u %u %u \n\r", i, result, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
         write_UART_THR(data_str);
-
     }
 
-    // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("System stress matrix: Utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
 
-    for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
-        matrix_stress2_task(MATRIX_SIZE, in0, in1);
-        DDR_end_eval();
+    // _amem8/_dadd kernels over arrays much larger than the L2 cache
+    if(STREAM_BANDWIDTH){
+        write_UART_THR("STREAM bandwidth: kernel, bytes, execution time (cycles), MB/s, EMIF utilization time (cycles), number of accesses, EMIF MB/s, data bus utilization (per mille), then the best run of each kernel and the ceiling \n\r");
 
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
-        write_UART_THR(data_str);
+        struct stream_result stream_result;
+        unsigned kernel;
+
+        if(stream_arrays_init(&stream_arrays, (unsigned*)STREAM_ARRAYS_ADDRESS, STREAM_ARRAY_WORDS, STREAM_ARRAY_OFFSET_WORDS) < 0)
+            write_UART_THR("STREAM array size and offset must be multiples of 16 words \n\r");
+        else{
+            memset(stream_best, 0, sizeof(stream_best));
+
+            for(kernel = 0; kernel < STREAM_NB_KERNELS; kernel++)
+                for(i=0; i < STREAM_RUNS; i++){
+                    measurement_start();
+                    stream_run(&stream_arrays, kernel);
+                    measurement_end();
+
+                    stream_result.kernel = kernel;
+                    stream_result.nb_words = stream_arrays.nb_words;
+                    stream_result.time = result;
+                    stream_result.emif_cycles = result_ddr_cycles_emif0;
+                    stream_result.emif_accesses = result_ddr_evt0_emif0;
+
+                    stream_print(&STREAM_PLATFORM, &stream_result, write_UART_THR);
+                    stream_ceiling_update(&STREAM_PLATFORM, stream_best, &stream_result);
+                }
+
+            stream_print_ceiling(&STREAM_PLATFORM, stream_best, write_UART_THR);
+        }
     }
 
 
@@ -369,5 +369,34 @@ void DDR_end_eval(){
 
 }
 
+/* measurement_start
+ *
+ * Description: Reads the EMIF counters, then the time stamp register. The time stamp is the innermost probe,
+ *              so the execution time does not include the EMIF register reads.
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void measurement_start(){
+    DDR_start_eval();
+    critical_task_start_eval();
+}
+
+/* measurement_end
+ *
+ * Description: Reads the time stamp register, then the EMIF counters (reverse order of measurement_start)
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void measurement_end(){
+    critical_task_end_eval();
+    DDR_end_eval();
+}
+
 
 
@@ -4,7 +4,7 @@
  |  Description: This file provides the definition of functions for
  |  managing the EMIFs on Keystone II TCI6636K2H
  |
- |  Version: 2.1
+ |  Version: 2.3
  *-----------------------------------------------------------------------*/
 
 #include "DDR3MemoryController.h"
@@ -136,10 +136,81 @@ void enable_CNT_MSTID(unsigned id){
 void set_MSTID(unsigned id, unsigned master_id){
     unsigned int* PERF_CNT_SEL = (unsigned*)(DDR3A_EMIF_CONFIGURATION + PERF_CNT_SEL_OFFSET);
 
-    if(id == 0)
+    if(id == 0){
+        *PERF_CNT_SEL &= 0xFFFF00FF; // Clear MSTID1 bits
         *PERF_CNT_SEL |= (master_id<<8); // Set MSTID1 bits
-    else if(id == 1)
+    }
+    else if(id == 1){
+        *PERF_CNT_SEL &= 0x00FFFFFF; // Clear MSTID2 bits
         *PERF_CNT_SEL |= (master_id<<24); // Set MSTID2 bits
+    }
+}
+
+
+/* enable_CNT_REGION
+ *
+ * Description: Restricts a performance counter to the accesses of the chip select (region) given by set_REGION
+ *
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void enable_CNT_REGION(unsigned id){
+    unsigned int* PERF_CNT_CFG = (unsigned*)(DDR3A_EMIF_CONFIGURATION + PERF_CNT_CFG_OFFSET);
+
+    if(id == 0)
+        *PERF_CNT_CFG |= (1<<14); // Set CNTR1_REGION_EN bit
+    else if(id == 1)
+        *PERF_CNT_CFG |= (1<<30); // Set CNTR2_REGION_EN bit
+}
+
+
+/* disable_CNT_REGION
+ *
+ * Description: Counts the accesses to every chip select again
+ *
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void disable_CNT_REGION(unsigned id){
+    unsigned int* PERF_CNT_CFG = (unsigned*)(DDR3A_EMIF_CONFIGURATION + PERF_CNT_CFG_OFFSET);
+
+    if(id == 0)
+        *PERF_CNT_CFG &= ~(1u<<14); // Clear CNTR1_REGION_EN bit
+    else if(id == 1)
+        *PERF_CNT_CFG &= ~(1u<<30); // Clear CNTR2_REGION_EN bit
+}
+
+
+/* set_REGION
+ *
+ * Description: Sets the chip select (region) to be considered by the chosen performance counter (the previous region is replaced)
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *              - unsigned region: Chip select to focus on
+ *
+ * Returns:     Nothing
+ *
+ * */
+void set_REGION(unsigned id, unsigned region){
+    unsigned int* PERF_CNT_SEL = (unsigned*)(DDR3A_EMIF_CONFIGURATION + PERF_CNT_SEL_OFFSET);
+
+    if(id == 0){
+        *PERF_CNT_SEL &= 0xFFFFFFF0; // Clear REGION_SEL1 bits
+        *PERF_CNT_SEL |= (region<<0); // Set REGION_SEL1 bits
+    }
+    else if(id == 1){
+        *PERF_CNT_SEL &= 0xFFF0FFFF; // Clear REGION_SEL2 bits
+        *PERF_CNT_SEL |= (region<<16); // Set REGION_SEL2 bits
+    }
 }
 
 
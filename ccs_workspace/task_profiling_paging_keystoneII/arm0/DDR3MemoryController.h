@@ -4,7 +4,7 @@
  |  Description: This file provides functions for managing the
  |  EMIFs on Keystone II TCI6636K2H
  |
- |  Version: 2.1
+ |  Version: 2.3
  *-----------------------------------------------------------------------*/
 
 #ifndef DDR3MEMORYCONTROLLER_H_
@@ -65,6 +65,7 @@ unsigned get_PERF_CNT_TIMER();
  * 0x0                          Total SDRAM accesses             NA                         0 - Disable, 1 - Enable
  * 0x1                          Total SDRAM activates            NA                         0 - Disable, 1 - Enable
  * 0x2                          Total Reads                      0 - Disable, 1 - Enable    0 - Disable, 1 - Enable
+ * 0x3                          Total Writes                     0 - Disable, 1 - Enable    0 - Disable, 1 - Enable
  *
  * See more at: https://www.ti.com/lit/ug/spruhz6l/spruhz6l.pdf (Table 2-12. Performance Counter Filter Configuration)
  *
@@ -95,7 +96,7 @@ void enable_CNT_MSTID(unsigned id);
 
 /* set_MSTID
  *
- * Description: Sets the master to be considered by the chosen performance counter
+ * Description: Sets the master to be considered by the chosen performance counter (the previous master is replaced)
  *
  * Reference: https://www.ti.com/lit/ug/spruhn7c/spruhn7c.pdf?ts=1646756863389&ref_url=https%253A%252F%252Fwww.google.com%252F (Table 2-12. Performance Counter Filter Configuration)
  *            https://www.ti.com/lit/ds/symlink/66ak2h06.pdf?ts=1663928051848&ref_url=https%253A%252F%252Fwww.google.com%252F (Table 8-6. Master ID Settings)
@@ -121,6 +122,54 @@ void enable_CNT_MSTID(unsigned id);
 void set_MSTID(unsigned id, unsigned master_id);
 
 
+/* enable_CNT_REGION
+ *
+ * Description: Restricts a performance counter to the accesses of the chip select (region) given by set_REGION.
+ *              Only the events which support it are filtered (e.g., 0x2 reads and 0x3 writes), see set_PERF_CNT_EVENT.
+ *              Combined with the MSTID filter, only the accesses of the master to the region are counted.
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void enable_CNT_REGION(unsigned id);
+
+
+/* disable_CNT_REGION
+ *
+ * Description: Counts the accesses to every chip select again
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void disable_CNT_REGION(unsigned id);
+
+
+/* set_REGION
+ *
+ * Description: Sets the chip select (region) to be considered by the chosen performance counter (assuming region filtering is enabled)
+ *
+ * Reference: https://www.ti.com/lit/ug/spruhn7c/spruhn7c.pdf (PERF_CNT_SEL register, REGION_SEL1/REGION_SEL2 fields)
+ *
+ * Region       Entity
+ * 0            Chip select 0 (CE0)
+ * 1            Chip select 1 (CE1), when SDCFG.EBANK = 1
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *              - unsigned region: Chip select to focus on
+ *
+ * Returns:     Nothing
+ *
+ * */
+void set_REGION(unsigned id, unsigned region);
+
+
 /* set_DDR3A_SDCFG_IBANK
  *
  * Description: Sets the number of SDRAM banks to use by the controller
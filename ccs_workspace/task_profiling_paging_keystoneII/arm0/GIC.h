@@ -0,0 +1,149 @@
+/*--------------------------- GIC.h -------------------------------------
+ |  File GIC.h
+ |
+ |  Description:  Contains functions related to the ARM CorePac interrupt
+ |                controller (GIC-400): routing of a shared peripheral
+ |                interrupt (SPI) to a core, acknowledge and end of the
+ |                interrupts, and IRQ masking of the core.
+ |                The core is expected to run in the Secure state (as after
+ |                a CCS load), where every interrupt is in group 0 and is
+ |                signalled as an IRQ.
+ |                Addresses are Keystone II platform specific.
+ |
+ |  Reference: ARM Generic Interrupt Controller Architecture Specification v2 (ARM IHI 0048B)
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#define GIC_DIST_BASE_ADDRESS     (0x02561000)
+#define GIC_CPU_BASE_ADDRESS      (0x02562000)
+
+// Distributor registers
+#define GICD_CTLR_OFFSET          (0x000)
+#define GICD_ISENABLER_OFFSET     (0x100)
+#define GICD_ICENABLER_OFFSET     (0x180)
+#define GICD_ICPENDR_OFFSET       (0x280)
+#define GICD_IPRIORITYR_OFFSET    (0x400)
+#define GICD_ITARGETSR_OFFSET     (0x800)
+#define GICD_ICFGR_OFFSET         (0xC00)
+
+// CPU interface registers
+#define GICC_CTLR_OFFSET          (0x00)
+#define GICC_PMR_OFFSET           (0x04)
+#define GICC_IAR_OFFSET           (0x0C)
+#define GICC_EOIR_OFFSET          (0x10)
+
+// Interrupt identifier field of GICC_IAR, and identifier read when no interrupt is pending
+#define GICC_IAR_ID_MASK          (0x3FF)
+#define GIC_SPURIOUS_ID           (1023)
+
+// Priority of the routed interrupts (lower is higher) and priority mask letting them through
+#define GIC_IRQ_PRIORITY          (0xA0)
+#define GIC_PRIORITY_MASK         (0xF0)
+
+// PMU interrupt of an A15 core (ARM_NPMUIRQn, GIC SPI 20 to 23, edge-triggered)
+#define K2_PMU_IRQ_ID(core)       (32 + 20 + (core))
+
+
+/* gic_enable_interrupt
+ *
+ * Description: Routes a shared peripheral interrupt to the given cores and enables it, the distributor and the CPU interface
+ *
+ * Parameter:
+ *              - unsigned id: Interrupt identifier (32 and above)
+ *              - unsigned edge: 1 for an edge-triggered interrupt, 0 for a level-sensitive one
+ *              - unsigned cpu_targets: Cores receiving the interrupt (bit n = core n)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void gic_enable_interrupt(unsigned id, unsigned edge, unsigned cpu_targets){
+    volatile unsigned char* priority = (volatile unsigned char*)(GIC_DIST_BASE_ADDRESS + GICD_IPRIORITYR_OFFSET + id);
+    volatile unsigned char* targets = (volatile unsigned char*)(GIC_DIST_BASE_ADDRESS + GICD_ITARGETSR_OFFSET + id);
+    volatile unsigned* config = (volatile unsigned*)(GIC_DIST_BASE_ADDRESS + GICD_ICFGR_OFFSET + 4*(id/16));
+    unsigned edge_bit = 1u << (2*(id%16) + 1);
+
+    *priority = GIC_IRQ_PRIORITY;
+    *targets = (unsigned char)cpu_targets;
+    *config = edge ? (*config | edge_bit) : (*config & ~edge_bit);
+
+    // Drop a request left pending by an earlier use, then enable
+    *(volatile unsigned*)(GIC_DIST_BASE_ADDRESS + GICD_ICPENDR_OFFSET + 4*(id/32)) = 1u << (id%32);
+    *(volatile unsigned*)(GIC_DIST_BASE_ADDRESS + GICD_ISENABLER_OFFSET + 4*(id/32)) = 1u << (id%32);
+
+    *(volatile unsigned*)(GIC_DIST_BASE_ADDRESS + GICD_CTLR_OFFSET) |= 0x3;
+    *(volatile unsigned*)(GIC_CPU_BASE_ADDRESS + GICC_PMR_OFFSET) = GIC_PRIORITY_MASK;
+    *(volatile unsigned*)(GIC_CPU_BASE_ADDRESS + GICC_CTLR_OFFSET) |= 0x3;
+}
+
+
+/* gic_disable_interrupt
+ *
+ * Description: Disables an interrupt at the distributor
+ *
+ * Parameter:
+ *              - unsigned id: Interrupt identifier
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void gic_disable_interrupt(unsigned id){
+    *(volatile unsigned*)(GIC_DIST_BASE_ADDRESS + GICD_ICENABLER_OFFSET + 4*(id/32)) = 1u << (id%32);
+}
+
+
+/* gic_acknowledge
+ *
+ * Description: Acknowledges the highest priority pending interrupt, to be called first by the IRQ handler
+ *
+ * Parameter:   None
+ *
+ * Returns:     The interrupt identifier (GIC_SPURIOUS_ID if none was pending)
+ *
+ * */
+static inline unsigned gic_acknowledge(void){
+    return *(volatile unsigned*)(GIC_CPU_BASE_ADDRESS + GICC_IAR_OFFSET) & GICC_IAR_ID_MASK;
+}
+
+
+/* gic_end_of_interrupt
+ *
+ * Description: Signals the end of the service of an acknowledged interrupt
+ *
+ * Parameter:
+ *              - unsigned id: Identifier returned by gic_acknowledge
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void gic_end_of_interrupt(unsigned id){
+    *(volatile unsigned*)(GIC_CPU_BASE_ADDRESS + GICC_EOIR_OFFSET) = id;
+}
+
+
+/* enable_IRQ
+ *
+ * Description: Unmasks the IRQ exceptions of the core (CPSR.I = 0). Privileged mode only.
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void enable_IRQ(void){
+    __asm__ __volatile("cpsie i");
+}
+
+
+/* disable_IRQ
+ *
+ * Description: Masks the IRQ exceptions of the core (CPSR.I = 1). Privileged mode only.
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void disable_IRQ(void){
+    __asm__ __volatile("cpsid i");
+}
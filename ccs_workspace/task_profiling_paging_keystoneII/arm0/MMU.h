@@ -2,7 +2,7 @@
  |  File MMU.h
  |
  |  Description: MMU set up functions
- |  Version: 1.2
+ |  Version: 1.3
  *-----------------------------------------------------------------------*/
 
 #define PMSELR_MASK  0xFFFFFFE0
@@ -157,6 +157,59 @@ static inline void disable_L2_cache(){
 }
 
 
+/* clean_invalidate_dcache_level
+ *
+ * Description: Cleans and invalidates a data or unified cache level by set/way while the caches stay enabled,
+ *              so that dirty lines are written back before being dropped. Local labels only: can be inlined several times.
+ *
+ * Parameter:
+ *              - unsigned level: Cache level to clean and invalidate, 0 = L1D, 1 = L2
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void clean_invalidate_dcache_level(unsigned level){
+    unsigned ccsidr, line_shift, way_shift, nb_ways, nb_sets, way, set;
+
+    // Select the cache level (CSSELR) and read its geometry (CCSIDR)
+    __asm__ __volatile("MCR p15, 2, %0, c0, c0, 0 \n\t"
+                       "ISB \n\t"
+                       :: "r" (level << 1));
+    __asm__ __volatile("MRC p15, 1, %0, c0, c0, 0 \n\t" : "=r"(ccsidr));
+
+    line_shift = (ccsidr & 0x7) + 4;
+    nb_ways = ((ccsidr >> 3) & 0x3FF) + 1;
+    nb_sets = ((ccsidr >> 13) & 0x7FFF) + 1;
+    way_shift = (nb_ways > 1) ? __builtin_clz(nb_ways - 1) : 0;
+
+    // DCCISW: clean and invalidate data cache line by set/way
+    for(way = 0; way < nb_ways; way++)
+        for(set = 0; set < nb_sets; set++)
+            __asm__ __volatile("MCR p15, 0, %0, c7, c14, 2 \n\t"
+                               :: "r" ((way << way_shift) | (set << line_shift) | (level << 1)));
+
+    __asm__ __volatile("DSB \n\t");
+}
+
+
+/* clean_invalidate_dcaches
+ *
+ * Description: Cleans and invalidates the L1 data cache, then the L2 cache, leaving them enabled
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void clean_invalidate_dcaches(){
+    // L1 first, so that its dirty lines are written to L2 before L2 is cleaned
+    clean_invalidate_dcache_level(0);
+    clean_invalidate_dcache_level(1);
+
+    __asm__ __volatile("ISB \n\t");
+}
+
+
 
 /* read_system_control
  *
@@ -4,7 +4,7 @@
  |  Description: This file provides functions for managing the
  |  ARM Performance Monitor Hardware
  |
- |  Version: 2.1
+ |  Version: 2.3
  *-----------------------------------------------------------------------*/
 
 #define PMSELR_MASK  0xFFFFFFE0
@@ -33,6 +33,21 @@ static inline void select_evt_counter(int counter_id_f)  {
 
 }
 
+/* read_selected_counter
+ *
+ * Description: Reads the counter selection register (PMSELR), e.g., to restore it at the end of an interrupt handler.
+ *
+ * Parameter:   None
+ *
+ * Returns:		The selected counter
+ *
+ * */
+static inline unsigned int read_selected_counter()  {
+	   unsigned int value=0;
+     __asm__ __volatile("mrc p15, 0, %0, c9, c12, 5" : "=r"(value));
+	 return value & ~PMSELR_MASK;
+}
+
 /* event_track
  *
  * Description: The event type is selected, without modifying the reserved bits.
@@ -49,6 +64,21 @@ static inline void event_track(int event_id_f)  {
       __asm__ __volatile("mcr p15, 0, %0, c9, c13, 1" :: "r"((value&PMXEVTYPER_MASK)|event_id_f));
 }
 
+/* read_event_tracked
+ *
+ * Description: Reads the event type of the selected counter.
+ *
+ * Parameter:   None
+ *
+ * Returns:		The event number tracked by the selected counter
+ *
+ * */
+static inline unsigned int read_event_tracked()  {
+	  unsigned int value=0;
+	  __asm__ __volatile("mrc p15, 0, %0, c9, c13, 1" : "=r"(value));
+	  return value & ~PMXEVTYPER_MASK;
+}
+
 
 /* enable_evt_counter
  *
@@ -219,6 +249,22 @@ static inline unsigned int read_evt_counter()  {
 }
 
 
+/* write_evt_counter
+ *
+ * Description: Writes the selected event counter register (Performance Monitor Count Registers).
+ *              Used to reload a sampled counter so that it overflows again after a given number of events.
+ *
+ * Parameter:
+ *              - unsigned int value: New counter value
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void write_evt_counter(unsigned int value)  {
+   __asm__ __volatile("MCR p15, 0, %0, c9, c13, 2\t\n" :: "r"(value));
+}
+
+
 /* enable_cycle_counter
  *
  * Description: Enables only the cycle counter, without modifying the reserved bits.
@@ -311,6 +357,97 @@ static inline void clear_overflows()  {
 }
 
 
+/* clear_counters_overflow
+ *
+ * Description: Clears only the given counters overflows flags (MSB = Counter cycle overflow), so that
+ *              an overflow raised after the flags were read is not lost
+ *
+ * Parameter:
+ *              - unsigned int flags: Overflow flags to clear, as returned by read_counters_overflow
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void clear_counters_overflow(unsigned int flags)  {
+	__asm__ __volatile("MCR p15, 0, %0, c9, c12, 3" :: "r"(flags & 0x8000003F));
+}
+
+/* enable_overflow_interrupts
+ *
+ * Description: Enables the overflow interrupt request of the given counters (Interrupt Enable Set Register, PMINTENSET).
+ *              Privileged mode only.
+ *
+ * Parameter:
+ *              - unsigned int flags: Counters whose overflow raises an interrupt (MSB = Counter cycle, bits 0-5 = event counters)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void enable_overflow_interrupts(unsigned int flags)  {
+	__asm__ __volatile("MCR p15, 0, %0, c9, c14, 1" :: "r"(flags & 0x8000003F));
+}
+
+/* disable_overflow_interrupts
+ *
+ * Description: Disables the overflow interrupt request of the given counters (Interrupt Enable Clear Register, PMINTENCLR).
+ *              Privileged mode only.
+ *
+ * Parameter:
+ *              - unsigned int flags: Counters whose overflow no longer raises an interrupt (MSB = Counter cycle, bits 0-5 = event counters)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void disable_overflow_interrupts(unsigned int flags)  {
+	__asm__ __volatile("MCR p15, 0, %0, c9, c14, 2" :: "r"(flags & 0x8000003F));
+}
+
+/* read_all_counters
+ *
+ * Description: Reads the Cycle Counter Register (CCNT) and the six event counters in a single and fixed
+ *              instruction sequence (PMSELR write immediately followed by its PMXEVCNTR read), so that the
+ *              probe cost is the same for every sample and can be calibrated away.
+ *              The cycle counter is read first since it is the most sensitive one to the probe cost.
+ *
+ * Parameter:
+ *              - unsigned* cycles: Where the cycle counter value is written
+ *              - unsigned* evt: Array of six elements where the event counters 0 to 5 values are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void read_all_counters(unsigned* cycles, unsigned* evt)  {
+   unsigned int c, e0, e1, e2, e3, e4, e5, sel;
+
+   __asm__ __volatile("MRC p15, 0, %[c], c9, c13, 0  \n\t"
+                      "MOV %[sel], #0               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e0], c9, c13, 2 \n\t"
+                      "MOV %[sel], #1               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e1], c9, c13, 2 \n\t"
+                      "MOV %[sel], #2               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e2], c9, c13, 2 \n\t"
+                      "MOV %[sel], #3               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e3], c9, c13, 2 \n\t"
+                      "MOV %[sel], #4               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e4], c9, c13, 2 \n\t"
+                      "MOV %[sel], #5               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e5], c9, c13, 2 \n\t"
+                      : [c] "=&r" (c), [e0] "=&r" (e0), [e1] "=&r" (e1), [e2] "=&r" (e2),
+                        [e3] "=&r" (e3), [e4] "=&r" (e4), [e5] "=&r" (e5), [sel] "=&r" (sel)
+                      );
+
+   *cycles = c;
+   evt[0] = e0; evt[1] = e1; evt[2] = e2;
+   evt[3] = e3; evt[4] = e4; evt[5] = e5;
+}
+
+
 /* Example of use */
 /*
 	unsigned long value0i = 0, value0f = 0, diff0 = 0, value1i  = 0, value1f = 0, diff1 = 0, value2i = 0, value2f = 0, diff2 = 0, value3i = 0, value3f = 0, diff3 = 0,
@@ -4,7 +4,7 @@
  |  Description: The functions definition for the ARMv7 PMU management
  |               are done here
  |
- |  Version: 1.1
+ |  Version: 1.6
  *-----------------------------------------------------------------------*/
 
 #include <stdio.h>
@@ -49,29 +49,66 @@
 #define EVENT_ID_5   0x10
 
 
-// Initializes the Armv7 performance counters with the events to track
-void counters_init(){
-    // Select counter to program: counter_number can be between 0-5
-    select_evt_counter(COUNTER_ID_0);
+// Events tracked by counters 0 to 5
+const unsigned counters_event_ids[PMU_NB_EVT_COUNTERS] = {EVENT_ID_0, EVENT_ID_1, EVENT_ID_2, EVENT_ID_3, EVENT_ID_4, EVENT_ID_5};
+
+// Probe cost, zero until counters_calibrate is called
+struct pmu_snapshot pmu_overhead;
+
+// Counters wraps since the last critical_task_start_eval
+static struct pmu_wrap_tracker pmu_wraps;
+
+// Sampling state: buffer receiving the samples (NULL when not sampling), sampled counter, its reload value and its event before sampling
+static struct pmu_sample_buffer* sampling_buffer = NULL;
+static unsigned sampling_counter;
+static unsigned sampling_reload;
+static unsigned sampling_saved_event;
+
+
+// Programs the given events on the first counters
+static int armv7_init(const unsigned* events, unsigned nb_events){
+    unsigned i;
+
+    if(nb_events > PMU_NB_EVT_COUNTERS)
+        return -1;
+
+    for(i = 0; i < nb_events; i++){
+        // Select counter to program: counter_number can be between 0-5
+        select_evt_counter(i);
+
+        // Select event to track in selected counter: event_id numbers are in the ARM A15 TRM
+        event_track(events[i]);
+    }
+
+    return 0;
+}
 
-    // Select event to track in selected counter: event_id numbers are in the A$
-    event_track(EVENT_ID_0);
+// Stops the performance counters and retrieves the raw metrics in a single pass
+static void armv7_stop(struct pmu_snapshot* snapshot){
 
-    select_evt_counter(COUNTER_ID_1);
-    event_track(EVENT_ID_1);
+    // Disable counters
+    disable_all_counters(0x3F);
 
-    select_evt_counter(COUNTER_ID_2);
-    event_track(EVENT_ID_2);
+    // Read the cycle counter and the six event counters back-to-back
+    read_all_counters(&snapshot->cycles, snapshot->evt);
+}
 
-    select_evt_counter(COUNTER_ID_3);
-    event_track(EVENT_ID_3);
+// Retrieves the raw metrics of the running performance counters
+static void armv7_read(struct pmu_snapshot* snapshot){
+    read_all_counters(&snapshot->cycles, snapshot->evt);
+}
 
-    select_evt_counter(COUNTER_ID_4);
-    event_track(EVENT_ID_4);
+const struct pmu_counter_source pmu_armv7_source = {"armv7", armv7_init, critical_task_start_eval, armv7_stop, armv7_read};
 
-    select_evt_counter(COUNTER_ID_5);
-    event_track(EVENT_ID_5);
 
+// Initializes the Armv7 performance counters with the events to track
+void counters_init(){
+    armv7_init(counters_event_ids, PMU_NB_EVT_COUNTERS);
+}
+
+// Measures the probe cost
+void counters_calibrate(unsigned nb_runs){
+    pmu_calibrate(&pmu_armv7_source, nb_runs, &pmu_overhead);
 }
 
 // Resets the performance counters and starts counting
@@ -79,6 +116,7 @@ void critical_task_start_eval(){
 
     // Clear possible overflows of every counter
     clear_overflows();
+    pmu_wrap_reset(&pmu_wraps);
 
     // Activates and resets all event counters and does not enable the count divider
     reset_all_counters(0);
@@ -91,45 +129,113 @@ void critical_task_start_eval(){
 
 }
 
-// Stops the performance counters and retrieves the metrics 
+// Stops the performance counters and retrieves the 64-bit metrics without the probe cost
 void critical_task_end_eval(){
+    struct pmu_snapshot raw;
+    struct pmu_snapshot64 snapshot;
+    unsigned flags;
+
+    armv7_stop(&raw);
+
+    // Counters are stopped: every pending overflow happened before the read
+    flags = read_counters_overflow();
+    pmu_wrap_account(&pmu_wraps, flags);
+    clear_counters_overflow(flags);
+
+    pmu_wrap_extend(&pmu_wraps, &raw, &snapshot);
+    pmu_subtract_overhead64(&snapshot, &pmu_overhead);
+
+    valueCf = snapshot.cycles;
+    value0f = snapshot.evt[COUNTER_ID_0];
+    value1f = snapshot.evt[COUNTER_ID_1];
+    value2f = snapshot.evt[COUNTER_ID_2];
+    value3f = snapshot.evt[COUNTER_ID_3];
+    value4f = snapshot.evt[COUNTER_ID_4];
+    value5f = snapshot.evt[COUNTER_ID_5];
+}
 
-    // Disable counters
-    disable_all_counters(0x3F);
+// Accounts the overflows of the running counters
+void counters_poll_overflows(){
+    struct pmu_snapshot raw;
+    unsigned flags;
+
+    // The sampled counter overflows are the samples, they belong to the interrupt
+    if(sampling_buffer != NULL)
+        return;
+
+    // The flags must be read after the values
+    read_all_counters(&raw.cycles, raw.evt);
+    flags = read_counters_overflow();
 
-    // Select general performance counter to read from
-    select_evt_counter(COUNTER_ID_0);
+    clear_counters_overflow(pmu_wrap_poll(&pmu_wraps, flags, &raw));
+}
 
-    // Read value
-    value0f=read_evt_counter();
+// Starts the statistical sampling on one event counter
+void counters_sampling_start(struct pmu_sample_buffer* buffer, unsigned counter, unsigned event_id, unsigned period){
+    struct pmu_snapshot origin;
 
-    select_evt_counter(COUNTER_ID_1);
-    value1f=read_evt_counter();
+    sampling_buffer = buffer;
+    sampling_counter = counter;
+    sampling_reload = 0u - period;
 
-    select_evt_counter(COUNTER_ID_2);
-    value2f=read_evt_counter();
+    select_evt_counter(counter);
+    sampling_saved_event = read_event_tracked();
+    event_track(event_id);
 
-    select_evt_counter(COUNTER_ID_3);
-    value3f=read_evt_counter();
+    clear_overflows();
+    reset_all_counters(0);
 
-    select_evt_counter(COUNTER_ID_4);
-    value4f=read_evt_counter();
+    // The sampled counter overflows after "period" events
+    select_evt_counter(counter);
+    write_evt_counter(sampling_reload);
 
-    select_evt_counter(COUNTER_ID_5);
-    value5f=read_evt_counter();
+    read_all_counters(&origin.cycles, origin.evt);
+    pmu_sample_set_origin(buffer, &origin);
 
-    // Read from the dedicated execution cycles performance counter
-    valueCf = read_cycle_counter();
+    enable_overflow_interrupts(1u << counter);
 
+    // Synchronize context (Instruction Synchronization Barrier)
+    __asm__ __volatile("isb");
+
+    enable_all_counters(0x3F);
 }
 
-// Prints the metrics
-void print_pmu_results(unsigned id){
-    printf("%u %u %u %u %u %u %u %u \n\r", id, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
+// Stops the statistical sampling
+void counters_sampling_stop(){
+    disable_all_counters(0x3F);
+    disable_overflow_interrupts(1u << sampling_counter);
+    clear_overflows();
+
+    sampling_buffer = NULL;
+
+    // Back to the event tracked before the sampling
+    select_evt_counter(sampling_counter);
+    event_track(sampling_saved_event);
 }
 
+// Records a sample from the PMU interrupt
+void counters_sampling_irq_handler(unsigned long pc){
+    struct pmu_snapshot raw;
+    unsigned flags = read_counters_overflow();
 
+    // The interrupted code may be between a counter selection and its access
+    unsigned selected = read_selected_counter();
 
+    if(sampling_buffer != NULL && (flags & (1u << sampling_counter))){
+        read_all_counters(&raw.cycles, raw.evt);
+        pmu_sample_record(sampling_buffer, pc, &raw);
 
+        select_evt_counter(sampling_counter);
+        write_evt_counter(sampling_reload);
+    }
 
+    // The other counters increments are computed modulo 2^32, their wraps need no accounting
+    clear_counters_overflow(flags);
 
+    select_evt_counter(selected);
+}
+
+// Prints the metrics
+void print_pmu_results(unsigned id){
+    printf("%u %llu %llu %llu %llu %llu %llu %llu \n\r", id, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
+}
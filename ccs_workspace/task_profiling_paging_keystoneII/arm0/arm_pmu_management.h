@@ -4,11 +4,24 @@
  |  Description: The functions declaration for the ARMv7 PMU management
  |               are done here
  |
- |  Version: 1
+ |  Version: 1.6
  *-----------------------------------------------------------------------*/
 
-// ARM performance counter final read variables
-unsigned value0f, value1f, value2f, value3f, value4f, value5f, valueCf;
+#include "pmu_counter_source.h"
+#include "pmu_counter64.h"
+#include "pmu_sampling.h"
+
+// ARM performance counter final read variables (extended to 64 bits through the overflow flags)
+unsigned long long value0f, value1f, value2f, value3f, value4f, value5f, valueCf;
+
+// ARM Cortex A15 events tracked by counters 0 to 5
+extern const unsigned counters_event_ids[PMU_NB_EVT_COUNTERS];
+
+// Probe cost measured by counters_calibrate and removed from every measurement
+extern struct pmu_snapshot pmu_overhead;
+
+// ARMv7 PMU implementation of the counter source
+extern const struct pmu_counter_source pmu_armv7_source;
 
 
 /* counters_init
@@ -23,6 +36,21 @@ unsigned value0f, value1f, value2f, value3f, value4f, value5f, valueCf;
 void counters_init();
 
 
+/* counters_calibrate
+ *
+ * Description: Measures the probe cost through empty start/stop pairs. From then on,
+ *              critical_task_end_eval subtracts it from every value read.
+ *              To be called once at boot, after counters_init.
+ *
+ * Parameter:
+ *		- unsigned nb_runs: the number of empty start/stop pairs measured
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_calibrate(unsigned nb_runs);
+
+
 /* critical_task_start_eval
  *
  * Description: Prepares the performance counters for its use by:
@@ -40,7 +68,8 @@ void critical_task_start_eval();
 
 /* critical_task_end_eval
  *
- * Description: Deactivates all performance counters at once and reads the event values for each of them
+ * Description: Deactivates all performance counters at once, reads the event values for each of them
+ *              in a single pass and removes the calibrated probe cost
  *
  * Parameter:   None
  *
@@ -50,6 +79,68 @@ void critical_task_start_eval();
 void critical_task_end_eval();
 
 
+/* counters_poll_overflows
+ *
+ * Description: Accounts the counters overflows while the counters are running.
+ *              Needed for measurements where a counter may wrap more than once (i.e., more
+ *              than 2^32 events, about 3.6 s of cycles at 1.2 GHz); calling it at least once
+ *              every 2^31 events keeps the 64-bit values exact. main.c calls it at the phase
+ *              boundaries of the benchmarks (BENCHMARK_REGION_BEGIN/END) when PMU_OVERFLOW_POLLING
+ *              is set; its cost is then part of every measured run. Does nothing while sampling.
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_poll_overflows();
+
+
+/* counters_sampling_start
+ *
+ * Description: Starts the statistical sampling: the given event counter is reloaded so that it overflows every
+ *              "period" events and its overflow interrupt is enabled. The other counters keep the events set by
+ *              counters_init. counters_sampling_irq_handler must then be called from the PMU interrupt service routine.
+ *
+ * Parameter:
+ *		- struct pmu_sample_buffer* buffer: Preallocated buffer receiving the samples (initialized with the same counter and period)
+ *		- unsigned counter: Event counter raising the overflows (between 0 and 5)
+ *		- unsigned event_id: Event tracked by the sampled counter (e.g., 0x17 L2 refill, 0x19 bus access)
+ *		- unsigned period: Number of events between two samples
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_sampling_start(struct pmu_sample_buffer* buffer, unsigned counter, unsigned event_id, unsigned period);
+
+
+/* counters_sampling_stop
+ *
+ * Description: Stops the counters and the sampling interrupt, and restores the event of the sampled counter.
+ *              The recorded samples stay in the buffer.
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_sampling_stop();
+
+
+/* counters_sampling_irq_handler
+ *
+ * Description: Records a sample when the sampled counter overflowed and reloads it. To be called from the
+ *              PMU interrupt service routine with the interrupted PC (LR_irq - 4), i.e., from irq_dispatch in main.c.
+ *
+ * Parameter:
+ *		- unsigned long pc: Interrupted program counter
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_sampling_irq_handler(unsigned long pc);
+
+
 /* print_pmu_results
  *
  * Description: Prints the results for the chosen events
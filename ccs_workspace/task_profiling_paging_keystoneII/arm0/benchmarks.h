@@ -5,7 +5,7 @@
  |                of the multicore platform, e.g., DDR memory row,
  |                unified/shared cache.
  |
- |  Version: 1.1
+ |  Version: 1.3
  *-----------------------------------------------------------------------*/
 
 
@@ -13,6 +13,20 @@
 #define BENCHMARKS_H_
 
 
+// Phase markers of the benchmarks. Empty unless defined before this file is included (e.g., as region_begin/region_end)
+#ifndef BENCHMARK_REGION_BEGIN
+#define BENCHMARK_REGION_BEGIN(id)
+#endif
+#ifndef BENCHMARK_REGION_END
+#define BENCHMARK_REGION_END(id)
+#endif
+
+// Phases of the matrix stress tasks
+#define MATRIX_PHASE_INIT       1
+#define MATRIX_PHASE_STENCIL    2
+#define MATRIX_PHASE_REDUCTION  3
+
+
 /* cpu_microbenchmark_store
  *
  * Description: Executes 128 store instructions aiming to a specific location
@@ -443,17 +457,23 @@ unsigned matrix_stress1_task(unsigned size)  {
    volatile int in1[size][size];
    volatile int sum = 0;
 
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_INIT);
    for (unsigned i=0; i < size; i++)
        for (unsigned j=0; j < size; j++)
            in0[i][j]=i+j+1;
+   BENCHMARK_REGION_END(MATRIX_PHASE_INIT);
 
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_STENCIL);
    for (unsigned i=0; i < size; i++)
        for (unsigned j=0; j < size; j++)
            in1[i][j]=in0[i-1][j]+in0[i][j-1]+in0[i][j]+in0[i][j+1]+in0[i+1][j];
+   BENCHMARK_REGION_END(MATRIX_PHASE_STENCIL);
 
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_REDUCTION);
    for (unsigned i=0; i < size; i++)
        for (unsigned j=0; j < size; j++)
            sum+=in1[i][j];
+   BENCHMARK_REGION_END(MATRIX_PHASE_REDUCTION);
 
    return sum;
 }
@@ -473,22 +493,179 @@ unsigned matrix_stress2_task(unsigned size)  {
    volatile int in1[size][size];
    volatile int sum = 0;
 
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_INIT);
    for (unsigned i=0; i < size; i++)
        for (unsigned j=0; j < size; j++)
            in0[i][j]=i+j+1;
+   BENCHMARK_REGION_END(MATRIX_PHASE_INIT);
 
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_STENCIL);
    for (unsigned i=0; i < size; i++)
        for (unsigned j=0; j < size; j++)
            in1[i][j]=in0[j][i-1]+in0[j-1][i]+in0[j][i]+in0[j+1][i]+in0[j][i+1];
+   BENCHMARK_REGION_END(MATRIX_PHASE_STENCIL);
+
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_REDUCTION);
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=0; j < size; j++)
+           sum+=in1[i][j];
+   BENCHMARK_REGION_END(MATRIX_PHASE_REDUCTION);
+
+   return sum;
+}
+
+
+/* matrix_stress3_task
+ *
+ * Description: Task that makes use of matrices to create interference
+ *
+ * Parameter:
+ *              - unsigned size: Indicates the size of the matrices. Final memory usage is (number of matrices (2) * unsigned size (4) * size*size)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void matrix_stress3_task(unsigned size){
+   volatile unsigned in0[size][size];
+   volatile unsigned in1[size][size];
+
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=0; j < size; j++)
+           in0[i][j]=i+j+1;
+
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=1; j < size-1; j++)
+           in1[i][j]=in0[i][j+1] + in0[i][j-1];
+
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=0; j < size; j++)
+           in1[i][j] = 2*in1[i][j] - in0[i][j];
+}
+
+
+/* matrix_stress1_tiled_task
+ *
+ * Description: Cache-blocked matrix_stress1_task: the stencil is computed tile x tile elements at a time, so that the rows of in0
+ *              read by a tile stay in the data cache. Same accesses as matrix_stress1_task, in another order
+ *
+ * Parameter:
+ *              - unsigned size: Indicates the size of the matrices. Final memory usage is (number of matrices (2) * unsigned size (4) * size*size)
+ *              - unsigned tile: Tile side (elements), 0 or above size: a single tile, i.e., the order of matrix_stress1_task
+ *
+ * Returns:     A dummy sum
+ *
+ * */
+unsigned matrix_stress1_tiled_task(unsigned size, unsigned tile)  {
+   volatile int in0[size][size];
+   volatile int in1[size][size];
+   volatile int sum = 0;
+
+   if (tile == 0 || tile > size)
+       tile = size;
+
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_INIT);
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=0; j < size; j++)
+           in0[i][j]=i+j+1;
+   BENCHMARK_REGION_END(MATRIX_PHASE_INIT);
+
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_STENCIL);
+   for (unsigned ii=0; ii < size; ii+=tile)
+       for (unsigned jj=0; jj < size; jj+=tile)
+           for (unsigned i=ii; i < ii+tile && i < size; i++)
+               for (unsigned j=jj; j < jj+tile && j < size; j++)
+                   in1[i][j]=in0[i-1][j]+in0[i][j-1]+in0[i][j]+in0[i][j+1]+in0[i+1][j];
+   BENCHMARK_REGION_END(MATRIX_PHASE_STENCIL);
+
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_REDUCTION);
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=0; j < size; j++)
+           sum+=in1[i][j];
+   BENCHMARK_REGION_END(MATRIX_PHASE_REDUCTION);
+
+   return sum;
+}
+
+
+/* matrix_stress2_tiled_task
+ *
+ * Description: Cache-blocked matrix_stress2_task: the column-wise walk of in0 is limited to tile x tile elements at a time, so that
+ *              the rows of in0 read by a tile stay in the data cache while the tile moves along them. Same accesses as
+ *              matrix_stress2_task, in another order
+ *
+ * Parameter:
+ *              - unsigned size: Indicates the size of the matrices. Final memory usage is (number of matrices (2) * unsigned size (4) * size*size)
+ *              - unsigned tile: Tile side (elements), 0 or above size: a single tile, i.e., the order of matrix_stress2_task
+ *
+ * Returns:     A dummy sum
+ *
+ * */
+unsigned matrix_stress2_tiled_task(unsigned size, unsigned tile)  {
+   volatile int in0[size][size];
+   volatile int in1[size][size];
+   volatile int sum = 0;
+
+   if (tile == 0 || tile > size)
+       tile = size;
+
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_INIT);
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=0; j < size; j++)
+           in0[i][j]=i+j+1;
+   BENCHMARK_REGION_END(MATRIX_PHASE_INIT);
 
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_STENCIL);
+   for (unsigned ii=0; ii < size; ii+=tile)
+       for (unsigned jj=0; jj < size; jj+=tile)
+           for (unsigned i=ii; i < ii+tile && i < size; i++)
+               for (unsigned j=jj; j < jj+tile && j < size; j++)
+                   in1[i][j]=in0[j][i-1]+in0[j-1][i]+in0[j][i]+in0[j+1][i]+in0[j][i+1];
+   BENCHMARK_REGION_END(MATRIX_PHASE_STENCIL);
+
+   BENCHMARK_REGION_BEGIN(MATRIX_PHASE_REDUCTION);
    for (unsigned i=0; i < size; i++)
        for (unsigned j=0; j < size; j++)
            sum+=in1[i][j];
+   BENCHMARK_REGION_END(MATRIX_PHASE_REDUCTION);
 
    return sum;
 }
 
 
+/* matrix_stress3_tiled_task
+ *
+ * Description: Cache-blocked matrix_stress3_task: the stencil and the update are fused over blocks of tile rows, so that the rows
+ *              of in0 and in1 written by the stencil are still in the data cache when the update reads them. Same accesses as
+ *              matrix_stress3_task, in another order
+ *
+ * Parameter:
+ *              - unsigned size: Indicates the size of the matrices. Final memory usage is (number of matrices (2) * unsigned size (4) * size*size)
+ *              - unsigned tile: Rows of a block, 0 or above size: a single block, i.e., the order of matrix_stress3_task
+ *
+ * Returns:     Nothing
+ *
+ * */
+void matrix_stress3_tiled_task(unsigned size, unsigned tile){
+   volatile unsigned in0[size][size];
+   volatile unsigned in1[size][size];
+
+   if (tile == 0 || tile > size)
+       tile = size;
+
+   for (unsigned i=0; i < size; i++)
+       for (unsigned j=0; j < size; j++)
+           in0[i][j]=i+j+1;
+
+   for (unsigned ii=0; ii < size; ii+=tile){
+       for (unsigned i=ii; i < ii+tile && i < size; i++)
+           for (unsigned j=1; j < size-1; j++)
+               in1[i][j]=in0[i][j+1] + in0[i][j-1];
+
+       for (unsigned i=ii; i < ii+tile && i < size; i++)
+           for (unsigned j=0; j < size; j++)
+               in1[i][j] = 2*in1[i][j] - in0[i][j];
+   }
+}
 
 
 #endif /* BENCHMARKS_H_ */
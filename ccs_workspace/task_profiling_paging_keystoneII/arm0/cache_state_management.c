@@ -0,0 +1,72 @@
+/*--------------------------- cache_state_management.c -------------------
+ |  File cache_state_management.c
+ |
+ |  Description: The functions definition for the Keystone II cache
+ |               state management are done here. The data caches are
+ |               cleaned and invalidated by set/way (MMU.h).
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "MMU.h"
+#include "cache_state_management.h"
+
+// Cache line size of the ARM Cortex A15
+#define CACHE_LINE_SIZE 64
+
+
+// Pollution buffer
+static volatile unsigned char* pollution_buffer = NULL;
+static unsigned pollution_buffer_size = 0;
+
+
+int cache_state_init(void* buffer, unsigned size){
+    // No allocator on bare metal: the buffer must be given
+    if(buffer == NULL || size == 0)
+        return -1;
+
+    pollution_buffer = (volatile unsigned char*)buffer;
+    pollution_buffer_size = size;
+
+    return 0;
+}
+
+
+void caches_clean_invalidate(){
+    clean_invalidate_dcaches();
+}
+
+
+void caches_pollute(unsigned size){
+    unsigned i;
+
+    if(size > pollution_buffer_size)
+        size = pollution_buffer_size;
+
+    for(i = 0; i < size; i += CACHE_LINE_SIZE)
+        *(volatile unsigned*)(pollution_buffer + i) = i;
+
+    __asm__ __volatile("dsb");
+}
+
+
+void cache_state_prepare(const struct cache_state_policy* policy, void (*task)(void)){
+    switch(policy->state){
+        case CACHE_STATE_COLD:
+            caches_clean_invalidate();
+            break;
+
+        case CACHE_STATE_WARM:
+            task();
+            __asm__ __volatile("dsb");
+            break;
+
+        case CACHE_STATE_POLLUTED:
+            caches_pollute(policy->pollution_size);
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,142 @@
+/*--------------------------- config_sweep.c -----------------------------
+ |  File config_sweep.c
+ |
+ |  Description: The functions definition for the controller
+ |               configuration sweep are done here
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "config_sweep.h"
+
+
+// Mean execution time of a benchmark at a point, 0 without runs
+static unsigned long long mean_time(const struct config_point_times* times){
+    return (times->runs == 0) ? 0 : times->sum / times->runs;
+}
+
+
+// 1 if point a ranks before point b: lower worst case of the critical benchmark, then lower mean
+static int ranks_before(const struct config_sweep* sweep, unsigned a, unsigned b){
+    const struct config_point_times* ta = &sweep->times[a][sweep->critical];
+    const struct config_point_times* tb = &sweep->times[b][sweep->critical];
+
+    if(ta->wcet != tb->wcet)
+        return ta->wcet < tb->wcet;
+
+    return mean_time(ta) < mean_time(tb);
+}
+
+
+int config_sweep_init(struct config_sweep* sweep, const struct config_knob* knobs, unsigned nb_knobs,
+                      const char* const* benchmarks, unsigned nb_benchmarks, unsigned critical){
+    unsigned nb_points = 1;
+    unsigned p, b, k;
+
+    if(nb_knobs > CONFIG_SWEEP_MAX_KNOBS || nb_benchmarks == 0 || nb_benchmarks > CONFIG_SWEEP_MAX_BENCHMARKS || critical >= nb_benchmarks)
+        return -1;
+
+    for(k = 0; k < nb_knobs; k++){
+        if(knobs[k].nb_values == 0 || nb_points * knobs[k].nb_values > CONFIG_SWEEP_MAX_POINTS)
+            return -1;
+        nb_points *= knobs[k].nb_values;
+    }
+
+    sweep->knobs = knobs;
+    sweep->nb_knobs = nb_knobs;
+    sweep->benchmarks = benchmarks;
+    sweep->nb_benchmarks = nb_benchmarks;
+    sweep->critical = critical;
+    sweep->nb_points = nb_points;
+
+    for(p = 0; p < nb_points; p++)
+        for(b = 0; b < nb_benchmarks; b++){
+            sweep->times[p][b].runs = 0;
+            sweep->times[p][b].wcet = 0;
+            sweep->times[p][b].sum = 0;
+        }
+
+    return 0;
+}
+
+
+unsigned config_sweep_value(const struct config_sweep* sweep, unsigned point, unsigned knob){
+    unsigned k;
+
+    // Mixed radix: the last knob is the least significant digit
+    for(k = sweep->nb_knobs - 1; k > knob; k--)
+        point /= sweep->knobs[k].nb_values;
+
+    return sweep->knobs[knob].values[point % sweep->knobs[knob].nb_values];
+}
+
+
+void config_sweep_apply(const struct config_sweep* sweep, unsigned point){
+    unsigned k;
+
+    for(k = 0; k < sweep->nb_knobs; k++)
+        sweep->knobs[k].apply(config_sweep_value(sweep, point, k));
+}
+
+
+void config_sweep_record(struct config_sweep* sweep, unsigned point, unsigned benchmark, unsigned long long time){
+    struct config_point_times* times = &sweep->times[point][benchmark];
+
+    if(times->runs == 0 || time > times->wcet)
+        times->wcet = time;
+
+    times->sum += time;
+    times->runs++;
+}
+
+
+void config_sweep_run(struct config_sweep* sweep, config_sweep_measure measure, unsigned runs){
+    unsigned p, b, r;
+
+    for(p = 0; p < sweep->nb_points; p++){
+        config_sweep_apply(sweep, p);
+
+        for(b = 0; b < sweep->nb_benchmarks; b++)
+            for(r = 0; r < runs; r++)
+                config_sweep_record(sweep, p, b, measure(b));
+    }
+}
+
+
+// Line length after an append: snprintf returns the length it would have written, so a row longer than the line is
+// clamped to the room left before the line end (" \n\r"), and the next appends stay inside the line
+static unsigned clamp_length(unsigned length, unsigned room){
+    return (length > room) ? room : length;
+}
+
+
+void config_sweep_print(const struct config_sweep* sweep, void (*write_line)(char* line)){
+    unsigned order[CONFIG_SWEEP_MAX_POINTS];
+    unsigned i, j, k, b, p, length;
+    char line[512];
+    const unsigned room = sizeof(line) - sizeof(" \n\r");
+
+    // Insertion sort: stable, so that equal points keep the grid order
+    for(i = 0; i < sweep->nb_points; i++){
+        for(j = i; j > 0 && ranks_before(sweep, i, order[j - 1]); j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    for(i = 0; i < sweep->nb_points; i++){
+        p = order[i];
+        length = clamp_length(snprintf(line, sizeof(line), "%u", i + 1), room);
+
+        for(k = 0; k < sweep->nb_knobs; k++)
+            length = clamp_length(length + snprintf(line + length, sizeof(line) - length, " %s=0x%X", sweep->knobs[k].name,
+                                                    config_sweep_value(sweep, p, k)), room);
+
+        for(b = 0; b < sweep->nb_benchmarks; b++)
+            length = clamp_length(length + snprintf(line + length, sizeof(line) - length, " %s %llu %llu", sweep->benchmarks[b],
+                                                    sweep->times[p][b].wcet, mean_time(&sweep->times[p][b])), room);
+
+        snprintf(line + length, sizeof(line) - length, " \n\r");
+        write_line(line);
+    }
+}
@@ -0,0 +1,178 @@
+/*--------------------------- emif_event_scheduler.c ---------------------
+ |  File emif_event_scheduler.c
+ |
+ |  Description: The functions definition for the EMIF performance
+ |               counter event rotation are done here
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "emif_event_scheduler.h"
+
+
+// Number of events of a pair (the last pair can hold a single event)
+static unsigned group_length(const struct emif_event_scheduler* sched, unsigned group){
+    unsigned first = group * EMIF_NB_EVT_COUNTERS;
+    unsigned left = sched->nb_events - first;
+
+    return (left < EMIF_NB_EVT_COUNTERS) ? left : EMIF_NB_EVT_COUNTERS;
+}
+
+
+// Position of an event in the list of a scheduler, nb_events if it is not counted
+static unsigned event_index(const struct emif_event_scheduler* sched, unsigned event){
+    unsigned i;
+
+    for(i = 0; i < sched->nb_events; i++)
+        if(sched->event_ids[i] == event)
+            break;
+
+    return i;
+}
+
+
+// Sets the events of both counters of every EMIF
+static void configure(const struct emif_bus* bus, unsigned event_1, unsigned event_2){
+    unsigned e;
+
+    for(e = 0; e < bus->nb_controllers; e++){
+        emif_set_event(&bus->controller[e], 0, event_1);
+        emif_set_event(&bus->controller[e], 1, event_2);
+    }
+}
+
+
+int emif_sched_init(struct emif_event_scheduler* sched, const struct emif_bus* bus, const unsigned* event_ids, unsigned nb_events){
+    unsigned i, e;
+
+    if(nb_events > EMIF_SCHED_MAX_EVENTS)
+        return -1;
+
+    sched->bus = bus;
+    sched->nb_events = nb_events;
+
+    for(i = 0; i < nb_events; i++){
+        sched->event_ids[i] = event_ids[i];
+        sched->runs[i] = 0;
+        for(e = 0; e < EMIF_SCHED_MAX_EMIFS; e++){
+            sched->count[e][i] = 0;
+            sched->counted_cycles[e][i] = 0;
+        }
+    }
+
+    for(e = 0; e < EMIF_SCHED_MAX_EMIFS; e++)
+        sched->total_cycles[e] = 0;
+    sched->total_runs = 0;
+    sched->nb_groups = (nb_events + EMIF_NB_EVT_COUNTERS - 1) / EMIF_NB_EVT_COUNTERS;
+    sched->current_group = 0;
+
+    return 0;
+}
+
+
+void emif_sched_start(struct emif_event_scheduler* sched){
+    unsigned first = sched->current_group * EMIF_NB_EVT_COUNTERS;
+
+    // A single event left: both counters count it, only PERF_CNT_1 is accounted
+    if(sched->nb_groups > 0){
+        if(group_length(sched, sched->current_group) == 2)
+            configure(sched->bus, sched->event_ids[first], sched->event_ids[first + 1]);
+        else
+            configure(sched->bus, sched->event_ids[first], sched->event_ids[first]);
+    }
+
+    emif_bus_snapshot(sched->bus, &sched->begin);
+}
+
+
+void emif_sched_stop(struct emif_event_scheduler* sched){
+    struct emif_snapshot end;
+
+    emif_bus_snapshot(sched->bus, &end);
+    emif_sched_account(sched, &sched->begin, &end);
+}
+
+
+void emif_sched_account(struct emif_event_scheduler* sched, const struct emif_snapshot* begin, const struct emif_snapshot* end){
+    unsigned first = sched->current_group * EMIF_NB_EVT_COUNTERS;
+    unsigned cycles, i, e;
+
+    // Counters are free running: unsigned differences also hold across a wrap
+    for(e = 0; e < sched->bus->nb_controllers; e++){
+        cycles = end->cycles[e] - begin->cycles[e];
+        sched->total_cycles[e] += cycles;
+
+        if(sched->nb_groups == 0)
+            continue;
+
+        for(i = 0; i < group_length(sched, sched->current_group); i++){
+            sched->count[e][first + i] += end->evt[e][i] - begin->evt[e][i];
+            sched->counted_cycles[e][first + i] += cycles;
+        }
+    }
+
+    sched->total_runs++;
+
+    if(sched->nb_groups == 0)
+        return;
+
+    for(i = 0; i < group_length(sched, sched->current_group); i++)
+        sched->runs[first + i]++;
+
+    // Next pair (round robin)
+    sched->current_group = (sched->current_group + 1) % sched->nb_groups;
+}
+
+
+unsigned emif_sched_coverage_permille(const struct emif_event_scheduler* sched, unsigned emif, unsigned index){
+    if(sched->total_cycles[emif] == 0)
+        return 0;
+
+    return (unsigned)((sched->counted_cycles[emif][index] * 1000) / sched->total_cycles[emif]);
+}
+
+
+unsigned long long emif_sched_scaled_count(const struct emif_event_scheduler* sched, unsigned emif, unsigned index){
+    unsigned long long count = sched->count[emif][index];
+    unsigned long long counted = sched->counted_cycles[emif][index];
+
+    if(counted == 0)
+        return 0;
+
+    // Scaled in two steps to limit the risk of a 64-bit overflow on long runs
+    return (count / counted) * sched->total_cycles[emif] + ((count % counted) * sched->total_cycles[emif]) / counted;
+}
+
+
+void emif_sched_print(const struct emif_event_scheduler* sched, const char* name, void (*write_line)(char* line)){
+    unsigned long long reads = 0, writes = 0;
+    unsigned i, e, length, read_index, write_index;
+    char line[256];
+
+    for(i = 0; i < sched->nb_events; i++){
+        length = snprintf(line, sizeof(line), "%s 0x%X", name, sched->event_ids[i]);
+        for(e = 0; e < sched->bus->nb_controllers; e++)
+            length += snprintf(line + length, sizeof(line) - length, " %llu %u %llu", sched->count[e][i],
+                               emif_sched_coverage_permille(sched, e, i), emif_sched_scaled_count(sched, e, i));
+        snprintf(line + length, sizeof(line) - length, " \n\r");
+        write_line(line);
+    }
+
+    // Read/write proportions of the SDRAM traffic
+    read_index = event_index(sched, EMIF_EVT_READS);
+    write_index = event_index(sched, EMIF_EVT_WRITES);
+    if(read_index == sched->nb_events || write_index == sched->nb_events)
+        return;
+
+    for(e = 0; e < sched->bus->nb_controllers; e++){
+        reads += emif_sched_scaled_count(sched, e, read_index);
+        writes += emif_sched_scaled_count(sched, e, write_index);
+    }
+
+    if(reads + writes == 0)
+        return;
+
+    snprintf(line, sizeof(line), "%s rw %u %u \n\r", name, (unsigned)((reads * 1000) / (reads + writes)), (unsigned)((writes * 1000) / (reads + writes)));
+    write_line(line);
+}
@@ -0,0 +1,175 @@
+/*--------------------------- emif_event_scheduler.h ---------------------
+ |  File emif_event_scheduler.h
+ |
+ |  Description: EMIF performance counter event rotation. The two
+ |               counters of an EMIF (PERF_CNT_1 and PERF_CNT_2) are
+ |               programmed with a new pair of CNTRn_CFG events before
+ |               each measured run (round robin), so that every event of
+ |               the list is seen over the iterations of a single boot.
+ |               Per-event totals are kept for each EMIF together with
+ |               the EMIF cycles (PERF_CNT_TIM) during which the event was
+ |               counted, from which the coverage and the scaled totals
+ |               of the complete event vector are derived.
+ |
+ |               The registers are accessed through the EMIF driver
+ |               (emif_driver.h), so the rotation can be run against any
+ |               memory block laid out as an EMIF.
+ |
+ |  Version: 1.2
+ *-----------------------------------------------------------------------*/
+
+#ifndef EMIF_EVENT_SCHEDULER_H_
+#define EMIF_EVENT_SCHEDULER_H_
+
+#include "emif_driver.h"
+
+// Maximum number of EMIFs measured together and of events handled by a scheduler
+#define EMIF_SCHED_MAX_EMIFS EMIF_MAX_CONTROLLERS
+#define EMIF_SCHED_MAX_EVENTS 16
+
+/*
+ * CNTRn_CFG events (spruhn7c Table 2-12, spruhz6l Section 15.3.4.16)
+ */
+#define EMIF_EVT_ACCESSES            0x0   // Total SDRAM accesses
+#define EMIF_EVT_ACTIVATES           0x1   // Total SDRAM activates
+#define EMIF_EVT_READS               0x2   // Total reads
+#define EMIF_EVT_WRITES              0x3   // Total writes
+#define EMIF_EVT_CMD_FIFO_FULL       0x4   // Cycles the command FIFO is full
+#define EMIF_EVT_WDATA_FIFO_FULL     0x5   // Cycles the write data FIFO is full
+#define EMIF_EVT_RDATA_FIFO_FULL     0x6   // Cycles the read data FIFO is full
+#define EMIF_EVT_RCMD_FIFO_FULL      0x7   // Cycles the return command FIFO is full
+#define EMIF_EVT_PRIORITY_ELEVATIONS 0x8   // Number of priority elevations
+#define EMIF_EVT_CMD_PENDING         0x9   // Cycles a command is pending
+#define EMIF_EVT_DATA_BUS_ACTIVE     0xA   // Cycles the SDRAM data bus is active
+
+struct emif_event_scheduler{
+    const struct emif_bus* bus;
+
+    // Events to count
+    unsigned nb_events;
+    unsigned event_ids[EMIF_SCHED_MAX_EVENTS];
+
+    // Per-EMIF and per-event raw totals, EMIF cycles while counted, and number of runs counted
+    unsigned long long count[EMIF_SCHED_MAX_EMIFS][EMIF_SCHED_MAX_EVENTS];
+    unsigned long long counted_cycles[EMIF_SCHED_MAX_EMIFS][EMIF_SCHED_MAX_EVENTS];
+    unsigned runs[EMIF_SCHED_MAX_EVENTS];
+
+    // EMIF cycles and runs over all the measured runs
+    unsigned long long total_cycles[EMIF_SCHED_MAX_EMIFS];
+    unsigned total_runs;
+
+    // Pair rotation and counters read by emif_sched_start
+    unsigned nb_groups;
+    unsigned current_group;
+    struct emif_snapshot begin;
+};
+
+
+/* emif_sched_init
+ *
+ * Description: Prepares a scheduler for the given events and clears its totals
+ *
+ * Parameter:
+ *              - struct emif_event_scheduler* sched: Scheduler to initialize
+ *              - const struct emif_bus* bus: EMIFs measured (master and region filters already set)
+ *              - const unsigned* event_ids: CNTRn_CFG events to count
+ *              - unsigned nb_events: Number of events (at most EMIF_SCHED_MAX_EVENTS)
+ *
+ * Returns:     0 on success, -1 if there are too many events
+ *
+ * */
+int emif_sched_init(struct emif_event_scheduler* sched, const struct emif_bus* bus, const unsigned* event_ids, unsigned nb_events);
+
+
+/* emif_sched_start
+ *
+ * Description: Programs the current pair of events and reads the counters of every EMIF.
+ *              The programming is done before the counters are read, so it is not measured.
+ *
+ * Parameter:
+ *              - struct emif_event_scheduler* sched: Scheduler to use
+ *
+ * Returns:     Nothing
+ *
+ * */
+void emif_sched_start(struct emif_event_scheduler* sched);
+
+
+/* emif_sched_stop
+ *
+ * Description: Reads the counters of every EMIF again, accumulates the increments of the current pair and rotates to the next pair
+ *
+ * Parameter:
+ *              - struct emif_event_scheduler* sched: Scheduler to use
+ *
+ * Returns:     Nothing
+ *
+ * */
+void emif_sched_stop(struct emif_event_scheduler* sched);
+
+
+/* emif_sched_account
+ *
+ * Description: Accumulates the increments between two snapshots for the current pair and rotates to the next pair.
+ *              emif_sched_stop relies on it; it is exposed so that the accounting can be driven without registers.
+ *
+ * Parameter:
+ *              - struct emif_event_scheduler* sched: Scheduler to use
+ *              - const struct emif_snapshot* begin: Counters read before the run
+ *              - const struct emif_snapshot* end: Counters read after the run
+ *
+ * Returns:     Nothing
+ *
+ * */
+void emif_sched_account(struct emif_event_scheduler* sched, const struct emif_snapshot* begin, const struct emif_snapshot* end);
+
+
+/* emif_sched_coverage_permille
+ *
+ * Description: Fraction of the measured EMIF cycles during which an event was counted
+ *
+ * Parameter:
+ *              - const struct emif_event_scheduler* sched: Scheduler to use
+ *              - unsigned emif: EMIF number
+ *              - unsigned index: Position of the event in the list given to emif_sched_init
+ *
+ * Returns:     The coverage in per mille (1000 = counted during every run)
+ *
+ * */
+unsigned emif_sched_coverage_permille(const struct emif_event_scheduler* sched, unsigned emif, unsigned index);
+
+
+/* emif_sched_scaled_count
+ *
+ * Description: Estimates the total of an event over all the measured runs by scaling its raw total
+ *              with the ratio between all the measured EMIF cycles and the EMIF cycles during which it was counted
+ *
+ * Parameter:
+ *              - const struct emif_event_scheduler* sched: Scheduler to use
+ *              - unsigned emif: EMIF number
+ *              - unsigned index: Position of the event in the list given to emif_sched_init
+ *
+ * Returns:     The scaled total (0 if the event was never counted)
+ *
+ * */
+unsigned long long emif_sched_scaled_count(const struct emif_event_scheduler* sched, unsigned emif, unsigned index);
+
+
+/* emif_sched_print
+ *
+ * Description: Writes the event vector of a benchmark:
+ *              "<benchmark> <event> <raw count> <coverage> <scaled count>" per event, with the raw count, coverage
+ *              and scaled count repeated for each EMIF, then, when the reads and writes were both counted,
+ *              "<benchmark> rw <reads per mille> <writes per mille>" from their scaled counts over all the EMIFs
+ *
+ * Parameter:
+ *              - const struct emif_event_scheduler* sched: Scheduler to use
+ *              - const char* name: Benchmark name
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void emif_sched_print(const struct emif_event_scheduler* sched, const char* name, void (*write_line)(char* line));
+
+#endif /* EMIF_EVENT_SCHEDULER_H_ */
@@ -0,0 +1,108 @@
+/*--------------------------- emif_mstid_sweep.c -------------------------
+ |  File emif_mstid_sweep.c
+ |
+ |  Description: The functions definition for the per-master EMIF
+ |               attribution are done here
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "emif_mstid_sweep.h"
+
+
+// Pairs of events of a matrix row, in the order of the columns
+static const unsigned MSTID_EVENTS[EMIF_MSTID_NB_EVENTS] = {EMIF_EVT_ACCESSES, EMIF_EVT_ACTIVATES, EMIF_EVT_READS, EMIF_EVT_WRITES};
+
+
+// Clears the matrix
+static void mstid_clear(struct emif_mstid_sweep* sweep){
+    unsigned m, i;
+
+    for(m = 0; m < sweep->nb_masters; m++){
+        for(i = 0; i < EMIF_MSTID_NB_EVENTS; i++)
+            sweep->count[m][i] = 0;
+        for(i = 0; i < EMIF_MSTID_NB_EVENTS / EMIF_NB_EVT_COUNTERS; i++)
+            sweep->cycles[m][i] = 0;
+    }
+}
+
+
+int emif_mstid_init(struct emif_mstid_sweep* sweep, const struct emif_bus* bus, const struct emif_master* masters, unsigned nb_masters){
+    if(nb_masters == 0 || nb_masters > EMIF_MSTID_MAX_MASTERS)
+        return -1;
+
+    sweep->bus = bus;
+    sweep->masters = masters;
+    sweep->nb_masters = nb_masters;
+    sweep->current = 0;
+    sweep->window = 0;
+    mstid_clear(sweep);
+
+    return 0;
+}
+
+
+void emif_mstid_start(struct emif_mstid_sweep* sweep){
+    unsigned master = sweep->current / 2, pair = sweep->current % 2;
+    const struct emif_controller* controller;
+    unsigned e, i;
+
+    for(e = 0; e < sweep->bus->nb_controllers; e++){
+        controller = &sweep->bus->controller[e];
+        for(i = 0; i < EMIF_NB_EVT_COUNTERS; i++){
+            emif_set_master(controller, i, sweep->masters[master].id);
+            emif_set_event(controller, i, MSTID_EVENTS[2*pair + i]);
+        }
+    }
+
+    emif_bus_snapshot(sweep->bus, &sweep->begin);
+}
+
+
+int emif_mstid_stop(struct emif_mstid_sweep* sweep){
+    unsigned master = sweep->current / 2, pair = sweep->current % 2;
+    struct emif_snapshot end;
+    unsigned e, i;
+
+    emif_bus_snapshot(sweep->bus, &end);
+
+    // Interleaved EMIFs serve the same masters: their counts are summed, the cycles are the ones of EMIF 0
+    for(e = 0; e < sweep->bus->nb_controllers; e++)
+        for(i = 0; i < EMIF_NB_EVT_COUNTERS; i++)
+            sweep->count[master][2*pair + i] += end.evt[e][i] - sweep->begin.evt[e][i];
+    sweep->cycles[master][pair] += end.cycles[0] - sweep->begin.cycles[0];
+
+    sweep->current = (sweep->current + 1) % (2 * sweep->nb_masters);
+
+    return sweep->current == 0;
+}
+
+
+void emif_mstid_print(struct emif_mstid_sweep* sweep, unsigned skip_idle, void (*write_line)(char* line)){
+    unsigned long long cycles;
+    unsigned m, i, length;
+    char line[256];
+
+    for(m = 0; m < sweep->nb_masters; m++){
+        if(skip_idle && sweep->count[m][0] == 0 && sweep->count[m][2] == 0 && sweep->count[m][3] == 0)
+            continue;
+
+        if(sweep->masters[m].name != NULL)
+            length = snprintf(line, sizeof(line), "%u %s", sweep->window, sweep->masters[m].name);
+        else
+            length = snprintf(line, sizeof(line), "%u 0x%02X", sweep->window, sweep->masters[m].id);
+
+        for(i = 0; i < EMIF_MSTID_NB_EVENTS; i++){
+            cycles = sweep->cycles[m][i / EMIF_NB_EVT_COUNTERS];
+            length += snprintf(line + length, sizeof(line) - length, " %llu",
+                               (cycles == 0) ? 0 : (sweep->count[m][i] * EMIF_MSTID_RATE_CYCLES) / cycles);
+        }
+
+        snprintf(line + length, sizeof(line) - length, " \n\r");
+        write_line(line);
+    }
+
+    sweep->window++;
+    mstid_clear(sweep);
+}
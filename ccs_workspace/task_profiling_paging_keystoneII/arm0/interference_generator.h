@@ -0,0 +1,290 @@
+/*--------------------------- interference_generator.h -------------------
+ |  File interference_generator.h
+ |
+ |  Description: Closed-loop interference generator. The generator issues
+ |               bursts of INTERFERENCE_BURST cache line accesses to one
+ |               bank of the SDRAM (the lines of INTERFERENCE_NB_ROWS rows
+ |               in turn, so that they do not stay in the caches), with a
+ |               given read/write mix, separated by idle gaps. Every
+ |               INTERFERENCE_CONTROL_BURSTS bursts, its own counters are
+ |               read back (a time base and an access count, e.g., PMU
+ |               cycles and L2 refills, or the EMIF timer and accesses):
+ |               the gap is corrected by a share of the difference between
+ |               the time the window should have taken at the target rate
+ |               and the time it took, so that the measured rate converges
+ |               to the target whatever the contention met by the bursts.
+ |
+ |               The cost of an idle iteration is calibrated at init, so
+ |               that the gaps are set in time and not in iterations.
+ |               Locations are turned into pointers with the identity
+ |               mapping: the rows walked must be identity mapped.
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#ifndef INTERFERENCE_GENERATOR_H_
+#define INTERFERENCE_GENERATOR_H_
+
+#include "sdram_geometry.h"
+
+// Accesses of a burst, bursts of a control window and rows of the target bank walked
+#define INTERFERENCE_BURST 16
+#define INTERFERENCE_CONTROL_BURSTS 256
+#define INTERFERENCE_NB_ROWS 1024
+
+// Bytes between two accesses (cache line of the A15)
+#define INTERFERENCE_LINE_SIZE 64
+
+// Share of the window error corrected at each update (1 / 2^INTERFERENCE_GAIN_SHIFT)
+#define INTERFERENCE_GAIN_SHIFT 1
+
+// Idle iterations of the calibration, and longest gap (iterations)
+#define INTERFERENCE_CALIBRATION_LOOPS 100000
+#define INTERFERENCE_MAX_GAP (1u << 24)
+
+// Target of the generator
+struct interference_config{
+    // DDR accesses per microsecond, in thousandths (0: idle)
+    unsigned rate_milli;
+    // Writes per thousand accesses
+    unsigned write_permille;
+    // Target chip select and bank, first row walked
+    unsigned chip;
+    unsigned bank;
+    unsigned first_row;
+};
+
+// Reads the free-running counters of the feedback: a time base and an access count (both may wrap at 32 bits)
+typedef void (*interference_read)(unsigned* time, unsigned* accesses);
+
+struct interference_generator{
+    struct interference_config config;
+    const struct sdram_geometry* geometry;
+
+    // Feedback counters, time base ticks per microsecond, and DDR accesses per thousand counted accesses
+    interference_read read;
+    unsigned ticks_per_us;
+    unsigned scale_permille;
+
+    // Next location, and write share accumulator of the read/write mix
+    struct sdram_location location;
+    unsigned write_accumulator;
+
+    // Idle iterations after each burst, and cost of an idle iteration (1/1024 ticks)
+    unsigned gap;
+    unsigned idle_cost;
+
+    // Counters at the beginning of the window, bursts of the window
+    unsigned last_time;
+    unsigned last_accesses;
+    unsigned bursts;
+
+    // Last window: measured rate (accesses per microsecond, thousandths), and time elapsed since init (ticks)
+    unsigned rate_milli;
+    unsigned long long elapsed;
+};
+
+// Value of the reads, so that they are not optimized out
+static volatile unsigned interference_sink;
+
+
+// Idle loop of the gaps
+static inline void interference_idle(unsigned iterations){
+    unsigned i;
+
+    for(i = 0; i < iterations; i++)
+        __asm__ __volatile("nop");
+}
+
+
+/* interference_gap
+ *
+ * Description: Initial gap of the target rate, from the calibrated cost of an idle iteration. The burst itself is counted as free,
+ *              the feedback removes its time from the gap after the first window
+ *
+ * Parameter:
+ *              - const struct interference_generator* generator: Generator
+ *
+ * Returns:     The gap (iterations)
+ *
+ * */
+static inline unsigned interference_gap(const struct interference_generator* generator){
+    unsigned long long period;
+
+    if(generator->config.rate_milli == 0 || generator->idle_cost == 0)
+        return 0;
+
+    // Ticks of a burst at the target rate: accesses * 1000 * ticks per us / rate
+    period = (unsigned long long)INTERFERENCE_BURST * generator->scale_permille * generator->ticks_per_us / generator->config.rate_milli;
+    period = (period * 1024) / generator->idle_cost;
+
+    return (period > INTERFERENCE_MAX_GAP) ? INTERFERENCE_MAX_GAP : (unsigned)period;
+}
+
+
+/* interference_set_target
+ *
+ * Description: Sets a new target, restarts the walk from its first row and the feedback window
+ *
+ * Parameter:
+ *              - struct interference_generator* generator: Generator
+ *              - const struct interference_config* config: Target
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void interference_set_target(struct interference_generator* generator, const struct interference_config* config){
+    generator->config = *config;
+    generator->location.chip = config->chip;
+    generator->location.bank = config->bank;
+    generator->location.row = config->first_row;
+    generator->location.column = 0;
+    generator->write_accumulator = 0;
+
+    generator->gap = interference_gap(generator);
+    generator->bursts = 0;
+    generator->rate_milli = 0;
+    generator->read(&generator->last_time, &generator->last_accesses);
+}
+
+
+/* interference_init
+ *
+ * Description: Calibrates the idle loop and sets the first target
+ *
+ * Parameter:
+ *              - struct interference_generator* generator: Generator to initialize
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - const struct interference_config* config: Target
+ *              - interference_read read: Feedback counters
+ *              - unsigned ticks_per_us: Ticks of the time base per microsecond
+ *              - unsigned scale_permille: DDR accesses per thousand counted accesses (e.g., 1000 + write_permille when the
+ *                                         count is the L2 refills: each written line is also written back)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void interference_init(struct interference_generator* generator, const struct sdram_geometry* geometry, const struct interference_config* config,
+                                     interference_read read, unsigned ticks_per_us, unsigned scale_permille){
+    unsigned begin, end, accesses;
+
+    generator->geometry = geometry;
+    generator->read = read;
+    generator->ticks_per_us = ticks_per_us;
+    generator->scale_permille = scale_permille;
+    generator->elapsed = 0;
+
+    read(&begin, &accesses);
+    interference_idle(INTERFERENCE_CALIBRATION_LOOPS);
+    read(&end, &accesses);
+    generator->idle_cost = (unsigned)(((unsigned long long)(end - begin) * 1024) / INTERFERENCE_CALIBRATION_LOOPS);
+
+    interference_set_target(generator, config);
+}
+
+
+/* interference_burst
+ *
+ * Description: Issues INTERFERENCE_BURST accesses, one cache line further each time in the row, then in the next row of the bank
+ *
+ * Parameter:
+ *              - struct interference_generator* generator: Generator
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void interference_burst(struct interference_generator* generator){
+    const struct sdram_geometry* geometry = generator->geometry;
+    unsigned columns_per_line = INTERFERENCE_LINE_SIZE >> geometry->bus_bits;
+    volatile unsigned* address;
+    unsigned i;
+
+    for(i = 0; i < INTERFERENCE_BURST; i++){
+        address = (volatile unsigned*)(unsigned long)sdram_encode(geometry, &generator->location);
+
+        // Read/write mix spread over the accesses
+        generator->write_accumulator += generator->config.write_permille;
+        if(generator->write_accumulator >= 1000){
+            generator->write_accumulator -= 1000;
+            *address = i;
+        }
+        else
+            interference_sink = *address;
+
+        generator->location.column += columns_per_line;
+        if(generator->location.column >= (1u << geometry->column_bits)){
+            generator->location.column = 0;
+            generator->location.row++;
+            if(generator->location.row >= generator->config.first_row + INTERFERENCE_NB_ROWS)
+                generator->location.row = generator->config.first_row;
+        }
+    }
+}
+
+
+/* interference_update
+ *
+ * Description: End of a control window: measured rate, and gap corrected by 1 / 2^INTERFERENCE_GAIN_SHIFT of the difference between
+ *              the time the accesses of the window take at the target rate and the time they took
+ *
+ * Parameter:
+ *              - struct interference_generator* generator: Generator
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void interference_update(struct interference_generator* generator){
+    unsigned time, accesses;
+    unsigned long long dt, da;
+    long long error, gap;
+
+    generator->read(&time, &accesses);
+
+    // Counters are free running: unsigned differences also hold across a wrap
+    dt = time - generator->last_time;
+    da = ((unsigned long long)(accesses - generator->last_accesses) * generator->scale_permille) / 1000;
+    generator->last_time = time;
+    generator->last_accesses = accesses;
+    generator->elapsed += dt;
+
+    if(dt != 0)
+        generator->rate_milli = (unsigned)((da * 1000 * generator->ticks_per_us) / dt);
+
+    if(generator->bursts != 0 && generator->config.rate_milli != 0 && generator->idle_cost != 0){
+        error = (long long)((da * 1000 * generator->ticks_per_us) / generator->config.rate_milli) - (long long)dt;
+        gap = (long long)generator->gap + ((error * 1024 / generator->idle_cost) / generator->bursts) / (1 << INTERFERENCE_GAIN_SHIFT);
+
+        generator->gap = (gap < 0) ? 0 : (gap > INTERFERENCE_MAX_GAP) ? INTERFERENCE_MAX_GAP : (unsigned)gap;
+    }
+
+    generator->bursts = 0;
+}
+
+
+/* interference_step
+ *
+ * Description: One burst followed by its gap, and the feedback at the end of a window. With a target of 0, one idle window of
+ *              INTERFERENCE_CALIBRATION_LOOPS iterations followed by the feedback (the measured rate is then the one of the other masters
+ *              when the count is not restricted to the generator)
+ *
+ * Parameter:
+ *              - struct interference_generator* generator: Generator
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void interference_step(struct interference_generator* generator){
+    if(generator->config.rate_milli == 0){
+        interference_idle(INTERFERENCE_CALIBRATION_LOOPS);
+        interference_update(generator);
+        return;
+    }
+
+    interference_burst(generator);
+    interference_idle(generator->gap);
+
+    if(++generator->bursts >= INTERFERENCE_CONTROL_BURSTS)
+        interference_update(generator);
+}
+
+#endif /* INTERFERENCE_GENERATOR_H_ */
@@ -11,7 +11,7 @@
  |               benchmarks on the system under different
  |               pages sizes and cache/bank partitioning
  |
- | Version: 1.0
+ | Version: 1.28
  |
  | Contact:
  | alfonso.mascarenas-gonzalez@isae-supaero.fr
@@ -24,10 +24,35 @@
 
 /* ------------------------- FILE INCLUSION -------------------------- */
 #include <stdio.h>
+#include "pmu_region.h"
+#include "arm_pmu_management.h"
+
+// Overflow polling of the 64-bit counters at the phase boundaries of the benchmarks, for measurements where a counter may
+// wrap more than once (more than 2^32 events, e.g., a long region pass). The poll is not part of the calibrated probe cost:
+// it adds to every measured run. 0 = disabled (a single wrap is still accounted at the end of the measurement), 1 = enabled
+#define PMU_OVERFLOW_POLLING 0
+
+// The phases of the benchmarks are recorded as regions, their boundaries being the overflow poll points
+#define BENCHMARK_REGION_BEGIN(id) do{ if(PMU_OVERFLOW_POLLING) counters_poll_overflows(); region_begin(id); } while(0)
+#define BENCHMARK_REGION_END(id) do{ if(PMU_OVERFLOW_POLLING) counters_poll_overflows(); region_end(id); } while(0)
+
 #include "benchmarks.h"
 #include "MMU.h"
 #include "PMH.h"
-#include "arm_pmu_management.h"
+#include "GIC.h"
+#include "pmu_event_scheduler.h"
+#include "pmu_metrics.h"
+#include "pmu_event_sweep.h"
+#include "pmu_xcore.h"
+#include "cache_state_management.h"
+#include "emif_event_scheduler.h"
+#include "emif_mstid_sweep.h"
+#include "config_sweep.h"
+#include "sdram_geometry.h"
+#include "sdram_pattern.h"
+#include "stream_kernels.h"
+#include "pointer_chase.h"
+#include "tile_tuner.h"
 #include "memory_controller_management.h"
 #include "UART.h"
 #include "MSMC.h"
@@ -36,24 +61,283 @@
 
 /* ----------------------- LOCAL FUNCTIONS --------------------------- */
 int main(void);
+void irq_dispatch(unsigned long pc);
 void ARM_disable_caches();
 static inline void ARM_init(unsigned page_level1_descriptor_addr);
 void configure_AXI(unsigned priority);
 static inline void paging_setup(unsigned page_option, unsigned page_level1_descriptor_addr);
 void page_coloring(unsigned page_level1_descriptor_addr, unsigned page_level2_descriptor_addr, unsigned nb_partition_bits, unsigned initial_partition_position_bit, unsigned selected_partition_bit_id);
+static void region_read_counters(struct pmu_region_counters* counters);
+static inline void measurement_start(void);
+static inline void measurement_end(void);
+static void report_run(struct pmu_metrics_stats* stats, unsigned id);
+static void measure_benchmark(const char* name, const struct cache_state_policy* policy, void (*task)(void));
+static void sweep_matrix_stress1(unsigned size);
+static void sweep_matrix_stress2(unsigned size);
+static void sweep_pointer_chasing(unsigned size);
+static void run_store_burst(void);
+static void run_load_burst(void);
+static void run_pointer_chasing(void);
+static void run_stress_matrix(void);
+static unsigned xcore_harvest(unsigned epoch, struct pmu_snapshot* snapshots);
+static void report_xcore_run(unsigned id, unsigned answered, const struct pmu_snapshot* begin, const struct pmu_snapshot* end);
+static void emif_rotate(const char* name, const struct cache_state_policy* policy, void (*task)(void));
+static void ddr_targets_init(unsigned geometry_valid);
+static void measure_ddr_patterns(void);
+static void run_ddr_pattern(void);
+static void measure_stream(void);
+static void measure_pointer_chase(void);
+static unsigned long long chase_measure(void* head, unsigned nb_hops);
+static void measure_tiled_matrices(void);
+static void tile_measure(unsigned tile, unsigned long long* time, unsigned long long* emif_accesses);
+static void run_tiled_matrix(void);
+static unsigned long long config_measure(unsigned benchmark);
+static void apply_arm_sbndc(unsigned value);
+static void apply_pr_old_count(unsigned value);
+static void apply_rd_thresh(unsigned value);
+static void apply_wr_thresh(unsigned value);
 
 /* --------------- GLOBAL VARIABLES DEFINITIONS --------------- */
 
 // Iteration number
 #define MAX_ITERATIONS 100
+// Number of empty start/stop pairs used to measure the probe cost
+#define PMU_CALIBRATION_RUNS 1000
+// Runs output. 0 = one raw line per iteration, 1 = derived metrics summary (runs, min, mean, max) per benchmark
+#define PMU_SUMMARY_OUTPUT 0
 // ARM configuration mode. 0 = only L1 instruction cache, 1 = all caches plus others (MMU, branch predictor...)
 #define ARM_INIT_CONFIGURATION   1
 
-// Addresses to different DDR3 memory banks
-const unsigned DDR_BANK_0 = 0xFA012000;
-const unsigned DDR_BANK_1 = 0xFA014000;
-const unsigned DDR_BANK_2 = 0xFA016000;
-const unsigned DDR_BANK_3 = 0xFA018000;
+// Event fingerprint of the system stress matrix: FINGERPRINT_EVENTS multiplexed over the six ARM counters. 0 = disabled, 1 = enabled
+#define PMU_EVENT_FINGERPRINT 0
+
+// Events multiplexed over the six ARM counters for the event fingerprint of a task
+const unsigned FINGERPRINT_EVENTS[] = {0x01, 0x03, 0x04, 0x05, 0x08, 0x10, 0x12, 0x13, 0x14, 0x15,
+                                       0x16, 0x17, 0x18, 0x19, 0x1B, 0x1D, 0x60, 0x61, 0x66, 0x67};
+#define NB_FINGERPRINT_EVENTS (sizeof(FINGERPRINT_EVENTS)/sizeof(FINGERPRINT_EVENTS[0]))
+
+// Event-group scheduler used for the event fingerprint
+struct pmu_event_scheduler pmu_sched;
+
+// Derived metrics of the iterations of the current benchmark
+struct pmu_metrics_stats bench_stats;
+
+// Aggressors counters harvested through the MSMC SRAM exchange area during the victim runs. 0 = disabled, 1 = enabled
+#define PMU_XCORE_HARVEST 0
+// Cores taking part (slot = core number, arm0 being the victim) and slot polls before an aggressor is reported as missing
+#define PMU_XCORE_NB_CORES 2
+#define PMU_XCORE_TIMEOUT 10000000
+
+// PMU exchange area shared with the aggressors
+struct pmu_xcore_area* const xcore_area = (struct pmu_xcore_area*)PMU_XCORE_AREA_ADDRESS;
+
+// Event fingerprint sweep of the whole A15 event space (0x00-0x7F). 0 = disabled, 1 = enabled
+#define PMU_EVENT_SWEEP 0
+
+// Problem sizes of the swept tasks: matrix size and pointer chasing working set (words)
+const unsigned MATRIX_SWEEP_SIZES[] = {64, 128, 256, 512};
+const unsigned CHASING_SWEEP_SIZES[] = {4*1024, 64*1024, 1024*1024, 8*1024*1024};
+
+// Tasks fingerprinted by the sweep
+const struct pmu_sweep_task SWEEP_TASKS[] = {
+    {"matrix_stress1", sweep_matrix_stress1, MATRIX_SWEEP_SIZES, 4},
+    {"matrix_stress2", sweep_matrix_stress2, MATRIX_SWEEP_SIZES, 4},
+    {"pointer_chasing", sweep_pointer_chasing, CHASING_SWEEP_SIZES, 4},
+};
+#define NB_SWEEP_TASKS (sizeof(SWEEP_TASKS)/sizeof(SWEEP_TASKS[0]))
+
+// Region identifier of a whole matrix stress task, its phases being MATRIX_PHASE_INIT/STENCIL/REDUCTION
+#define MATRIX_TASK_REGION 0
+// Names of the matrix stress regions in the per-phase row-buffer locality, by region identifier
+const char* const MATRIX_REGION_NAMES[] = {"stress_matrix", "stress_matrix_init", "stress_matrix_stencil", "stress_matrix_reduction"};
+#define NB_MATRIX_REGIONS (sizeof(MATRIX_REGION_NAMES)/sizeof(MATRIX_REGION_NAMES[0]))
+// Per-phase recording of the system stress matrix in the region ring buffer. 0 = disabled, 1 = enabled
+#define PMU_REGION_PASS 0
+// Number of region records of the ring buffer
+#define PMU_REGION_RING_SIZE 1024
+
+// Region records ring buffer, in MSMC SRAM so that recording does not add DDR traffic
+struct pmu_region_record region_ring[PMU_REGION_RING_SIZE] __attribute__((section(".msmc_sram")));
+
+// Statistical sampling of the system stress matrix: every PMU_SAMPLING_PERIOD events PMU_SAMPLING_EVENT of counter PMU_SAMPLING_COUNTER,
+// the PMU interrupt records the PC and the increments of the other counters (folded on the host by pmu_fold_samples). 0 = disabled, 1 = enabled
+#define PMU_SAMPLING 0
+#define PMU_SAMPLING_COUNTER 4
+#define PMU_SAMPLING_EVENT 0x17
+#define PMU_SAMPLING_PERIOD 10000
+#define PMU_SAMPLING_BUFFER_SIZE 8192
+// PMU interrupt of this core (core 0)
+#define PMU_IRQ_ID K2_PMU_IRQ_ID(0)
+
+// Samples, in MSMC SRAM so that recording does not add DDR traffic
+struct pmu_sample pmu_samples[PMU_SAMPLING_BUFFER_SIZE] __attribute__((section(".msmc_sram")));
+struct pmu_sample_buffer pmu_sample_buf;
+
+// Cache state before each measured run of a benchmark: CACHE_STATE_AS_IS, _COLD (clean and invalidate L1D and L2),
+// _WARM (one discarded priming run) or _POLLUTED (thrashing kernel over pollution_size bytes first)
+const struct cache_state_policy STORE_BURST_CACHE_STATE = {CACHE_STATE_AS_IS, 0};
+const struct cache_state_policy LOAD_BURST_CACHE_STATE = {CACHE_STATE_AS_IS, 0};
+const struct cache_state_policy POINTER_CHASING_CACHE_STATE = {CACHE_STATE_AS_IS, 0};
+const struct cache_state_policy STRESS_MATRIX_CACHE_STATE = {CACHE_STATE_AS_IS, 0};
+
+// Buffer of the thrashing kernel, twice the 4 MB L2 cache
+#define POLLUTION_BUFFER_SIZE (8*1024*1024)
+unsigned char pollution_buffer[POLLUTION_BUFFER_SIZE];
+
+// EMIF event rotation: the two EMIF counters get the next pair of EMIF_ROTATION_EVENTS each run. 0 = disabled, 1 = enabled
+#define EMIF_EVENT_ROTATION 0
+
+// CNTRn_CFG events rotated over the two counters of the EMIF
+const unsigned EMIF_ROTATION_EVENTS[] = {EMIF_EVT_ACCESSES, EMIF_EVT_ACTIVATES, EMIF_EVT_READS, EMIF_EVT_WRITES,
+                                         EMIF_EVT_CMD_FIFO_FULL, EMIF_EVT_WDATA_FIFO_FULL, EMIF_EVT_RDATA_FIFO_FULL,
+                                         EMIF_EVT_RCMD_FIFO_FULL, EMIF_EVT_PRIORITY_ELEVATIONS, EMIF_EVT_CMD_PENDING,
+                                         EMIF_EVT_DATA_BUS_ACTIVE};
+#define NB_EMIF_ROTATION_EVENTS (sizeof(EMIF_ROTATION_EVENTS)/sizeof(EMIF_ROTATION_EVENTS[0]))
+
+// EMIF event scheduler of the event rotation
+struct emif_event_scheduler emif_sched;
+
+// Per-master EMIF attribution: the MSTID filter is swept over the masters while the co-run scenario keeps running. 0 = disabled, 1 = enabled
+#define EMIF_MSTID_SWEEP 0
+// Masters swept. 0 = K2H_MASTERS, 1 = every MSTID (0x00-0xFF, e.g., to find the EDMA transfer controllers), idle ones left out
+#define EMIF_MSTID_SCAN_ALL 0
+// Number of masters x {accesses, activates, reads, writes} matrices
+#define EMIF_MSTID_WINDOWS 10
+
+// Masters of the K2H (66AK2H06 Table 8-6. Master ID Settings)
+const struct emif_master K2H_MASTERS[] = {
+    {"arm", 0x8},
+    {"c66x_0", 0x0}, {"c66x_1", 0x1}, {"c66x_2", 0x2}, {"c66x_3", 0x3},
+    {"c66x_4", 0x4}, {"c66x_5", 0x5}, {"c66x_6", 0x6}, {"c66x_7", 0x7},
+};
+#define NB_K2H_MASTERS (sizeof(K2H_MASTERS)/sizeof(K2H_MASTERS[0]))
+
+// Every MSTID, for the full scan
+struct emif_master all_masters[EMIF_MSTID_MAX_MASTERS];
+
+// Per-master EMIF attribution sweep
+struct emif_mstid_sweep mstid_sweep;
+
+// Controller and interconnect sweep: the benchmarks are run at every point of the CONFIG_KNOBS grid, then the points are
+// ranked by the worst case of the system stress matrix. The boot settings are restored afterwards. 0 = disabled, 1 = enabled
+#define CONFIG_SWEEP 0
+// Runs of each benchmark per point of the grid
+#define CONFIG_SWEEP_RUNS 20
+
+// Settings and boot values of the sweep: ARM AXI priority (0 highest), ARM MSMC starvation bound (SBNDC8),
+// DDR3A priority raise old counter (LAT_CONFIG) and read/write execution thresholds (RWTHRESH)
+#define BOOT_AXI_PRIORITY 0x7
+#define BOOT_ARM_SBNDC 0x00FF00FF
+const unsigned AXI_PRIORITY_VALUES[] = {0x0, 0x7};
+const unsigned ARM_SBNDC_VALUES[] = {0x00100010, 0x00FF00FF};
+const unsigned PR_OLD_COUNT_VALUES[] = {0x20, 0xFF};
+const unsigned RD_THRESH_VALUES[] = {1, 5};
+const unsigned WR_THRESH_VALUES[] = {1, 3};
+const struct config_knob CONFIG_KNOBS[] = {
+    {"axi_priority", configure_AXI, AXI_PRIORITY_VALUES, 2},
+    {"arm_sbndc", apply_arm_sbndc, ARM_SBNDC_VALUES, 2},
+    {"pr_old_count", apply_pr_old_count, PR_OLD_COUNT_VALUES, 2},
+    {"rd_thresh", apply_rd_thresh, RD_THRESH_VALUES, 2},
+    {"wr_thresh", apply_wr_thresh, WR_THRESH_VALUES, 2},
+};
+#define NB_CONFIG_KNOBS (sizeof(CONFIG_KNOBS)/sizeof(CONFIG_KNOBS[0]))
+
+// Benchmarks of the sweep, the critical one first
+const char* const CONFIG_BENCHMARKS[] = {"stress_matrix", "store_burst", "load_burst", "pointer_chasing"};
+#define NB_CONFIG_BENCHMARKS (sizeof(CONFIG_BENCHMARKS)/sizeof(CONFIG_BENCHMARKS[0]))
+
+struct config_sweep config_sweep;
+
+// EMIF chip select (region) filter applied to every EMIF measurement, reads and writes events only. 0 = disabled, 1 = enabled
+#define EMIF_REGION_FILTER 0
+#define EMIF_REGION 0
+// Reads and writes of the system stress matrix counted per chip select, e.g., to tell the partitioned space of page_coloring
+// from the not partitioned one when they sit on different chip selects (SDCFG.EBANK = 1). 0 = disabled, 1 = enabled
+#define EMIF_REGION_SPLIT 0
+#define EMIF_NB_REGIONS 2
+
+// Matrix size of the system stress matrix benchmark
+#define MATRIX_SIZE 512
+
+// Physical address of the first DDR3A byte
+#define DDR3A_BASE_ADDRESS 0x80000000
+// DDR3A geometry, decoded from SDCFG at boot
+struct sdram_geometry ddr_geometry;
+
+// Address whose chip select and row hold the benchmark targets (space free of partitioning, identity mapped)
+#define DDR_TARGET_ADDRESS 0xFA010000
+// Number of benchmark targets, one per bank from bank 0
+#define DDR_NB_TARGETS 4
+// Benchmark targets: first column of the row of DDR_TARGET_ADDRESS in banks 0 to DDR_NB_TARGETS-1
+unsigned ddr_bank_targets[DDR_NB_TARGETS];
+
+// Bank/row/column patterns from the row of DDR_TARGET_ADDRESS (row hit, row conflict, bank round-robin, turnaround). 0 = disabled, 1 = enabled
+#define SDRAM_PATTERN_BENCHMARKS 0
+// Banks of the round-robin pattern, from bank 0
+#define DDR_PATTERN_NB_BANKS 4
+
+// Pattern measured. Address table in MSMC SRAM, so that walking it does not add DDR traffic without data caches
+struct sdram_pattern ddr_pattern __attribute__((section(".msmc_sram")));
+// Data caches cleaned and invalidated before each run, so that the accesses of the pattern reach the SDRAM
+const struct cache_state_policy SDRAM_PATTERN_CACHE_STATE = {CACHE_STATE_COLD, 0};
+
+// STREAM bandwidth kernels (copy, scale, add, triad), STREAM_RUNS runs each, then the bandwidth ceiling. 0 = disabled, 1 = enabled
+#define STREAM_BANDWIDTH 0
+#define STREAM_RUNS 10
+
+// STREAM arrays placement: first word (identity mapped space free of partitioning), words per array and words between two arrays
+#define STREAM_ARRAYS_ADDRESS 0xF0000000
+#define STREAM_ARRAY_WORDS (4*1024*1024)
+#define STREAM_ARRAY_OFFSET_WORDS 0
+
+// A15 cycles at 1200 MHz. DDR3A: PERF_CNT_TIM at 800 MHz, 64-byte accesses (burst of 8 on the 64-bit bus), 16 bytes per cycle at the peak
+const struct stream_platform STREAM_PLATFORM = {"k2_a15_ddr3a", 1200, 800, 64, 16};
+
+struct stream_arrays stream_arrays;
+// Run of highest bandwidth of each kernel
+struct stream_result stream_best[STREAM_NB_KERNELS];
+
+// Latency of randomized pointer chasing over working sets from 4 KB doubling up to POINTER_CHASE_DDR_SIZE, then the plateau of
+// each memory level. 0 = disabled, 1 = enabled
+#define POINTER_CHASE_LATENCY 0
+
+// DDR chains: identity mapped space free of partitioning, 64 MB
+#define POINTER_CHASE_DDR_ADDRESS 0xE0000000
+#define POINTER_CHASE_DDR_SIZE (64*1024*1024)
+// MSMC SRAM chains, 2 MB (MSMC SRAM is mapped uncacheable for the A15: a single plateau)
+#define POINTER_CHASE_MSMC_SIZE (2*1024*1024)
+// SDRAM row of the row-local chains when the geometry could not be decoded (8 KB: 1024 columns on the 64-bit bus)
+#define POINTER_CHASE_DEFAULT_ROW_SIZE (8*1024)
+
+unsigned char pointer_chase_msmc_buffer[POINTER_CHASE_MSMC_SIZE] __attribute__((section(".msmc_sram"), aligned(POINTER_CHASE_PAGE_SIZE)));
+struct pointer_chase_point pointer_chase_points[32];
+
+// Memory levels of the A15 cluster: 32 KB L1D per core, 4 MB shared L2, then the DDR3A
+const struct pointer_chase_level K2_DDR_LEVELS[] = {{"l1", 32*1024}, {"l2", 4*1024*1024}, {"ddr", 0}};
+#define NB_K2_DDR_LEVELS (sizeof(K2_DDR_LEVELS)/sizeof(K2_DDR_LEVELS[0]))
+const struct pointer_chase_level K2_MSMC_LEVELS[] = {{"msmc", 0}};
+
+// Cache-blocked matrix stress tasks: tile of fewest EMIF accesses per run of each task (TILE_TUNER_RUNS runs per candidate),
+// then the task measured with that tile. 0 = disabled, 1 = enabled
+#define TILED_MATRIX_BENCHMARKS 0
+#define TILE_TUNER_RUNS 10
+
+// Candidate tiles (elements, 0: untiled task, the reference of the reduction)
+const unsigned TILE_CANDIDATES[] = {0, 8, 16, 32, 64, 128};
+#define NB_TILE_CANDIDATES (sizeof(TILE_CANDIDATES)/sizeof(TILE_CANDIDATES[0]))
+
+// Cleaned caches before each run, so that a tile does not start from the lines of the previous one
+const struct cache_state_policy TILED_MATRIX_CACHE_STATE = {CACHE_STATE_COLD, 0};
+
+const char* const TILED_MATRIX_NAMES[] = {"matrix_stress1", "matrix_stress2", "matrix_stress3"};
+#define NB_TILED_MATRICES (sizeof(TILED_MATRIX_NAMES)/sizeof(TILED_MATRIX_NAMES[0]))
+
+// Task run by run_tiled_matrix (index in TILED_MATRIX_NAMES) and its tile
+unsigned tiled_matrix_task = 0;
+unsigned tiled_matrix_tile = 0;
+
+// First partition bit of the page coloring when the bank bits cannot be decoded from SDCFG
+#define DEFAULT_PARTITION_BIT 14
 
 
 /* ========================================================================== */
@@ -65,6 +349,10 @@ int main(void)
     // Disable caches for a safe cache set up
     ARM_disable_caches();
 
+    // Decode the DDR3A geometry before the page coloring and the benchmark targets use it
+    unsigned geometry_valid = (sdram_geometry_init(&ddr_geometry, &SDRAM_SDCFG_KEYSTONE2, emif_get_sdcfg(&emif_bus_ddr3a.controller[0]), DDR3A_BASE_ADDRESS) == 0);
+    ddr_targets_init(geometry_valid);
+
     // Configure ARM
     if(ARM_INIT_CONFIGURATION == 1)
         ARM_init(0xC8000000);
@@ -72,142 +360,852 @@ int main(void)
         enable_caches(1,0);
 
     // Set ARM AXI bus priority
-    configure_AXI(0x7);
+    configure_AXI(BOOT_AXI_PRIORITY);
 
     // Change salve starvation value
-    write_ARM_SBNDC(0x00FF00FF);
+    write_ARM_SBNDC(BOOT_ARM_SBNDC);
 
     // Configure EMIF performance counters
     DDR_configure_eval(1);
+    DDR_configure_region(EMIF_REGION_FILTER, EMIF_REGION);
 
     // Configure ARM Cortex A15 performance counters
     counters_init();
 
+    // Measure the probe cost, which is then removed from every PMU measurement
+    counters_calibrate(PMU_CALIBRATION_RUNS);
+
+    // Buffer of the polluted cache state
+    cache_state_init(pollution_buffer, POLLUTION_BUFFER_SIZE);
+
+    if(geometry_valid)
+        sdram_geometry_print(&ddr_geometry, write_UART_THR);
+    else
+        write_UART_THR("DDR3A SDCFG not decoded: default benchmark targets and partition bit \n\r");
+
     write_UART_THR("Task profiling: Start-Stop pattern on ARMs \n\r");
     write_UART_THR("Task profiling: Start-Read pattern on memory controller \n\r");
 
     unsigned i = 0;
     char data_str[256];
 
+    sprintf(data_str, "PMU probe cost (subtracted): %u %u %u %u %u %u %u \n\r", pmu_overhead.cycles, pmu_overhead.evt[0], pmu_overhead.evt[1], pmu_overhead.evt[2], pmu_overhead.evt[3], pmu_overhead.evt[4], pmu_overhead.evt[5]);
+    write_UART_THR(data_str);
+
 
     /* Start tasks profiling */
     /*************************/
 
+    // ARM counters, EMIF counters and EMIF timer of the same runs: one pass per benchmark
     // Intended for no data caches implementation
-    write_UART_THR("Store burst on DDR SDRAM bank 0: Execution time (cycles), bus accesses, L1 and L2 cache access and refill, and miss-predicted branch \n\r");
+    write_UART_THR("Store burst on DDR SDRAM bank 0: Execution time (cycles), bus accesses, L1 and L2 cache access and refill, miss-predicted branch, EMIF utilization time (cycles), number of accesses and actives, snapshot skew, ACOR, row hit ratio \n\r");
+    measure_benchmark("store_burst", &STORE_BURST_CACHE_STATE, run_store_burst);
 
-    for(i=0; i < MAX_ITERATIONS; i++){
-        critical_task_start_eval();
-        cpu_microbenchmark_store(DDR_BANK_0, 0xFF00FF);
-        __asm__ __volatile("dsb");
-        critical_task_end_eval();
-        sprintf(data_str, "%u %u %u %u %u %u %u %u \n\r", i, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
-        write_UART_THR(data_str);
+    // Intended for no data caches implementation
+    write_UART_THR("Load burst on DDR SDRAM bank 0: Execution time (cycles), bus accesses, L1 and L2 cache access and refill, miss-predicted branch, EMIF utilization time (cycles), number of accesses and actives, snapshot skew, ACOR, row hit ratio \n\r");
+    measure_benchmark("load_burst", &LOAD_BURST_CACHE_STATE, run_load_burst);
 
+    // Intended especially for data caches implementation but also useful for the without data caches implementation
+    write_UART_THR("Pointer chasing (cache stress): Execution time (cycles), bus accesses, L1 and L2 cache access and refill, miss-predicted branch, EMIF utilization time (cycles), number of accesses and actives, snapshot skew, ACOR, row hit ratio \n\r");
+    measure_benchmark("pointer_chasing", &POINTER_CHASING_CACHE_STATE, run_pointer_chasing);
+
+    // Intended especially for data caches implementation but also useful for the without data caches implementation
+    write_UART_THR("System stress matrix: Execution time (cycles), bus accesses, L1 and L2 cache access and refill, miss-predicted branch, EMIF utilization time (cycles), number of accesses and actives, snapshot skew, ACOR, row hit ratio \n\r");
+    measure_benchmark("stress_matrix", &STRESS_MATRIX_CACHE_STATE, run_stress_matrix);
+
+    // One scenario of the row-buffer cost at a time, intended for no data caches implementation
+    if(SDRAM_PATTERN_BENCHMARKS && geometry_valid){
+        write_UART_THR("DDR SDRAM patterns: scenario, operation, accesses, rows, banks, first location, then execution time (cycles), bus accesses, L1 and L2 cache access and refill, miss-predicted branch, EMIF utilization time (cycles), number of accesses and actives, snapshot skew, ACOR, row hit ratio \n\r");
+        measure_ddr_patterns();
     }
 
+    // Vectorized kernels over arrays much larger than the L2 cache, intended for data caches implementation
+    if(STREAM_BANDWIDTH){
+        write_UART_THR("STREAM bandwidth: kernel, bytes, execution time (cycles), MB/s, EMIF utilization time (cycles), number of accesses, EMIF MB/s, data bus utilization (per mille), then the best run of each kernel and the ceiling \n\r");
+        measure_stream();
+    }
 
-    // Intended for no data caches implementation
-    write_UART_THR("Store burst on DDR SDRAM bank 0: EMIF utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
+    // Random cyclic chains, intended for data caches implementation: random hops are row misses out of the caches, row-local hops
+    // row hits, page hops add a TLB miss
+    if(POINTER_CHASE_LATENCY){
+        write_UART_THR("Pointer chasing latency: sweep, working set (bytes), node granularity, window, hops, execution time (cycles), cycles per hop, then the plateau of each memory level \n\r");
+        measure_pointer_chase();
+    }
 
-    for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
-        cpu_microbenchmark_store(DDR_BANK_0, 0xFF00FF);
-        __asm__ __volatile("dsb");
-        DDR_end_eval();
+    // Same tasks restructured instead of remapped, intended for data caches implementation
+    if(TILED_MATRIX_BENCHMARKS){
+        write_UART_THR("Cache-blocked matrix stress: task, tile, runs, mean execution time (cycles), mean EMIF accesses, then the best tile, its time, accesses and reduction of the untiled accesses (per mille), then the task with the best tile \n\r");
+        measure_tiled_matrices();
+    }
 
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
-        write_UART_THR(data_str);
+
+    if(PMU_EVENT_FINGERPRINT){
+        // Events are rotated in groups of six over the iterations, so every event is seen in a single boot
+        write_UART_THR("System stress matrix event fingerprint: event, raw count, coverage (per mille), scaled count \n\r");
+
+        pmu_sched_init(&pmu_sched, &pmu_armv7_source, FINGERPRINT_EVENTS, NB_FINGERPRINT_EVENTS);
+
+        for(i=0; i < MAX_ITERATIONS; i++){
+            pmu_sched_start(&pmu_sched);
+            matrix_stress2_task(MATRIX_SIZE);
+            __asm__ __volatile("dsb");
+            pmu_sched_stop(&pmu_sched);
+        }
+
+        for(i=0; i < pmu_sched.nb_events; i++){
+            sprintf(data_str, "0x%02X %llu %u %llu \n\r", pmu_sched.event_ids[i], pmu_sched.count[i], pmu_sched_coverage_permille(&pmu_sched, i), pmu_sched_scaled_count(&pmu_sched, i));
+            write_UART_THR(data_str);
+        }
+
+        // Restore the default events
+        counters_init();
     }
 
 
-    // Intended for no data caches implementation
-    write_UART_THR("Load burst on DDR SDRAM bank 0: Execution time (cycles), bus accesses, L1 and L2 cache access and refill, and miss-predicted branch \n\r");
+    if(PMU_REGION_PASS){
+        // Phases of every run are recorded in the ring buffer and dumped at the end, without per-phase printing
+        write_UART_THR("System stress matrix phases: region, depth, start (cycles), execution time (cycles), ARM events, EMIF accesses, activates and utilization time \n\r");
 
-    for(i=0; i < MAX_ITERATIONS; i++){
+        region_init(region_ring, PMU_REGION_RING_SIZE, region_read_counters);
         critical_task_start_eval();
-        cpu_microbenchmark_load(DDR_BANK_1);
-        __asm__ __volatile("dsb");
+
+        for(i=0; i < MAX_ITERATIONS; i++){
+            region_begin(MATRIX_TASK_REGION);
+            matrix_stress2_task(MATRIX_SIZE);
+            __asm__ __volatile("dsb");
+            region_end(MATRIX_TASK_REGION);
+        }
+
         critical_task_end_eval();
 
-        sprintf(data_str, "%u %u %u %u %u %u %u %u \n\r", i, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
-        write_UART_THR(data_str);
+        // Row-buffer locality of the whole task and of each phase over the iterations: name, metric, runs, min, mean, max
+        for(i=0; i < NB_MATRIX_REGIONS; i++){
+            pmu_metrics_stats_reset(&bench_stats, MATRIX_REGION_NAMES[i]);
+            region_stats_add(i, counters_event_ids, &bench_stats);
+            pmu_metrics_stats_print_mask(&bench_stats, PMU_METRICS_ROW_LOCALITY, write_UART_THR);
+        }
 
+        region_dump();
+
+        // Disable the markers
+        region_init(NULL, 0, NULL);
     }
 
-    // Intended for no data caches implementation
-    write_UART_THR("Load burst on DDR SDRAM bank 0: EMIF utilization time (cycles), number of accesses and actives \n\r");
 
-    for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
-        cpu_microbenchmark_load(DDR_BANK_1);
+    if(PMU_SAMPLING){
+        // The counters run for the whole pass, the PMU interrupt taking a sample every PMU_SAMPLING_PERIOD events
+        write_UART_THR("System stress matrix samples: reference symbol (M), PC, cycles and ARM events since the previous sample (S), lost samples (L) \n\r");
+
+        pmu_sample_buffer_init(&pmu_sample_buf, pmu_samples, PMU_SAMPLING_BUFFER_SIZE, PMU_SAMPLING_COUNTER, PMU_SAMPLING_PERIOD);
+        gic_enable_interrupt(PMU_IRQ_ID, 1, 0x1);
+        enable_IRQ();
+
+        counters_sampling_start(&pmu_sample_buf, PMU_SAMPLING_COUNTER, PMU_SAMPLING_EVENT, PMU_SAMPLING_PERIOD);
+        for(i=0; i < MAX_ITERATIONS; i++)
+            matrix_stress2_task(MATRIX_SIZE);
         __asm__ __volatile("dsb");
-        DDR_end_eval();
+        counters_sampling_stop();
 
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
-        write_UART_THR(data_str);
+        disable_IRQ();
+        gic_disable_interrupt(PMU_IRQ_ID);
+
+        pmu_sample_print(&pmu_sample_buf);
     }
 
 
-    // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("Pointer chasing (cache stress): Execution time (cycles), bus accesses, L1 and L2 cache access and refill, and miss-predicted branch \n\r");
+    if(PMU_XCORE_HARVEST){
+        // Aggressors are asked for their counters right before and after each victim run (outside of the measurement)
+        write_UART_THR("System stress matrix with aggressors: victim execution time (cycles) and ARM events, then for each aggressor core, cycles and ARM events during the run \n\r");
 
-    for(i=0; i < MAX_ITERATIONS; i++){
-        critical_task_start_eval();
-        cpu_pointer_chasing_microbenchmark(100000, 16, 8*1024*1024);
-        __asm__ __volatile("dsb");
-        critical_task_end_eval();
+        struct pmu_snapshot xcore_begin[PMU_XCORE_NB_CORES], xcore_end[PMU_XCORE_NB_CORES];
+        unsigned answered;
 
-        sprintf(data_str, "%u %u %u %u %u %u %u %u \n\r", i, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
-        write_UART_THR(data_str);
+        pmu_xcore_init(xcore_area);
 
+        for(i=0; i < MAX_ITERATIONS; i++){
+            answered = xcore_harvest(2*i + 1, xcore_begin);
+            critical_task_start_eval();
+            matrix_stress2_task(MATRIX_SIZE);
+            __asm__ __volatile("dsb");
+            critical_task_end_eval();
+            answered &= xcore_harvest(2*i + 2, xcore_end);
+
+            report_xcore_run(i, answered, xcore_begin, xcore_end);
+        }
     }
 
-    // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("Pointer chasing (cache stress): EMIF utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
 
-    for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
-        cpu_pointer_chasing_microbenchmark(100000, 16, 8*1024*1024);
-        __asm__ __volatile("dsb");
-        DDR_end_eval();
+    if(EMIF_REGION_SPLIT){
+        // Master filter kept, reads and writes restricted to one chip select at a time
+        write_UART_THR("System stress matrix per chip select: region, iteration, EMIF utilization time (cycles), number of reads and writes \n\r");
+
+        unsigned region;
+
+        set_PERF_CNT_EVENT(0, EMIF_EVT_READS);
+        set_PERF_CNT_EVENT(1, EMIF_EVT_WRITES);
+
+        for(region = 0; region < EMIF_NB_REGIONS; region++){
+            DDR_configure_region(1, region);
+
+            for(i=0; i < MAX_ITERATIONS; i++){
+                cache_state_prepare(&STRESS_MATRIX_CACHE_STATE, run_stress_matrix);
+                DDR_start_eval();
+                matrix_stress2_task(MATRIX_SIZE);
+                __asm__ __volatile("dsb");
+                DDR_end_eval();
+
+                sprintf(data_str, "%u %u %u %u %u \n\r", region, i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
+                write_UART_THR(data_str);
+            }
+        }
+
+        // Restore the default events and region filter
+        DDR_configure_eval(1);
+        DDR_configure_region(EMIF_REGION_FILTER, EMIF_REGION);
+    }
+
+
+    if(EMIF_EVENT_ROTATION){
+        // Events are rotated in pairs over the iterations, so the complete EMIF event vector of each benchmark is seen in a single boot
+        write_UART_THR("EMIF event vector: benchmark, event, raw count, coverage (per mille), scaled count, then read/write proportions (per mille) \n\r");
+
+        emif_rotate("store_burst", &STORE_BURST_CACHE_STATE, run_store_burst);
+        emif_rotate("load_burst", &LOAD_BURST_CACHE_STATE, run_load_burst);
+        emif_rotate("pointer_chasing", &POINTER_CHASING_CACHE_STATE, run_pointer_chasing);
+        emif_rotate("stress_matrix", &STRESS_MATRIX_CACHE_STATE, run_stress_matrix);
+
+        // Restore the default events (accesses and activates)
+        DDR_configure_eval(1);
+    }
+
+
+    if(EMIF_MSTID_SWEEP){
+        // One victim run per master and per pair of events, the aggressors keep running. Rates per million EMIF cycles
+        write_UART_THR("EMIF per-master attribution (system stress matrix with aggressors): window, master, accesses, activates, reads, writes per 1000000 EMIF cycles \n\r");
+
+        if(EMIF_MSTID_SCAN_ALL){
+            for(i=0; i < EMIF_MSTID_MAX_MASTERS; i++){
+                all_masters[i].name = NULL;
+                all_masters[i].id = i;
+            }
+            emif_mstid_init(&mstid_sweep, &emif_bus_ddr3a, all_masters, EMIF_MSTID_MAX_MASTERS);
+        }
+        else
+            emif_mstid_init(&mstid_sweep, &emif_bus_ddr3a, K2H_MASTERS, NB_K2H_MASTERS);
+
+        while(mstid_sweep.window < EMIF_MSTID_WINDOWS){
+            cache_state_prepare(&STRESS_MATRIX_CACHE_STATE, run_stress_matrix);
+            emif_mstid_start(&mstid_sweep);
+            matrix_stress2_task(MATRIX_SIZE);
+            __asm__ __volatile("dsb");
+            if(emif_mstid_stop(&mstid_sweep))
+                emif_mstid_print(&mstid_sweep, EMIF_MSTID_SCAN_ALL, write_UART_THR);
+        }
+
+        // Restore the default events and master
+        DDR_configure_eval(1);
+    }
+
+
+    if(CONFIG_SWEEP){
+        // Rank, settings, then worst and mean execution time (cycles) of each benchmark at that point
+        write_UART_THR("Controller configuration sweep: rank, settings, then for each benchmark, worst and mean execution time (cycles) \n\r");
+
+        unsigned lat_config = *emif_reg(&emif_bus_ddr3a.controller[0], emif_bus_ddr3a.controller[0].regs->lat_config);
+        unsigned rwthresh = *emif_reg(&emif_bus_ddr3a.controller[0], emif_bus_ddr3a.controller[0].regs->rwthresh);
+
+        if(config_sweep_init(&config_sweep, CONFIG_KNOBS, NB_CONFIG_KNOBS, CONFIG_BENCHMARKS, NB_CONFIG_BENCHMARKS, 0) < 0)
+            write_UART_THR("Configuration grid too large \n\r");
+        else{
+            config_sweep_run(&config_sweep, config_measure, CONFIG_SWEEP_RUNS);
+            config_sweep_print(&config_sweep, write_UART_THR);
+        }
 
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
+        // Restore the boot settings
+        configure_AXI(BOOT_AXI_PRIORITY);
+        write_ARM_SBNDC(BOOT_ARM_SBNDC);
+        *emif_reg(&emif_bus_ddr3a.controller[0], emif_bus_ddr3a.controller[0].regs->lat_config) = lat_config;
+        *emif_reg(&emif_bus_ddr3a.controller[0], emif_bus_ddr3a.controller[0].regs->rwthresh) = rwthresh;
+    }
+
+
+    if(PMU_EVENT_SWEEP){
+        // One run per group of six events and per size. Event, count per size, growth exponent with the size
+        write_UART_THR("Event fingerprint sweep: task sizes, cycles per run, non-zero events (count per size, growth exponent), dead events \n\r");
+
+        pmu_sweep_run(&pmu_armv7_source, SWEEP_TASKS, NB_SWEEP_TASKS, write_UART_THR);
+
+        // Restore the default events
+        counters_init();
+    }
+
+
+    while(1);
+}
+
+
+/* irq_dispatch
+ *
+ * Description: Interrupt service routine, called by IRQ_Handler (startup_ARMCA15.S): acknowledges the interrupt, serves the PMU
+ *              interrupt of this core (a sample of the statistical sampling) and signals the end of the interrupt
+ *
+ * Parameter:
+ *              - unsigned long pc: Interrupted program counter
+ *
+ * Returns:     Nothing
+ *
+ * */
+void irq_dispatch(unsigned long pc){
+    unsigned id = gic_acknowledge();
+
+    if(id == GIC_SPURIOUS_ID)
+        return;
+
+    if(id == PMU_IRQ_ID)
+        counters_sampling_irq_handler(pc);
+
+    gic_end_of_interrupt(id);
+}
+
+
+/* region_read_counters
+ *
+ * Description: Reads the free-running ARM and EMIF performance counters for the region markers
+ *
+ * Parameter:
+ *              - struct pmu_region_counters* counters: Where the counters values are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void region_read_counters(struct pmu_region_counters* counters){
+    struct emif_snapshot snapshot;
+
+    pmu_armv7_source.read(&counters->pmu);
+
+    emif_bus_snapshot(&emif_bus_ddr3a, &snapshot);
+    counters->emif[0] = snapshot.evt[0][0];
+    counters->emif[1] = snapshot.evt[0][1];
+    counters->emif[2] = snapshot.cycles[0];
+
+    // Single EMIF
+    counters->emif[3] = 0;
+    counters->emif[4] = 0;
+    counters->emif[5] = 0;
+}
+
+
+/* measurement_start
+ *
+ * Description: Reads the EMIF counters, then starts the ARM counters. The ARM counters are the innermost probe:
+ *              they do not see the EMIF register reads, and their CP15 accesses never reach the EMIF.
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void measurement_start(void){
+    DDR_start_eval();
+    critical_task_start_eval();
+}
+
+
+/* measurement_end
+ *
+ * Description: Stops the ARM counters, then reads the EMIF counters (reverse order of measurement_start)
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void measurement_end(void){
+    critical_task_end_eval();
+    DDR_end_eval();
+}
+
+
+/* report_run
+ *
+ * Description: Adds the derived metrics of an iteration to the benchmark statistics and, unless PMU_SUMMARY_OUTPUT is set,
+ *              prints its ARM and EMIF counters followed by its ACOR and row hit ratio
+ *
+ * Parameter:
+ *              - struct pmu_metrics_stats* stats: Statistics of the benchmark
+ *              - unsigned id: Iteration number
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void report_run(struct pmu_metrics_stats* stats, unsigned id){
+    struct pmu_metrics_input input = {0};
+    unsigned long long metrics[PMU_NB_METRICS];
+    char data_str[256];
+
+    input.cycles = valueCf;
+    input.event_ids = counters_event_ids;
+    input.evt[0] = value0f;
+    input.evt[1] = value1f;
+    input.evt[2] = value2f;
+    input.evt[3] = value3f;
+    input.evt[4] = value4f;
+    input.evt[5] = value5f;
+
+    input.emif_cycles = result_ddr_cycles_emif0;
+    input.emif_accesses = result_ddr_evt0_emif0;
+    input.emif_activates = result_ddr_evt1_emif0;
+
+    pmu_metrics_stats_add(stats, &input);
+
+    if(!PMU_SUMMARY_OUTPUT){
+        pmu_metrics_compute(&input, metrics);
+
+        sprintf(data_str, "%u %llu %llu %llu %llu %llu %llu %llu %u %u %u %u %llu.%03llu %llu.%03llu \n\r", id, valueCf, value0f, value1f, value2f, value3f, value4f, value5f,
+                result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_skew,
+                metrics[PMU_METRIC_ACOR] / PMU_METRIC_SCALE, metrics[PMU_METRIC_ACOR] % PMU_METRIC_SCALE,
+                metrics[PMU_METRIC_ROW_HIT_RATIO] / PMU_METRIC_SCALE, metrics[PMU_METRIC_ROW_HIT_RATIO] % PMU_METRIC_SCALE);
         write_UART_THR(data_str);
     }
+}
 
 
-    // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("System stress matrix: Execution time (cycles), bus accesses, L1 and L2 cache access and refill, and miss-predicted branch \n\r");
+/* measure_benchmark
+ *
+ * Description: Runs a benchmark MAX_ITERATIONS times with the ARM and EMIF counters read at the same probe points,
+ *              then prints the summary when PMU_SUMMARY_OUTPUT is set, or the row-buffer locality (ACOR, row hit ratio and
+ *              row switches min/mean/max over the iterations) otherwise
+ *
+ * Parameter:
+ *              - const char* name: Benchmark name
+ *              - const struct cache_state_policy* policy: Cache state policy of the benchmark
+ *              - void (*task)(void): The benchmark
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void measure_benchmark(const char* name, const struct cache_state_policy* policy, void (*task)(void)){
+    unsigned i;
 
-    unsigned const MATRIX_SIZE = 512;
+    pmu_metrics_stats_reset(&bench_stats, name);
 
     for(i=0; i < MAX_ITERATIONS; i++){
-        critical_task_start_eval();
-        matrix_stress2_task(MATRIX_SIZE);
+        cache_state_prepare(policy, task);
+        measurement_start();
+        task();
         __asm__ __volatile("dsb");
-        critical_task_end_eval();
+        measurement_end();
 
-        sprintf(data_str, "%u %u %u %u %u %u %u %u \n\r", i, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
-        write_UART_THR(data_str);
+        report_run(&bench_stats, i);
+    }
 
+    if(PMU_SUMMARY_OUTPUT)
+        pmu_metrics_stats_print(&bench_stats, write_UART_THR);
+    else
+        pmu_metrics_stats_print_mask(&bench_stats, PMU_METRICS_ROW_LOCALITY, write_UART_THR);
+}
+
+
+/* xcore_harvest
+ *
+ * Description: Requests a new epoch to the aggressors and collects their counters
+ *
+ * Parameter:
+ *              - unsigned epoch: New epoch
+ *              - struct pmu_snapshot* snapshots: PMU_XCORE_NB_CORES elements where the counters of each aggressor are written
+ *
+ * Returns:     The mask of the aggressors which answered (bit n = core n)
+ *
+ * */
+static unsigned xcore_harvest(unsigned epoch, struct pmu_snapshot* snapshots){
+    unsigned core, answered = 0;
+
+    pmu_xcore_request(xcore_area, epoch);
+
+    for(core = 1; core < PMU_XCORE_NB_CORES; core++)
+        if(pmu_xcore_collect(xcore_area, core, epoch, PMU_XCORE_TIMEOUT, &snapshots[core]) == 0)
+            answered |= 1u << core;
+
+    return answered;
+}
+
+
+/* report_xcore_run
+ *
+ * Description: Prints the victim counters of a run followed by "<core> <cycles> <evt0> ... <evt5>" for each aggressor,
+ *              or "<core> -" when it did not answer
+ *
+ * Parameter:
+ *              - unsigned id: Iteration number
+ *              - unsigned answered: Aggressors which answered before and after the run
+ *              - const struct pmu_snapshot* begin: Aggressors counters before the run
+ *              - const struct pmu_snapshot* end: Aggressors counters after the run
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void report_xcore_run(unsigned id, unsigned answered, const struct pmu_snapshot* begin, const struct pmu_snapshot* end){
+    char data_str[512];
+    unsigned core, length, i;
+
+    length = sprintf(data_str, "%u %llu %llu %llu %llu %llu %llu %llu", id, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
+
+    for(core = 1; core < PMU_XCORE_NB_CORES; core++){
+        if(!(answered & (1u << core))){
+            length += sprintf(data_str + length, " %u -", core);
+            continue;
+        }
+
+        // Free-running 32-bit counters: the increments are correct across a single wrap
+        length += sprintf(data_str + length, " %u %u", core, end[core].cycles - begin[core].cycles);
+        for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+            length += sprintf(data_str + length, " %u", end[core].evt[i] - begin[core].evt[i]);
     }
 
-    // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("System stress matrix: EMIF utilization time (cycles), number of accesses and actives for both EMIFs\n\r");
+    sprintf(data_str + length, " \n\r");
+    write_UART_THR(data_str);
+}
+
+
+/* emif_rotate
+ *
+ * Description: Runs a benchmark MAX_ITERATIONS times with the EMIF event rotation and prints its EMIF event vector
+ *
+ * Parameter:
+ *              - const char* name: Benchmark name
+ *              - const struct cache_state_policy* policy: Cache state policy of the benchmark
+ *              - void (*task)(void): The benchmark
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void emif_rotate(const char* name, const struct cache_state_policy* policy, void (*task)(void)){
+    unsigned i;
+
+    emif_sched_init(&emif_sched, &emif_bus_ddr3a, EMIF_ROTATION_EVENTS, NB_EMIF_ROTATION_EVENTS);
 
     for(i=0; i < MAX_ITERATIONS; i++){
-        DDR_start_eval();
-        matrix_stress2_task(MATRIX_SIZE);
+        cache_state_prepare(policy, task);
+        emif_sched_start(&emif_sched);
+        task();
         __asm__ __volatile("dsb");
-        DDR_end_eval();
+        emif_sched_stop(&emif_sched);
+    }
 
-        sprintf(data_str, "%u %u %u %u \n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
-        write_UART_THR(data_str);
+    emif_sched_print(&emif_sched, name, write_UART_THR);
+}
+
+
+/* ddr_targets_init
+ *
+ * Description: Places the benchmark targets in banks 0 to DDR_NB_TARGETS-1 of the row of DDR_TARGET_ADDRESS,
+ *              or 8 KB apart from DDR_TARGET_ADDRESS when the geometry could not be decoded
+ *
+ * Parameter:
+ *              - unsigned geometry_valid: 1 if ddr_geometry was decoded from SDCFG, 0 otherwise
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void ddr_targets_init(unsigned geometry_valid){
+    struct sdram_location target;
+    unsigned i;
+
+    if(!geometry_valid){
+        for(i = 0; i < DDR_NB_TARGETS; i++)
+            ddr_bank_targets[i] = DDR_TARGET_ADDRESS + i*0x2000;
+        return;
     }
 
+    sdram_decode(&ddr_geometry, DDR_TARGET_ADDRESS, &target);
 
-    while(1);
+    for(i = 0; i < DDR_NB_TARGETS; i++)
+        ddr_bank_targets[i] = (unsigned)sdram_bank_address(&ddr_geometry, target.chip, i, target.row);
+}
+
+
+/* measure_ddr_patterns
+ *
+ * Description: Builds every scenario of sdram_pattern.h from the location of DDR_TARGET_ADDRESS, with reads then with writes
+ *              (the turnaround once), and measures each pattern as a benchmark
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void measure_ddr_patterns(void){
+    struct sdram_location origin;
+    unsigned scenario, op;
+    char name[64];
+
+    sdram_decode(&ddr_geometry, DDR_TARGET_ADDRESS, &origin);
+
+    for(scenario = 0; scenario < SDRAM_NB_PATTERNS; scenario++)
+        for(op = SDRAM_PATTERN_READ; op <= SDRAM_PATTERN_WRITE; op++){
+            // The turnaround reads and writes by itself
+            if(scenario == SDRAM_PATTERN_TURNAROUND && op == SDRAM_PATTERN_WRITE)
+                continue;
+
+            if(sdram_pattern_build(&ddr_pattern, &ddr_geometry, scenario, op, &origin, DDR_PATTERN_NB_BANKS, sdram_pattern_physical, NULL) < 0){
+                sprintf(name, "%s: not available with this geometry \n\r", SDRAM_PATTERN_NAMES[scenario]);
+                write_UART_THR(name);
+                continue;
+            }
+
+            sdram_pattern_print(&ddr_pattern, &origin, DDR_PATTERN_NB_BANKS, write_UART_THR);
+            sprintf(name, "%s_%s", SDRAM_PATTERN_NAMES[scenario], SDRAM_PATTERN_OP_NAMES[ddr_pattern.op]);
+            measure_benchmark(name, &SDRAM_PATTERN_CACHE_STATE, run_ddr_pattern);
+        }
+}
+
+
+/* measure_stream
+ *
+ * Description: Runs every STREAM kernel STREAM_RUNS times with the ARM and EMIF counters read at the same probe points,
+ *              prints each run, then the best run of each kernel and the bandwidth ceiling
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void measure_stream(void){
+    struct stream_result result;
+    unsigned kernel, i;
+
+    if(stream_arrays_init(&stream_arrays, (unsigned*)STREAM_ARRAYS_ADDRESS, STREAM_ARRAY_WORDS, STREAM_ARRAY_OFFSET_WORDS) < 0){
+        write_UART_THR("STREAM array size and offset must be multiples of 16 words \n\r");
+        return;
+    }
+
+    memset(stream_best, 0, sizeof(stream_best));
+
+    for(kernel = 0; kernel < STREAM_NB_KERNELS; kernel++)
+        for(i = 0; i < STREAM_RUNS; i++){
+            measurement_start();
+            stream_run(&stream_arrays, kernel);
+            __asm__ __volatile("dsb");
+            measurement_end();
+
+            result.kernel = kernel;
+            result.nb_words = stream_arrays.nb_words;
+            result.time = valueCf;
+            result.emif_cycles = result_ddr_cycles_emif0;
+            result.emif_accesses = result_ddr_evt0_emif0;
+
+            stream_print(&STREAM_PLATFORM, &result, write_UART_THR);
+            stream_ceiling_update(&STREAM_PLATFORM, stream_best, &result);
+        }
+
+    stream_print_ceiling(&STREAM_PLATFORM, stream_best, write_UART_THR);
+}
+
+
+/* chase_measure
+ *
+ * Description: Measures the hops of a pointer chasing chain with the ARM cycle counter
+ *
+ * Parameter:
+ *              - void* head: First node
+ *              - unsigned nb_hops: Hops
+ *
+ * Returns:     The execution time (cycles)
+ *
+ * */
+static unsigned long long chase_measure(void* head, unsigned nb_hops){
+    critical_task_start_eval();
+    pointer_chase_sink = pointer_chase_run(head, nb_hops);
+    __asm__ __volatile("dsb");
+    critical_task_end_eval();
+
+    return valueCf;
+}
+
+
+/* measure_pointer_chase
+ *
+ * Description: Sweeps the working set of random chains in DDR (cache line nodes, anywhere or within a SDRAM row, and page nodes)
+ *              and in MSMC SRAM, and prints the latency plateau of each level
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void measure_pointer_chase(void){
+    unsigned char* ddr_buffer = (unsigned char*)POINTER_CHASE_DDR_ADDRESS;
+    unsigned row_size = POINTER_CHASE_DEFAULT_ROW_SIZE;
+    unsigned nb_points;
+
+    // ddr_geometry.layout is only set once SDCFG was decoded
+    if(ddr_geometry.layout != NULL)
+        row_size = 1u << (ddr_geometry.bus_bits + ddr_geometry.column_bits);
+
+    nb_points = pointer_chase_sweep("random", ddr_buffer, POINTER_CHASE_DDR_SIZE, POINTER_CHASE_LINE_SIZE, 0, chase_measure, pointer_chase_points, 32, write_UART_THR);
+    pointer_chase_print_plateaus("random", pointer_chase_points, nb_points, K2_DDR_LEVELS, NB_K2_DDR_LEVELS, write_UART_THR);
+
+    nb_points = pointer_chase_sweep("row_local", ddr_buffer, POINTER_CHASE_DDR_SIZE, POINTER_CHASE_LINE_SIZE, row_size, chase_measure, pointer_chase_points, 32, write_UART_THR);
+    pointer_chase_print_plateaus("row_local", pointer_chase_points, nb_points, K2_DDR_LEVELS, NB_K2_DDR_LEVELS, write_UART_THR);
+
+    nb_points = pointer_chase_sweep("page", ddr_buffer, POINTER_CHASE_DDR_SIZE, POINTER_CHASE_PAGE_SIZE, 0, chase_measure, pointer_chase_points, 32, write_UART_THR);
+    pointer_chase_print_plateaus("page", pointer_chase_points, nb_points, K2_DDR_LEVELS, NB_K2_DDR_LEVELS, write_UART_THR);
+
+    nb_points = pointer_chase_sweep("msmc", pointer_chase_msmc_buffer, POINTER_CHASE_MSMC_SIZE, POINTER_CHASE_LINE_SIZE, 0, chase_measure, pointer_chase_points, 32, write_UART_THR);
+    pointer_chase_print_plateaus("msmc", pointer_chase_points, nb_points, K2_MSMC_LEVELS, 1, write_UART_THR);
+}
+
+
+/* run_tiled_matrix
+ *
+ * Description: Runs the cache-blocked task tiled_matrix_task with tiled_matrix_tile
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void run_tiled_matrix(void){
+    if(tiled_matrix_task == 0)
+        matrix_stress1_tiled_task(MATRIX_SIZE, tiled_matrix_tile);
+    else if(tiled_matrix_task == 1)
+        matrix_stress2_tiled_task(MATRIX_SIZE, tiled_matrix_tile);
+    else
+        matrix_stress3_tiled_task(MATRIX_SIZE, tiled_matrix_tile);
+}
+
+
+/* tile_measure
+ *
+ * Description: Measures one run of the cache-blocked task tiled_matrix_task with a tile, from cleaned caches
+ *
+ * Parameter:
+ *              - unsigned tile: Tile of the run
+ *              - unsigned long long* time: Where the execution time (cycles) is written
+ *              - unsigned long long* emif_accesses: Where the EMIF accesses are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void tile_measure(unsigned tile, unsigned long long* time, unsigned long long* emif_accesses){
+    tiled_matrix_tile = tile;
+
+    cache_state_prepare(&TILED_MATRIX_CACHE_STATE, run_tiled_matrix);
+    measurement_start();
+    run_tiled_matrix();
+    __asm__ __volatile("dsb");
+    measurement_end();
+
+    *time = valueCf;
+    *emif_accesses = result_ddr_evt0_emif0;
+}
+
+
+/* measure_tiled_matrices
+ *
+ * Description: Tunes the tile of every cache-blocked matrix stress task, then measures the task with its best tile as a benchmark
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void measure_tiled_matrices(void){
+    char name[64];
+
+    for(tiled_matrix_task = 0; tiled_matrix_task < NB_TILED_MATRICES; tiled_matrix_task++){
+        tiled_matrix_tile = tile_tune(TILED_MATRIX_NAMES[tiled_matrix_task], TILE_CANDIDATES, NB_TILE_CANDIDATES, TILE_TUNER_RUNS, tile_measure, write_UART_THR);
+
+        sprintf(name, "%s_tiled", TILED_MATRIX_NAMES[tiled_matrix_task]);
+        measure_benchmark(name, &TILED_MATRIX_CACHE_STATE, run_tiled_matrix);
+    }
+}
+
+
+// Benchmarks run by the warm cache state
+static void run_store_burst(void){
+    cpu_microbenchmark_store(ddr_bank_targets[0], 0xFF00FF);
+}
+
+
+static void run_load_burst(void){
+    cpu_microbenchmark_load(ddr_bank_targets[1]);
+}
+
+
+static void run_pointer_chasing(void){
+    cpu_pointer_chasing_microbenchmark(100000, 16, 8*1024*1024);
+}
+
+
+static void run_stress_matrix(void){
+    matrix_stress2_task(MATRIX_SIZE);
+}
+
+
+static void run_ddr_pattern(void){
+    sdram_pattern_run(&ddr_pattern, 0xFF00FF);
+}
+
+
+// Tasks of the event fingerprint sweep
+static void sweep_matrix_stress1(unsigned size){
+    matrix_stress1_task(size);
+    __asm__ __volatile("dsb");
+}
+
+
+static void sweep_matrix_stress2(unsigned size){
+    matrix_stress2_task(size);
+    __asm__ __volatile("dsb");
+}
+
+
+static void sweep_pointer_chasing(unsigned size){
+    cpu_pointer_chasing_microbenchmark(10000, 16, size);
+    __asm__ __volatile("dsb");
+}
+
+
+/* config_measure
+ *
+ * Description: Measures one run of a benchmark of the controller configuration sweep, from its cache state
+ *
+ * Parameter:
+ *              - unsigned benchmark: Index in CONFIG_BENCHMARKS
+ *
+ * Returns:     The execution time (cycles)
+ *
+ * */
+static unsigned long long config_measure(unsigned benchmark){
+    static const struct cache_state_policy* const policies[] = {&STRESS_MATRIX_CACHE_STATE, &STORE_BURST_CACHE_STATE, &LOAD_BURST_CACHE_STATE, &POINTER_CHASING_CACHE_STATE};
+    static void (*const tasks[])(void) = {run_stress_matrix, run_store_burst, run_load_burst, run_pointer_chasing};
+
+    cache_state_prepare(policies[benchmark], tasks[benchmark]);
+    critical_task_start_eval();
+    tasks[benchmark]();
+    __asm__ __volatile("dsb");
+    critical_task_end_eval();
+
+    return valueCf;
+}
+
+
+// Knobs of the controller configuration sweep
+static void apply_arm_sbndc(unsigned value){
+    write_ARM_SBNDC(value);
+}
+
+static void apply_pr_old_count(unsigned value){
+    emif_bus_set_field(&emif_bus_ddr3a, EMIF_FIELD_PR_OLD_COUNT, value);
+}
+
+static void apply_rd_thresh(unsigned value){
+    emif_bus_set_field(&emif_bus_ddr3a, EMIF_FIELD_RD_THRESH, value);
+}
+
+static void apply_wr_thresh(unsigned value){
+    emif_bus_set_field(&emif_bus_ddr3a, EMIF_FIELD_WR_THRESH, value);
 }
 
 
@@ -419,8 +1417,11 @@ static inline void paging_setup(unsigned page_option, unsigned page_level1_descr
     // 4 KB page partitioned
     else if(page_option == 4){
         const unsigned NB_PARTITION_BITS = 2;
-        const unsigned INITIAL_PARTITION_BIT = 14;
         const unsigned SELECTED_PARTITION_BIT_ID = 0;
+        // Upper bank bits below the row (bit 14 with 8 banks and 8 KB rows), so that each partition gets its own banks.
+        // ddr_geometry.layout is only set once SDCFG was decoded
+        int color_bit = (ddr_geometry.layout != NULL) ? sdram_color_bit(&ddr_geometry, NB_PARTITION_BITS) : -1;
+        const unsigned INITIAL_PARTITION_BIT = (color_bit < 0) ? DEFAULT_PARTITION_BIT : (unsigned)color_bit;
 
         page_coloring(page_level1_descriptor_addr, page_level2_descriptor_addr, NB_PARTITION_BITS, INITIAL_PARTITION_BIT, SELECTED_PARTITION_BIT_ID);
 
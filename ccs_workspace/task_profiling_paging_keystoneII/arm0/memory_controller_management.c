@@ -4,7 +4,7 @@
  |  Description: The functions definition for the Keystone II SDRAM
  |               controller management are done here
  |
- |  Version: 1
+ |  Version: 1.4
  *-----------------------------------------------------------------------*/
 
 #include <stdio.h>
@@ -46,6 +46,13 @@
 #define MASTER_ID_PERF_CNT_1   0x8
 
 
+// DDR3A EMIF (fixed address)
+struct emif_bus emif_bus_ddr3a = {1, {{(volatile unsigned char*)EMIF_KEYSTONE2_DDR3A_ADDRESS, &EMIF_REGMAP_KEYSTONE2}}};
+
+// Initial and final snapshots
+static struct emif_snapshot ddr_begin, ddr_end;
+
+
 // Configures the DDR memory controller performance counter
 void DDR_configure_eval(unsigned filter_events){
     /* EMIF1, performance counter 0 */
@@ -65,30 +72,41 @@ void DDR_configure_eval(unsigned filter_events){
 
 }
 
+// Restricts both DDR memory controller performance counters to a chip select, or counts every chip select again
+void DDR_configure_region(unsigned filter_region, unsigned region){
+    unsigned id;
+
+    for(id = 0; id < 2; id++){
+        if(filter_region){
+            set_REGION(id, region);
+            enable_CNT_REGION(id);
+        }
+        else
+            disable_CNT_REGION(id);
+    }
+}
+
 // Reads the DDR performance counters for the first time
 void DDR_start_eval(){
-    t1_ddr_evt0_emif0 = get_PERF_CNT_1();
-    t1_ddr_evt1_emif0 = get_PERF_CNT_2();
-    t1_ddr_cycles_emif0 = get_PERF_CNT_TIMER();
+    emif_bus_snapshot(&emif_bus_ddr3a, &ddr_begin);
 }
 
 // Reads the DDR performance counters for the second time and calculates the
 // time difference
 void DDR_end_eval(){
-    t2_ddr_evt0_emif0 = get_PERF_CNT_1();
-    t2_ddr_evt1_emif0 = get_PERF_CNT_2();
-    t2_ddr_cycles_emif0 = get_PERF_CNT_TIMER();
+    emif_bus_snapshot(&emif_bus_ddr3a, &ddr_end);
 
-    result_ddr_cycles_emif0 = t2_ddr_cycles_emif0 - t1_ddr_cycles_emif0;
-    result_ddr_evt0_emif0 = t2_ddr_evt0_emif0 - t1_ddr_evt0_emif0;
-    result_ddr_evt1_emif0 = t2_ddr_evt1_emif0 - t1_ddr_evt1_emif0;
+    result_ddr_cycles_emif0 = ddr_end.cycles[0] - ddr_begin.cycles[0];
+    result_ddr_evt0_emif0 = ddr_end.evt[0][0] - ddr_begin.evt[0][0];
+    result_ddr_evt1_emif0 = ddr_end.evt[0][1] - ddr_begin.evt[0][1];
 
+    result_ddr_skew = (ddr_begin.skew > ddr_end.skew) ? ddr_begin.skew : ddr_end.skew;
 }
 
 
 // Print the metrics  
 void print_emif_results(unsigned id){
- printf("%u %u %u %u \n", id, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0);
+ printf("%u %u %u %u %u \n", id, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_skew);
 }
 
 
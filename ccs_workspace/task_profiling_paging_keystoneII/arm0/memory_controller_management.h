@@ -4,11 +4,17 @@
  |  Description: The functions declaration for Keystone II SDRAM
  |               controller management are done here
  |
- |  Version: 1
+ |  Version: 1.4
  *-----------------------------------------------------------------------*/
 
-// EMIF0 performance counters initial and final read variables
-unsigned t1_ddr_cycles_emif0,t2_ddr_cycles_emif0, result_ddr_cycles_emif0, t1_ddr_evt0_emif0, t2_ddr_evt0_emif0, result_ddr_evt0_emif0, t1_ddr_evt1_emif0, t2_ddr_evt1_emif0, result_ddr_evt1_emif0;
+#include "emif_driver.h"
+
+// EMIF0 performance counters results
+unsigned result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0;
+// EMIF0 timer cycles between the first and the last read of a snapshot (largest of the two snapshots)
+unsigned result_ddr_skew;
+// DDR3A EMIF, for the event rotation and the master sweep
+extern struct emif_bus emif_bus_ddr3a;
 
 /* DDR_configure_eval
  *
@@ -24,6 +30,21 @@ unsigned t1_ddr_cycles_emif0,t2_ddr_cycles_emif0, result_ddr_cycles_emif0, t1_dd
 void DDR_configure_eval(unsigned filter_events);
 
 
+/* DDR_configure_region
+ *
+ * Description: Restricts both performance counters to the accesses to a chip select (region), on top of the master filter.
+ *              Only the events which support it are filtered (reads and writes, not accesses and activates).
+ *
+ * Parameter:
+ *              - unsigned filter_region: 1 to count the given chip select only, 0 to count every chip select
+ *              - unsigned region: Chip select to count
+ *
+ * Returns:     Nothing
+ *
+ * */
+void DDR_configure_region(unsigned filter_region, unsigned region);
+
+
 /* DDR_start_eval
  *
  * Description: Reads the performance counters for the first time.
@@ -50,7 +71,7 @@ void DDR_end_eval();
 
 /* print_emif_results
  *
- * Description: Prints the results for the chosen DDR SDRAM events
+ * Description: Prints the results for the chosen DDR SDRAM events, followed by the snapshot skew
  *
  * Parameter:
  *		- unsigned id: the identification number for the printed result
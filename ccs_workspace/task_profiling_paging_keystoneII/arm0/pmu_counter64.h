@@ -0,0 +1,111 @@
+/*--------------------------- pmu_counter64.h ----------------------------
+ |  File pmu_counter64.h
+ |
+ |  Description: Software extension of the 32-bit PMU counters to 64 bits.
+ |               Every counter overflow, signalled by the overflow flag
+ |               register (PMOVSR), adds 2^32 to the upper part kept in
+ |               memory. The flags can be polled at the probe points or
+ |               consumed from an overflow interrupt. Nothing here touches
+ |               the hardware, so the logic can be checked against a
+ |               simulated wrapping counter.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_COUNTER64_H_
+#define PMU_COUNTER64_H_
+
+#include "pmu_counter_source.h"
+
+// Overflow flags layout (PMOVSR): bit 31 = cycle counter, bits 0-5 = event counters
+#define PMU_OVF_CYCLE_FLAG  0x80000000
+#define PMU_OVF_EVT_FLAGS   0x0000003F
+
+// Counter values extended to 64 bits
+struct pmu_snapshot64{
+    unsigned long long cycles;
+    unsigned long long evt[PMU_NB_EVT_COUNTERS];
+};
+
+// Upper parts (number of wraps << 32) of each counter
+struct pmu_wrap_tracker{
+    unsigned long long cycles_high;
+    unsigned long long evt_high[PMU_NB_EVT_COUNTERS];
+};
+
+
+/* pmu_wrap_reset
+ *
+ * Description: Clears the upper parts, to be done whenever the hardware counters are reset
+ *
+ * Parameter:
+ *              - struct pmu_wrap_tracker* tracker: Tracker to reset
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_wrap_reset(struct pmu_wrap_tracker* tracker);
+
+
+/* pmu_wrap_account
+ *
+ * Description: Adds one wrap to every counter whose overflow flag is set.
+ *              Intended for the overflow interrupt handler, which then clears the given flags.
+ *
+ * Parameter:
+ *              - struct pmu_wrap_tracker* tracker: Tracker to update
+ *              - unsigned overflow_flags: Overflow flags read from PMOVSR
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_wrap_account(struct pmu_wrap_tracker* tracker, unsigned overflow_flags);
+
+
+/* pmu_wrap_poll
+ *
+ * Description: Polling variant of pmu_wrap_account for counters that may still be running.
+ *              The flags must be read right after the counter values. A flag whose counter value is in the
+ *              upper half of the range was raised after the value was read, so it is left for the next poll.
+ *              Requires less than 2^31 events between two polls.
+ *
+ * Parameter:
+ *              - struct pmu_wrap_tracker* tracker: Tracker to update
+ *              - unsigned overflow_flags: Overflow flags read from PMOVSR after the counters
+ *              - const struct pmu_snapshot* raw: 32-bit counter values
+ *
+ * Returns:     The overflow flags that have been accounted and must be cleared
+ *
+ * */
+unsigned pmu_wrap_poll(struct pmu_wrap_tracker* tracker, unsigned overflow_flags, const struct pmu_snapshot* raw);
+
+
+/* pmu_wrap_extend
+ *
+ * Description: Builds the 64-bit counter values from 32-bit values and the accounted wraps
+ *
+ * Parameter:
+ *              - const struct pmu_wrap_tracker* tracker: Accounted wraps
+ *              - const struct pmu_snapshot* raw: 32-bit counter values
+ *              - struct pmu_snapshot64* extended: Where the 64-bit values are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_wrap_extend(const struct pmu_wrap_tracker* tracker, const struct pmu_snapshot* raw, struct pmu_snapshot64* extended);
+
+
+/* pmu_subtract_overhead64
+ *
+ * Description: 64-bit version of pmu_subtract_overhead. Values are saturated at 0.
+ *
+ * Parameter:
+ *              - struct pmu_snapshot64* snapshot: Measurement to correct
+ *              - const struct pmu_snapshot* overhead: Probe cost given by pmu_calibrate
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_subtract_overhead64(struct pmu_snapshot64* snapshot, const struct pmu_snapshot* overhead);
+
+#endif /* PMU_COUNTER64_H_ */
@@ -0,0 +1,50 @@
+/*--------------------------- pmu_counter_source.c -----------------------
+ |  File pmu_counter_source.c
+ |
+ |  Description: The functions definition for the counter source
+ |               probe-overhead calibration are done here
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include "pmu_counter_source.h"
+
+
+// Measures empty start/stop pairs and keeps the minimum of each counter
+void pmu_calibrate(const struct pmu_counter_source* source, unsigned nb_runs, struct pmu_snapshot* overhead){
+    struct pmu_snapshot sample;
+    unsigned i, j;
+
+    overhead->cycles = 0xFFFFFFFF;
+    for(j = 0; j < PMU_NB_EVT_COUNTERS; j++)
+        overhead->evt[j] = 0xFFFFFFFF;
+
+    for(i = 0; i < nb_runs; i++){
+        source->start();
+        source->stop(&sample);
+
+        if(sample.cycles < overhead->cycles)
+            overhead->cycles = sample.cycles;
+
+        for(j = 0; j < PMU_NB_EVT_COUNTERS; j++)
+            if(sample.evt[j] < overhead->evt[j])
+                overhead->evt[j] = sample.evt[j];
+    }
+
+    // No run means no known overhead
+    if(nb_runs == 0){
+        overhead->cycles = 0;
+        for(j = 0; j < PMU_NB_EVT_COUNTERS; j++)
+            overhead->evt[j] = 0;
+    }
+}
+
+// Removes the probe cost from a measurement
+void pmu_subtract_overhead(struct pmu_snapshot* snapshot, const struct pmu_snapshot* overhead){
+    unsigned j;
+
+    snapshot->cycles = (snapshot->cycles > overhead->cycles) ? snapshot->cycles - overhead->cycles : 0;
+
+    for(j = 0; j < PMU_NB_EVT_COUNTERS; j++)
+        snapshot->evt[j] = (snapshot->evt[j] > overhead->evt[j]) ? snapshot->evt[j] - overhead->evt[j] : 0;
+}
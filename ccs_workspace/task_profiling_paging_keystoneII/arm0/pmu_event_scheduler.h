@@ -0,0 +1,131 @@
+/*--------------------------- pmu_event_scheduler.h ----------------------
+ |  File pmu_event_scheduler.h
+ |
+ |  Description: Event-group multiplexing on top of a counter source.
+ |               An arbitrary list of events is split into groups of
+ |               PMU_NB_EVT_COUNTERS events, and one group is counted per
+ |               measured run (round robin). Per-event totals are kept
+ |               together with the cycles during which the event was
+ |               actually counted, from which the coverage and the scaled
+ |               (estimated full-run) totals are derived.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_EVENT_SCHEDULER_H_
+#define PMU_EVENT_SCHEDULER_H_
+
+#include "pmu_counter_source.h"
+
+// Maximum number of events handled by a scheduler (the A15 event space is 0x00-0x7F)
+#define PMU_SCHED_MAX_EVENTS 128
+
+struct pmu_event_scheduler{
+    const struct pmu_counter_source* source;
+
+    // Events to count
+    unsigned nb_events;
+    unsigned event_ids[PMU_SCHED_MAX_EVENTS];
+
+    // Per-event raw totals, cycles while counted and number of runs counted
+    unsigned long long count[PMU_SCHED_MAX_EVENTS];
+    unsigned long long counted_cycles[PMU_SCHED_MAX_EVENTS];
+    unsigned runs[PMU_SCHED_MAX_EVENTS];
+
+    // Cycles and runs over all the measured runs
+    unsigned long long total_cycles;
+    unsigned total_runs;
+
+    // Group rotation
+    unsigned nb_groups;
+    unsigned current_group;
+};
+
+
+/* pmu_sched_init
+ *
+ * Description: Prepares a scheduler for the given events and clears its totals
+ *
+ * Parameter:
+ *              - struct pmu_event_scheduler* sched: Scheduler to initialize
+ *              - const struct pmu_counter_source* source: Counter source used for the measurements
+ *              - const unsigned* event_ids: Events to count
+ *              - unsigned nb_events: Number of events (at most PMU_SCHED_MAX_EVENTS)
+ *
+ * Returns:     0 on success, -1 if there are too many events
+ *
+ * */
+int pmu_sched_init(struct pmu_event_scheduler* sched, const struct pmu_counter_source* source, const unsigned* event_ids, unsigned nb_events);
+
+
+/* pmu_sched_start
+ *
+ * Description: Programs the current group of events and starts counting.
+ *              The programming is done before the counters are started, so it is not measured.
+ *
+ * Parameter:
+ *              - struct pmu_event_scheduler* sched: Scheduler to use
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sched_start(struct pmu_event_scheduler* sched);
+
+
+/* pmu_sched_stop
+ *
+ * Description: Stops counting, accumulates the values of the current group and rotates to the next group
+ *
+ * Parameter:
+ *              - struct pmu_event_scheduler* sched: Scheduler to use
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sched_stop(struct pmu_event_scheduler* sched);
+
+
+/* pmu_sched_account
+ *
+ * Description: Accumulates an already taken snapshot of the current group and rotates to the next group.
+ *              pmu_sched_stop relies on it; it is exposed so that the accounting can be driven without a source.
+ *
+ * Parameter:
+ *              - struct pmu_event_scheduler* sched: Scheduler to use
+ *              - const struct pmu_snapshot* snapshot: Values read for the current group
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sched_account(struct pmu_event_scheduler* sched, const struct pmu_snapshot* snapshot);
+
+
+/* pmu_sched_coverage_permille
+ *
+ * Description: Fraction of the measured cycles during which an event was counted
+ *
+ * Parameter:
+ *              - const struct pmu_event_scheduler* sched: Scheduler to use
+ *              - unsigned index: Position of the event in the list given to pmu_sched_init
+ *
+ * Returns:     The coverage in per mille (1000 = counted during every run)
+ *
+ * */
+unsigned pmu_sched_coverage_permille(const struct pmu_event_scheduler* sched, unsigned index);
+
+
+/* pmu_sched_scaled_count
+ *
+ * Description: Estimates the total of an event over all the measured runs by scaling its raw total
+ *              with the ratio between all the measured cycles and the cycles during which it was counted
+ *
+ * Parameter:
+ *              - const struct pmu_event_scheduler* sched: Scheduler to use
+ *              - unsigned index: Position of the event in the list given to pmu_sched_init
+ *
+ * Returns:     The scaled total (0 if the event was never counted)
+ *
+ * */
+unsigned long long pmu_sched_scaled_count(const struct pmu_event_scheduler* sched, unsigned index);
+
+#endif /* PMU_EVENT_SCHEDULER_H_ */
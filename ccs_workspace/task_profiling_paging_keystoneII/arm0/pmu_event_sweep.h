@@ -0,0 +1,62 @@
+/*--------------------------- pmu_event_sweep.h --------------------------
+ |  File pmu_event_sweep.h
+ |
+ |  Description: Event fingerprint sweep. Every registered task is run
+ |               once per group of PMU_NB_EVT_COUNTERS events over the
+ |               whole ARM Cortex A15 event space (0x00-0x7F) and for
+ |               several problem sizes. The events that are non-zero are
+ |               reported with their count per size and the exponent of
+ |               their growth with the size (1.00 = linear, 2.00 =
+ |               quadratic...), the ones always at zero are listed as dead.
+ |               This tells which counters are worth programming in
+ |               counters_init() for a given task.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_EVENT_SWEEP_H_
+#define PMU_EVENT_SWEEP_H_
+
+#include "pmu_counter_source.h"
+
+// Size of the swept event space
+#define PMU_SWEEP_NB_EVENTS 128
+
+// Maximum number of problem sizes of a task
+#define PMU_SWEEP_MAX_SIZES 4
+
+// A task of the sweep
+struct pmu_sweep_task{
+    const char* name;
+
+    // Runs the task once for a problem size
+    void (*run)(unsigned size);
+
+    // Problem sizes, increasing (at most PMU_SWEEP_MAX_SIZES)
+    const unsigned* sizes;
+    unsigned nb_sizes;
+};
+
+
+/* pmu_sweep_run
+ *
+ * Description: Sweeps the event space for every task and writes its fingerprint table:
+ *              "T <task> <size 0> ... <size n>",
+ *              "C <task> <cycles per run at size 0> ... <at size n>",
+ *              "F <task> <event> <count at size 0> ... <at size n> <growth exponent>" for every non-zero event,
+ *              "Z <task> <number of events at zero>",
+ *              and at the end "D <event> ..." with the events at zero for every task.
+ *              The counter source is left programmed with the last event group: its events must be set again afterwards.
+ *
+ * Parameter:
+ *              - const struct pmu_counter_source* source: Counter source used for the measurements
+ *              - const struct pmu_sweep_task* tasks: Tasks to fingerprint
+ *              - unsigned nb_tasks: Number of tasks
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sweep_run(const struct pmu_counter_source* source, const struct pmu_sweep_task* tasks, unsigned nb_tasks, void (*write_line)(char* line));
+
+#endif /* PMU_EVENT_SWEEP_H_ */
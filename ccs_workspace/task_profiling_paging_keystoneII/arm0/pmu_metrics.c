@@ -0,0 +1,152 @@
+/*--------------------------- pmu_metrics.c ------------------------------
+ |  File pmu_metrics.c
+ |
+ |  Description: The functions definition for the derived metrics are
+ |               done here
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "pmu_metrics.h"
+
+
+// Events used by the metrics
+#define EVT_L1D_REFILL       0x03
+#define EVT_L1D_ACCESS       0x04
+#define EVT_INSTRUCTIONS     0x08
+#define EVT_BRANCH_MISS      0x10
+#define EVT_L2D_ACCESS       0x16
+#define EVT_L2D_REFILL       0x17
+#define EVT_BUS_ACCESS       0x19
+#define EVT_INST_SPEC        0x1B
+
+static const char* const metric_names[PMU_NB_METRICS] = {"ipc", "l1d_refill_ratio", "l2_refill_ratio", "l2_mpki",
+                                                          "bus_per_kcycle", "branch_mpki", "emif_act_ratio", "emif_utilization",
+                                                          "acor", "row_hit_ratio", "row_switches"};
+
+
+// Looks for an event among the counters. Returns 1 and its value if it was counted, 0 otherwise
+static int find_event(const struct pmu_metrics_input* input, unsigned event_id, unsigned long long* value){
+    unsigned i;
+
+    if(input->event_ids == NULL)
+        return 0;
+
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        if(input->event_ids[i] == event_id){
+            *value = input->evt[i];
+            return 1;
+        }
+
+    return 0;
+}
+
+
+// Sets numerator * scale / denominator as a metric, if both values are known and the denominator is not 0
+static unsigned ratio(unsigned long long* metrics, unsigned metric, int known, unsigned long long numerator, unsigned long long denominator, unsigned long long scale){
+    if(!known || denominator == 0)
+        return 0;
+
+    // Scaled in two steps to limit the risk of a 64-bit overflow
+    metrics[metric] = (numerator / denominator) * scale + ((numerator % denominator) * scale) / denominator;
+    return 1u << metric;
+}
+
+
+unsigned pmu_metrics_compute(const struct pmu_metrics_input* input, unsigned long long* metrics){
+    unsigned long long l1d_refill = 0, l1d_access = 0, instructions = 0, branch_miss = 0, l2d_access = 0, l2d_refill = 0, bus_access = 0;
+    unsigned long long row_hits;
+    int has_l1d_refill, has_l1d_access, has_instructions, has_branch_miss, has_l2d_access, has_l2d_refill, has_bus_access;
+    unsigned valid = 0;
+    unsigned i;
+
+    for(i = 0; i < PMU_NB_METRICS; i++)
+        metrics[i] = 0;
+
+    has_l1d_refill = find_event(input, EVT_L1D_REFILL, &l1d_refill);
+    has_l1d_access = find_event(input, EVT_L1D_ACCESS, &l1d_access);
+    has_branch_miss = find_event(input, EVT_BRANCH_MISS, &branch_miss);
+    has_l2d_access = find_event(input, EVT_L2D_ACCESS, &l2d_access);
+    has_l2d_refill = find_event(input, EVT_L2D_REFILL, &l2d_refill);
+    has_bus_access = find_event(input, EVT_BUS_ACCESS, &bus_access);
+
+    // Architecturally executed instructions, or the speculatively executed ones as a proxy
+    has_instructions = find_event(input, EVT_INSTRUCTIONS, &instructions) || find_event(input, EVT_INST_SPEC, &instructions);
+
+    valid |= ratio(metrics, PMU_METRIC_IPC, has_instructions, instructions, input->cycles, PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_L1D_REFILL_RATIO, has_l1d_refill && has_l1d_access, l1d_refill, l1d_access, PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_L2_REFILL_RATIO, has_l2d_refill && has_l2d_access, l2d_refill, l2d_access, PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_L2_MPKI, has_l2d_refill && has_instructions, l2d_refill, instructions, 1000ULL * PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_BUS_PER_KCYCLE, has_bus_access, bus_access, input->cycles, 1000ULL * PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_BRANCH_MPKI, has_branch_miss && has_instructions, branch_miss, instructions, 1000ULL * PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_EMIF_ACT_RATIO, 1, input->emif_activates, input->emif_accesses, PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_EMIF_UTILIZATION, 1, input->emif_accesses, input->emif_cycles, PMU_METRIC_SCALE);
+
+    // Row-buffer locality. Refreshes close the rows too, so a few more activates than accesses are possible on idle runs
+    row_hits = (input->emif_accesses > input->emif_activates) ? input->emif_accesses - input->emif_activates : 0;
+    valid |= ratio(metrics, PMU_METRIC_ACOR, 1, input->emif_accesses, input->emif_activates, PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_ROW_HIT_RATIO, 1, row_hits, input->emif_accesses, PMU_METRIC_SCALE);
+    valid |= ratio(metrics, PMU_METRIC_ROW_SWITCHES, input->emif_cycles != 0, input->emif_activates, 1, PMU_METRIC_SCALE);
+
+    return valid;
+}
+
+
+void pmu_metrics_stats_reset(struct pmu_metrics_stats* stats, const char* name){
+    unsigned i;
+
+    stats->name = name;
+
+    for(i = 0; i < PMU_NB_METRICS; i++){
+        stats->nb_runs[i] = 0;
+        stats->min[i] = 0;
+        stats->max[i] = 0;
+        stats->sum[i] = 0;
+    }
+}
+
+
+void pmu_metrics_stats_add(struct pmu_metrics_stats* stats, const struct pmu_metrics_input* input){
+    unsigned long long metrics[PMU_NB_METRICS];
+    unsigned valid = pmu_metrics_compute(input, metrics);
+    unsigned i;
+
+    for(i = 0; i < PMU_NB_METRICS; i++){
+        if(!(valid & (1u << i)))
+            continue;
+
+        if(stats->nb_runs[i] == 0 || metrics[i] < stats->min[i])
+            stats->min[i] = metrics[i];
+        if(stats->nb_runs[i] == 0 || metrics[i] > stats->max[i])
+            stats->max[i] = metrics[i];
+
+        stats->sum[i] += metrics[i];
+        stats->nb_runs[i]++;
+    }
+}
+
+
+void pmu_metrics_stats_print(const struct pmu_metrics_stats* stats, void (*write_line)(char* line)){
+    pmu_metrics_stats_print_mask(stats, ~0u, write_line);
+}
+
+
+void pmu_metrics_stats_print_mask(const struct pmu_metrics_stats* stats, unsigned mask, void (*write_line)(char* line)){
+    unsigned long long mean;
+    char line[160];
+    unsigned i;
+
+    for(i = 0; i < PMU_NB_METRICS; i++){
+        if(stats->nb_runs[i] == 0 || !(mask & (1u << i)))
+            continue;
+
+        mean = stats->sum[i] / stats->nb_runs[i];
+
+        snprintf(line, sizeof(line), "%s %s %u %llu.%03llu %llu.%03llu %llu.%03llu \n\r", stats->name, metric_names[i], stats->nb_runs[i],
+                 stats->min[i] / PMU_METRIC_SCALE, stats->min[i] % PMU_METRIC_SCALE,
+                 mean / PMU_METRIC_SCALE, mean % PMU_METRIC_SCALE,
+                 stats->max[i] / PMU_METRIC_SCALE, stats->max[i] % PMU_METRIC_SCALE);
+        write_line(line);
+    }
+}
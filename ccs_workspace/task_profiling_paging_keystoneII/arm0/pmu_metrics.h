@@ -0,0 +1,155 @@
+/*--------------------------- pmu_metrics.h ------------------------------
+ |  File pmu_metrics.h
+ |
+ |  Description: Derived metrics computed on target from the raw PMU and
+ |               EMIF counters, with integer fixed-point arithmetic (all
+ |               metrics are given in thousandths), and their running
+ |               min/max/mean per benchmark. A run can then report a
+ |               compact summary instead of one raw line per iteration.
+ |               The row-buffer locality metrics (ACOR, row hit ratio,
+ |               row switches) are the per-task inputs of the interference
+ |               cost model, so that they come from the board instead of
+ |               an offline estimation.
+ |               Nothing here touches the hardware.
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_METRICS_H_
+#define PMU_METRICS_H_
+
+#include "pmu_counter_source.h"
+
+// Fixed-point scale of every metric (a metric value of 1500 means 1.5)
+#define PMU_METRIC_SCALE 1000
+
+/**
+ * Derived metrics.
+ *
+ * IPC                  Instructions per cycle (event 0x08, or 0x1B speculatively executed)
+ * L1D refill ratio     L1 data refills (0x03) per L1 data access (0x04)
+ * L2 refill ratio      L2 data refills (0x17) per L2 data access (0x16)
+ * L2 MPKI              L2 data refills (0x17) per thousand instructions
+ * Bus per kcycle       Bus accesses (0x19) per thousand cycles
+ * Branch MPKI          Mispredicted branches (0x10) per thousand instructions
+ * EMIF act/access      SDRAM activates per SDRAM access (inverse of the ACOR)
+ * EMIF utilization     SDRAM accesses per EMIF timer cycle (PERF_CNT_TIM)
+ * ACOR                 SDRAM accesses per activate (accesses served by an opened row)
+ * Row hit ratio        SDRAM accesses which did not open a row, per SDRAM access
+ * Row switches         SDRAM activates of the run (a row opened in a bank)
+ *
+ * The EMIF metrics need PERF_CNT_1 counting the accesses and PERF_CNT_2 the activates.
+ * */
+#define PMU_METRIC_IPC               0
+#define PMU_METRIC_L1D_REFILL_RATIO  1
+#define PMU_METRIC_L2_REFILL_RATIO   2
+#define PMU_METRIC_L2_MPKI           3
+#define PMU_METRIC_BUS_PER_KCYCLE    4
+#define PMU_METRIC_BRANCH_MPKI       5
+#define PMU_METRIC_EMIF_ACT_RATIO    6
+#define PMU_METRIC_EMIF_UTILIZATION  7
+#define PMU_METRIC_ACOR              8
+#define PMU_METRIC_ROW_HIT_RATIO     9
+#define PMU_METRIC_ROW_SWITCHES      10
+#define PMU_NB_METRICS               11
+
+// Row-buffer locality metrics (the cost model inputs), for pmu_metrics_stats_print_mask
+#define PMU_METRICS_ROW_LOCALITY ((1u << PMU_METRIC_ACOR) | (1u << PMU_METRIC_ROW_HIT_RATIO) | (1u << PMU_METRIC_ROW_SWITCHES))
+
+// Raw values of a run. Values not measured during the run are left to 0
+struct pmu_metrics_input{
+    unsigned long long cycles;
+
+    // Events of counters 0 to 5 and their values
+    const unsigned* event_ids;
+    unsigned long long evt[PMU_NB_EVT_COUNTERS];
+
+    // EMIF counters (summed over the EMIFs), timer cycles (0 when the EMIFs were not measured)
+    unsigned long long emif_accesses;
+    unsigned long long emif_activates;
+    unsigned long long emif_cycles;
+};
+
+// Running statistics of the metrics of a benchmark
+struct pmu_metrics_stats{
+    const char* name;
+    unsigned nb_runs[PMU_NB_METRICS];
+    unsigned long long min[PMU_NB_METRICS];
+    unsigned long long max[PMU_NB_METRICS];
+    unsigned long long sum[PMU_NB_METRICS];
+};
+
+
+/* pmu_metrics_compute
+ *
+ * Description: Computes the derived metrics of a run. A metric is valid only when the events it needs were
+ *              counted and its denominator is not 0.
+ *
+ * Parameter:
+ *              - const struct pmu_metrics_input* input: Raw values of the run
+ *              - unsigned long long* metrics: PMU_NB_METRICS elements where the metrics are written (x PMU_METRIC_SCALE)
+ *
+ * Returns:     The valid metrics mask (bit n = metric n)
+ *
+ * */
+unsigned pmu_metrics_compute(const struct pmu_metrics_input* input, unsigned long long* metrics);
+
+
+/* pmu_metrics_stats_reset
+ *
+ * Description: Clears the statistics of a benchmark
+ *
+ * Parameter:
+ *              - struct pmu_metrics_stats* stats: Statistics to clear
+ *              - const char* name: Benchmark name used in the summary
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_metrics_stats_reset(struct pmu_metrics_stats* stats, const char* name);
+
+
+/* pmu_metrics_stats_add
+ *
+ * Description: Computes the metrics of a run and adds the valid ones to the statistics
+ *
+ * Parameter:
+ *              - struct pmu_metrics_stats* stats: Statistics to update
+ *              - const struct pmu_metrics_input* input: Raw values of the run
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_metrics_stats_add(struct pmu_metrics_stats* stats, const struct pmu_metrics_input* input);
+
+
+/* pmu_metrics_stats_print
+ *
+ * Description: Writes one line per metric with at least one run: "<benchmark> <metric> <runs> <min> <mean> <max>",
+ *              values with three decimals
+ *
+ * Parameter:
+ *              - const struct pmu_metrics_stats* stats: Statistics to print
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_metrics_stats_print(const struct pmu_metrics_stats* stats, void (*write_line)(char* line));
+
+
+/* pmu_metrics_stats_print_mask
+ *
+ * Description: Same as pmu_metrics_stats_print, restricted to a set of metrics
+ *
+ * Parameter:
+ *              - const struct pmu_metrics_stats* stats: Statistics to print
+ *              - unsigned mask: Metrics to print (bit n = metric n, e.g., PMU_METRICS_ROW_LOCALITY)
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_metrics_stats_print_mask(const struct pmu_metrics_stats* stats, unsigned mask, void (*write_line)(char* line));
+
+#endif /* PMU_METRICS_H_ */
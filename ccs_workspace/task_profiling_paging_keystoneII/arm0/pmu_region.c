@@ -0,0 +1,173 @@
+/*--------------------------- pmu_region.c -------------------------------
+ |  File pmu_region.c
+ |
+ |  Description: The functions definition for the nested region markers
+ |               are done here
+ |
+ |  Version: 1.2
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "pmu_region.h"
+
+
+// Ring buffer
+static struct pmu_region_record* ring = NULL;
+static unsigned ring_capacity = 0;
+static unsigned ring_head = 0;
+static unsigned ring_count = 0;
+
+// Records overwritten because the ring was full, and markers that did not match the current region
+static unsigned nb_overwritten = 0;
+static unsigned nb_unbalanced = 0;
+
+static pmu_region_reader read_counters = NULL;
+
+// Cycle counter value at the beginning of the outermost open region
+static unsigned origin_cycles = 0;
+
+// Open regions: identifiers and counters at their beginning. Depth may exceed PMU_REGION_MAX_DEPTH
+static unsigned depth = 0;
+static unsigned stack_id[PMU_REGION_MAX_DEPTH];
+static struct pmu_region_counters stack_begin[PMU_REGION_MAX_DEPTH];
+
+
+void region_init(struct pmu_region_record* storage, unsigned capacity, pmu_region_reader read){
+    ring = storage;
+    ring_capacity = capacity;
+    ring_head = 0;
+    ring_count = 0;
+    nb_overwritten = 0;
+    nb_unbalanced = 0;
+    depth = 0;
+    read_counters = read;
+}
+
+
+void region_begin(unsigned id){
+    // Markers do nothing until region_init is called
+    if(read_counters == NULL)
+        return;
+
+    if(depth < PMU_REGION_MAX_DEPTH){
+        stack_id[depth] = id;
+
+        // Read last, so that the marker itself is not counted in the region
+        read_counters(&stack_begin[depth]);
+
+        if(depth == 0)
+            origin_cycles = stack_begin[0].pmu.cycles;
+    }
+
+    depth++;
+}
+
+
+void region_end(unsigned id){
+    struct pmu_region_counters now;
+    struct pmu_region_counters* begin;
+    struct pmu_region_record* record;
+    unsigned i;
+
+    if(read_counters == NULL)
+        return;
+
+    // Read first, so that the marker itself is not counted in the region
+    read_counters(&now);
+
+    if(depth == 0){
+        nb_unbalanced++;
+        return;
+    }
+
+    // Too deep to be recorded
+    if(depth > PMU_REGION_MAX_DEPTH){
+        depth--;
+        return;
+    }
+
+    // Unwind to the innermost open region with this id, dropping the regions left open inside it (a missed region_end),
+    // so that the stack resynchronizes. An id that is not open at all (a missed region_begin) is ignored
+    if(stack_id[depth - 1] != id){
+        for(i = depth - 1; i > 0 && stack_id[i - 1] != id; i--);
+        if(i == 0){
+            nb_unbalanced++;
+            return;
+        }
+
+        nb_unbalanced += depth - i;
+        depth = i;
+    }
+
+    depth--;
+    begin = &stack_begin[depth];
+
+    if(ring_capacity == 0)
+        return;
+
+    record = &ring[ring_head];
+    ring_head = (ring_head + 1) % ring_capacity;
+    if(ring_count < ring_capacity)
+        ring_count++;
+    else
+        nb_overwritten++;
+
+    record->id = (unsigned short)id;
+    record->depth = (unsigned short)depth;
+    record->timestamp = begin->pmu.cycles - origin_cycles;
+
+    record->delta.pmu.cycles = now.pmu.cycles - begin->pmu.cycles;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        record->delta.pmu.evt[i] = now.pmu.evt[i] - begin->pmu.evt[i];
+    for(i = 0; i < PMU_REGION_NB_EMIF_COUNTERS; i++)
+        record->delta.emif[i] = now.emif[i] - begin->emif[i];
+}
+
+
+void region_dump(void){
+    const struct pmu_region_record* r;
+    unsigned i;
+
+    for(i = 0; i < ring_count; i++){
+        r = &ring[(ring_head + ring_capacity - ring_count + i) % ring_capacity];
+
+        printf("R %u %u %u %u %u %u %u %u %u %u %u %u %u %u %u %u \n\r", r->id, r->depth, r->timestamp,
+               r->delta.pmu.cycles, r->delta.pmu.evt[0], r->delta.pmu.evt[1], r->delta.pmu.evt[2], r->delta.pmu.evt[3], r->delta.pmu.evt[4], r->delta.pmu.evt[5],
+               r->delta.emif[0], r->delta.emif[1], r->delta.emif[2], r->delta.emif[3], r->delta.emif[4], r->delta.emif[5]);
+    }
+
+    printf("O %u %u \n\r", nb_overwritten, nb_unbalanced);
+
+    ring_head = 0;
+    ring_count = 0;
+    nb_overwritten = 0;
+    nb_unbalanced = 0;
+}
+
+
+unsigned region_stats_add(unsigned id, const unsigned* event_ids, struct pmu_metrics_stats* stats){
+    struct pmu_metrics_input input;
+    const struct pmu_region_record* r;
+    unsigned i, j, nb_added = 0;
+
+    for(i = 0; i < ring_count; i++){
+        r = &ring[(ring_head + ring_capacity - ring_count + i) % ring_capacity];
+        if(r->id != id)
+            continue;
+
+        input.cycles = r->delta.pmu.cycles;
+        input.event_ids = event_ids;
+        for(j = 0; j < PMU_NB_EVT_COUNTERS; j++)
+            input.evt[j] = r->delta.pmu.evt[j];
+
+        // Interleaved EMIFs: counters 1 and 2 are summed, the timer is the one of EMIF 0
+        input.emif_accesses = (unsigned long long)r->delta.emif[0] + r->delta.emif[3];
+        input.emif_activates = (unsigned long long)r->delta.emif[1] + r->delta.emif[4];
+        input.emif_cycles = r->delta.emif[2];
+
+        pmu_metrics_stats_add(stats, &input);
+        nb_added++;
+    }
+
+    return nb_added;
+}
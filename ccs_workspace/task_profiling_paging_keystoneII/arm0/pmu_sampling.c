@@ -0,0 +1,78 @@
+/*--------------------------- pmu_sampling.c -----------------------------
+ |  File pmu_sampling.c
+ |
+ |  Description: The functions definition for the statistical sampling
+ |               buffer are done here
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "pmu_sampling.h"
+
+
+void pmu_sample_buffer_init(struct pmu_sample_buffer* buffer, struct pmu_sample* storage, unsigned capacity, unsigned sampled_counter, unsigned period){
+    unsigned i;
+
+    buffer->samples = storage;
+    buffer->capacity = capacity;
+    buffer->nb_samples = 0;
+    buffer->nb_lost = 0;
+    buffer->sampled_counter = sampled_counter;
+    buffer->period = period;
+
+    buffer->last.cycles = 0;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        buffer->last.evt[i] = 0;
+}
+
+
+void pmu_sample_set_origin(struct pmu_sample_buffer* buffer, const struct pmu_snapshot* raw){
+    buffer->last = *raw;
+}
+
+
+void pmu_sample_record(struct pmu_sample_buffer* buffer, unsigned long pc, const struct pmu_snapshot* raw){
+    struct pmu_sample* sample;
+    unsigned i;
+
+    if(buffer->nb_samples >= buffer->capacity){
+        buffer->nb_lost++;
+        buffer->last = *raw;
+        return;
+    }
+
+    sample = &buffer->samples[buffer->nb_samples];
+    sample->pc = pc;
+    sample->delta.cycles = raw->cycles - buffer->last.cycles;
+
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        sample->delta.evt[i] = (i == buffer->sampled_counter) ? buffer->period : raw->evt[i] - buffer->last.evt[i];
+
+    buffer->last = *raw;
+    buffer->nb_samples++;
+}
+
+
+void pmu_sample_lost(struct pmu_sample_buffer* buffer, unsigned nb_lost){
+    buffer->nb_lost += nb_lost;
+}
+
+
+void pmu_sample_print(struct pmu_sample_buffer* buffer){
+    const struct pmu_sample* s;
+    unsigned i;
+
+    // Lets the host tool relocate the PCs (position independent executables)
+    printf("M pmu_sample_print %lX \n\r", (unsigned long)&pmu_sample_print);
+
+    for(i = 0; i < buffer->nb_samples; i++){
+        s = &buffer->samples[i];
+        printf("S %lX %u %u %u %u %u %u %u \n\r", s->pc, s->delta.cycles, s->delta.evt[0], s->delta.evt[1], s->delta.evt[2], s->delta.evt[3], s->delta.evt[4], s->delta.evt[5]);
+    }
+
+    printf("L %u \n\r", buffer->nb_lost);
+
+    buffer->nb_samples = 0;
+    buffer->nb_lost = 0;
+}
@@ -0,0 +1,123 @@
+/*--------------------------- pmu_sampling.h -----------------------------
+ |  File pmu_sampling.h
+ |
+ |  Description: Statistical sampling buffer. One counter (the sampled
+ |               counter) raises an overflow every "period" events; each
+ |               overflow records the interrupted PC together with the
+ |               increments of all the other counters since the previous
+ |               sample. The buffer is preallocated by the caller and
+ |               recording neither allocates nor blocks, so it can be done
+ |               from an interrupt handler. Samples are printed as text
+ |               lines folded on the host by pmu_fold_samples:
+ |                 M <symbol> <address>   reference symbol address
+ |                 S <pc> <cycles> <evt0> ... <evt5>
+ |                 L <number of samples lost>
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_SAMPLING_H_
+#define PMU_SAMPLING_H_
+
+#include "pmu_counter_source.h"
+
+// A sample: interrupted PC and counters increments since the previous sample
+struct pmu_sample{
+    unsigned long pc;
+    struct pmu_snapshot delta;
+};
+
+struct pmu_sample_buffer{
+    // Preallocated storage
+    struct pmu_sample* samples;
+    unsigned capacity;
+
+    // Recorded samples and samples dropped because the buffer was full
+    volatile unsigned nb_samples;
+    volatile unsigned nb_lost;
+
+    // Counter raising the overflows and number of its events between two samples
+    unsigned sampled_counter;
+    unsigned period;
+
+    // Counters values at the previous sample
+    struct pmu_snapshot last;
+};
+
+
+/* pmu_sample_buffer_init
+ *
+ * Description: Prepares an empty sample buffer on a caller-provided storage
+ *
+ * Parameter:
+ *              - struct pmu_sample_buffer* buffer: Buffer to initialize
+ *              - struct pmu_sample* storage: Preallocated samples
+ *              - unsigned capacity: Number of samples of the storage
+ *              - unsigned sampled_counter: Event counter (0-5) raising the overflows
+ *              - unsigned period: Number of events of the sampled counter between two samples
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sample_buffer_init(struct pmu_sample_buffer* buffer, struct pmu_sample* storage, unsigned capacity, unsigned sampled_counter, unsigned period);
+
+
+/* pmu_sample_set_origin
+ *
+ * Description: Sets the counters values the first sample increments are computed from
+ *
+ * Parameter:
+ *              - struct pmu_sample_buffer* buffer: Buffer to use
+ *              - const struct pmu_snapshot* raw: Counters values when the sampling starts
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sample_set_origin(struct pmu_sample_buffer* buffer, const struct pmu_snapshot* raw);
+
+
+/* pmu_sample_record
+ *
+ * Description: Records a sample. The sampled counter is reloaded at every overflow, so its increment
+ *              is the period; the increments of the other counters are computed modulo 2^32.
+ *              The sample is counted as lost when the buffer is full.
+ *
+ * Parameter:
+ *              - struct pmu_sample_buffer* buffer: Buffer to use
+ *              - unsigned long pc: Interrupted program counter
+ *              - const struct pmu_snapshot* raw: Counters values read at the overflow
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sample_record(struct pmu_sample_buffer* buffer, unsigned long pc, const struct pmu_snapshot* raw);
+
+
+/* pmu_sample_lost
+ *
+ * Description: Accounts samples lost before reaching the buffer (e.g., dropped by the kernel)
+ *
+ * Parameter:
+ *              - struct pmu_sample_buffer* buffer: Buffer to use
+ *              - unsigned nb_lost: Number of samples lost
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sample_lost(struct pmu_sample_buffer* buffer, unsigned nb_lost);
+
+
+/* pmu_sample_print
+ *
+ * Description: Prints the reference symbol, the recorded samples and the number of lost samples,
+ *              then empties the buffer
+ *
+ * Parameter:
+ *              - struct pmu_sample_buffer* buffer: Buffer to print
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_sample_print(struct pmu_sample_buffer* buffer);
+
+#endif /* PMU_SAMPLING_H_ */
@@ -0,0 +1,269 @@
+/*--------------------------- sdram_geometry.h ---------------------------
+ |  File sdram_geometry.h
+ |
+ |  Description: SDRAM geometry decoder. The SDRAM configuration register
+ |               (SDCFG) of an EMIF is decoded at boot into the number of
+ |               chip selects, banks, rows and columns and the data bus
+ |               width, from which the physical address <-> (chip, bank,
+ |               row, column) mapping is built, so that the benchmark
+ |               targets and the page coloring bits follow the current
+ |               controller configuration instead of hand-computed
+ |               constants.
+ |
+ |               Address bits, from the LSB (IBANK_POS = 0):
+ |               bus bytes | column | bank | row | chip select
+ |               IBANK_POS = 1, 2 and 3 move the upper 1, 2 and 3 bank
+ |               bits between the row and the chip select.
+ |
+ |               The functions are inline since the header is shared by
+ |               the victim and the aggressor images, which must agree on
+ |               the partition bits.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef SDRAM_GEOMETRY_H_
+#define SDRAM_GEOMETRY_H_
+
+#include <stdio.h>
+
+// A SDCFG field (width 0: not present on the controller)
+struct sdram_field{
+    unsigned shift;
+    unsigned width;
+};
+
+// SDCFG fields of a controller
+struct sdram_sdcfg_layout{
+    const char* name;
+    struct sdram_field ibank_pos;
+    struct sdram_field narrow_mode;
+    struct sdram_field rowsize;
+    struct sdram_field ibank;
+    struct sdram_field ebank;
+    struct sdram_field pagesize;
+
+    // Row bits for ROWSIZE = 0 (or of every configuration when there is no ROWSIZE field)
+    unsigned row_bits;
+    // log2 of the data bus width in bytes for NARROW_MODE = 0
+    unsigned bus_bits;
+};
+
+// Keystone II DDR3 controller (spruhn7c Section 4.4): 64-bit bus, no ROWSIZE field, the row takes the bits above the banks
+static const struct sdram_sdcfg_layout SDRAM_SDCFG_KEYSTONE2 = {"keystone2_ddr3",
+    {27, 2}, {12, 2}, {0, 0}, {5, 2}, {3, 1}, {0, 2}, 16, 3};
+// Sitara AM5728 EMIF (spruhz6l Section 15.3.6.4.2): 32-bit bus
+static const struct sdram_sdcfg_layout SDRAM_SDCFG_AM5728 = {"am5728_emif",
+    {27, 2}, {14, 2}, {7, 3}, {4, 3}, {3, 1}, {0, 3}, 9, 2};
+
+// Geometry of an EMIF
+struct sdram_geometry{
+    const struct sdram_sdcfg_layout* layout;
+    unsigned sdcfg;
+
+    // Physical address of the first SDRAM byte
+    unsigned long long base;
+
+    // Address bits of each part
+    unsigned bus_bits;
+    unsigned column_bits;
+    unsigned bank_bits;
+    unsigned row_bits;
+    unsigned chip_bits;
+
+    // Bank bits right above the column (the others sit above the row)
+    unsigned bank_low_bits;
+
+    // Position of the first bit of each part
+    unsigned column_shift;
+    unsigned bank_shift;
+    unsigned row_shift;
+    unsigned bank_high_shift;
+    unsigned chip_shift;
+};
+
+// A SDRAM location
+struct sdram_location{
+    unsigned chip;
+    unsigned bank;
+    unsigned row;
+    unsigned column;
+};
+
+
+// Value of a SDCFG field, 0 when the field is not present
+static inline unsigned sdram_field_value(unsigned sdcfg, struct sdram_field f){
+    if(f.width == 0)
+        return 0;
+
+    return (sdcfg >> f.shift) & ((1u << f.width) - 1);
+}
+
+
+// Address bits [shift, shift + bits) of an address
+static inline unsigned sdram_bits(unsigned long long address, unsigned shift, unsigned bits){
+    return (unsigned)((address >> shift) & ((1ull << bits) - 1));
+}
+
+
+/* sdram_geometry_init
+ *
+ * Description: Decodes a SDCFG value into the geometry of the EMIF
+ *
+ * Parameter:
+ *              - struct sdram_geometry* geometry: Geometry to build
+ *              - const struct sdram_sdcfg_layout* layout: SDCFG fields of the controller
+ *              - unsigned sdcfg: SDCFG value (e.g., emif_get_sdcfg)
+ *              - unsigned long long base: Physical address of the first SDRAM byte
+ *
+ * Returns:     0 on success, -1 if a field holds a reserved encoding
+ *
+ * */
+static inline int sdram_geometry_init(struct sdram_geometry* geometry, const struct sdram_sdcfg_layout* layout, unsigned sdcfg, unsigned long long base){
+    unsigned ibank = sdram_field_value(sdcfg, layout->ibank);
+    unsigned pagesize = sdram_field_value(sdcfg, layout->pagesize);
+    unsigned narrow_mode = sdram_field_value(sdcfg, layout->narrow_mode);
+    unsigned ibank_pos = sdram_field_value(sdcfg, layout->ibank_pos);
+
+    // IBANK: 1, 2, 4 or 8 banks, PAGESIZE: 256, 512, 1024 or 2048 words, NARROW_MODE: full, half or quarter bus
+    if(ibank > 3 || pagesize > 3 || narrow_mode >= layout->bus_bits)
+        return -1;
+
+    geometry->layout = layout;
+    geometry->sdcfg = sdcfg;
+    geometry->base = base;
+
+    geometry->bus_bits = layout->bus_bits - narrow_mode;
+    geometry->column_bits = 8 + pagesize;
+    geometry->bank_bits = ibank;
+    geometry->row_bits = layout->row_bits + sdram_field_value(sdcfg, layout->rowsize);
+    geometry->chip_bits = sdram_field_value(sdcfg, layout->ebank);
+    geometry->bank_low_bits = (ibank > ibank_pos) ? ibank - ibank_pos : 0;
+
+    geometry->column_shift = geometry->bus_bits;
+    geometry->bank_shift = geometry->column_shift + geometry->column_bits;
+    geometry->row_shift = geometry->bank_shift + geometry->bank_low_bits;
+    geometry->bank_high_shift = geometry->row_shift + geometry->row_bits;
+    geometry->chip_shift = geometry->bank_high_shift + (geometry->bank_bits - geometry->bank_low_bits);
+
+    return 0;
+}
+
+
+/* sdram_decode
+ *
+ * Description: Physical address to SDRAM location (the bus bytes offset is dropped)
+ *
+ * Parameter:
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - unsigned long long address: Physical address, at least geometry->base
+ *              - struct sdram_location* location: Where the location is written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void sdram_decode(const struct sdram_geometry* geometry, unsigned long long address, struct sdram_location* location){
+    unsigned long long offset = address - geometry->base;
+    unsigned bank_high_bits = geometry->bank_bits - geometry->bank_low_bits;
+
+    location->column = sdram_bits(offset, geometry->column_shift, geometry->column_bits);
+    location->row = sdram_bits(offset, geometry->row_shift, geometry->row_bits);
+    location->chip = sdram_bits(offset, geometry->chip_shift, geometry->chip_bits);
+    location->bank = sdram_bits(offset, geometry->bank_shift, geometry->bank_low_bits) |
+                     (sdram_bits(offset, geometry->bank_high_shift, bank_high_bits) << geometry->bank_low_bits);
+}
+
+
+/* sdram_encode
+ *
+ * Description: SDRAM location to physical address (inverse of sdram_decode, first byte of the bus word)
+ *
+ * Parameter:
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - const struct sdram_location* location: Location (each part is reduced to its number of bits)
+ *
+ * Returns:     The physical address
+ *
+ * */
+static inline unsigned long long sdram_encode(const struct sdram_geometry* geometry, const struct sdram_location* location){
+    unsigned bank_high_bits = geometry->bank_bits - geometry->bank_low_bits;
+    unsigned long long offset = 0;
+
+    offset |= (unsigned long long)sdram_bits(location->column, 0, geometry->column_bits) << geometry->column_shift;
+    offset |= (unsigned long long)sdram_bits(location->bank, 0, geometry->bank_low_bits) << geometry->bank_shift;
+    offset |= (unsigned long long)sdram_bits(location->row, 0, geometry->row_bits) << geometry->row_shift;
+    offset |= (unsigned long long)sdram_bits(location->bank, geometry->bank_low_bits, bank_high_bits) << geometry->bank_high_shift;
+    offset |= (unsigned long long)sdram_bits(location->chip, 0, geometry->chip_bits) << geometry->chip_shift;
+
+    return geometry->base + offset;
+}
+
+
+/* sdram_bank_address
+ *
+ * Description: Address of the first column of a row in a bank, e.g., to place a benchmark target in a given bank
+ *
+ * Parameter:
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - unsigned chip: Chip select
+ *              - unsigned bank: Bank
+ *              - unsigned row: Row
+ *
+ * Returns:     The physical address
+ *
+ * */
+static inline unsigned long long sdram_bank_address(const struct sdram_geometry* geometry, unsigned chip, unsigned bank, unsigned row){
+    struct sdram_location location = {chip, bank, row, 0};
+
+    return sdram_encode(geometry, &location);
+}
+
+
+/* sdram_color_bit
+ *
+ * Description: Position of the lowest of the nb_bits upper bank bits which sit right above the column,
+ *              i.e., the first partition bit of a page coloring over nb_bits bank bits
+ *
+ * Parameter:
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - unsigned nb_bits: Number of partition bits
+ *
+ * Returns:     The bit position, -1 if there are fewer bank bits below the row
+ *
+ * */
+static inline int sdram_color_bit(const struct sdram_geometry* geometry, unsigned nb_bits){
+    if(nb_bits > geometry->bank_low_bits)
+        return -1;
+
+    return geometry->bank_shift + geometry->bank_low_bits - nb_bits;
+}
+
+
+/* sdram_geometry_print
+ *
+ * Description: Writes the geometry: "<layout> SDCFG <value>: <chips> chips, <banks> banks, <rows> rows, <columns> columns,
+ *              <bus bytes> bytes bus", then the first address bit and the number of bits of each part
+ *
+ * Parameter:
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void sdram_geometry_print(const struct sdram_geometry* geometry, void (*write_line)(char* line)){
+    char line[256];
+
+    snprintf(line, sizeof(line), "%s SDCFG 0x%08X: %u chips, %u banks, %u rows, %u columns, %u bytes bus \n\r",
+             geometry->layout->name, geometry->sdcfg, 1u << geometry->chip_bits, 1u << geometry->bank_bits,
+             1u << geometry->row_bits, 1u << geometry->column_bits, 1u << geometry->bus_bits);
+    write_line(line);
+
+    snprintf(line, sizeof(line), "Address bits (first, count): column %u %u, bank %u %u, bank above the row %u %u, row %u %u, chip %u %u \n\r",
+             geometry->column_shift, geometry->column_bits, geometry->bank_shift, geometry->bank_low_bits,
+             geometry->bank_high_shift, geometry->bank_bits - geometry->bank_low_bits,
+             geometry->row_shift, geometry->row_bits, geometry->chip_shift, geometry->chip_bits);
+    write_line(line);
+}
+
+#endif /* SDRAM_GEOMETRY_H_ */
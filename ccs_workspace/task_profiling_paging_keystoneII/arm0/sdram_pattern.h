@@ -0,0 +1,253 @@
+/*--------------------------- sdram_pattern.h ----------------------------
+ |  File sdram_pattern.h
+ |
+ |  Description: SDRAM access pattern generator. From the geometry of an
+ |               EMIF (sdram_geometry.h) and an origin location, builds the
+ |               addresses of SDRAM_PATTERN_NB_ACCESSES accesses for one
+ |               scenario, so that each case of the row-buffer cost can be
+ |               driven in isolation:
+ |               - row hit: one row of one bank,
+ |               - row conflict: two rows of one bank, alternately,
+ |               - bank round-robin: the same row of K banks, in turn,
+ |               - turnaround: one row of one bank, reads and writes
+ |                 alternately.
+ |               Successive accesses of a row are one cache line apart, so
+ |               that none of them is merged with the previous one.
+ |
+ |               The pattern is run by an unrolled kernel: ARM assembly
+ |               (address table walked with post-increment loads), C66x C
+ |               unrolled by the TI compiler, or portable C on any other
+ |               target (e.g., a Linux host). Locations are turned into
+ |               pointers by a resolve function: physical addresses on an
+ |               identity mapped target, any translation elsewhere.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef SDRAM_PATTERN_H_
+#define SDRAM_PATTERN_H_
+
+#include "sdram_geometry.h"
+
+// Accesses of a pattern (as the store and load microbenchmarks)
+#define SDRAM_PATTERN_NB_ACCESSES 128
+
+// Bytes between two accesses of a row (cache line of the A15 and of the C66x L1D)
+#ifndef SDRAM_PATTERN_LINE_SIZE
+#define SDRAM_PATTERN_LINE_SIZE 64
+#endif
+
+// Scenarios
+#define SDRAM_PATTERN_ROW_HIT           0
+#define SDRAM_PATTERN_ROW_CONFLICT      1
+#define SDRAM_PATTERN_BANK_ROUND_ROBIN  2
+#define SDRAM_PATTERN_TURNAROUND        3
+#define SDRAM_NB_PATTERNS               4
+
+// Operations of the accesses (SDRAM_PATTERN_READ_WRITE: turnaround, a read then a write)
+#define SDRAM_PATTERN_READ       0
+#define SDRAM_PATTERN_WRITE      1
+#define SDRAM_PATTERN_READ_WRITE 2
+
+// Scenario names, by scenario
+static const char* const SDRAM_PATTERN_NAMES[SDRAM_NB_PATTERNS] = {"row_hit", "row_conflict", "bank_round_robin", "turnaround"};
+// Operation names, by operation
+static const char* const SDRAM_PATTERN_OP_NAMES[] = {"read", "write", "read_write"};
+
+// Accesses of a scenario
+struct sdram_pattern{
+    unsigned scenario;
+    unsigned op;
+    volatile unsigned* address[SDRAM_PATTERN_NB_ACCESSES];
+};
+
+// Pointer to a location, NULL if it cannot be accessed
+typedef volatile unsigned* (*sdram_pattern_resolve)(const struct sdram_geometry* geometry, const struct sdram_location* location, void* context);
+
+// Repetition of an assembly string in the unrolled kernels
+#define SDRAM_PATTERN_X8(s) s s s s s s s s
+#define SDRAM_PATTERN_X64(s) SDRAM_PATTERN_X8(SDRAM_PATTERN_X8(s))
+#define SDRAM_PATTERN_X128(s) SDRAM_PATTERN_X64(s) SDRAM_PATTERN_X64(s)
+
+
+/* sdram_pattern_physical
+ *
+ * Description: Resolve function of an identity mapped target: the physical address of the location
+ *
+ * Parameter:
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - const struct sdram_location* location: Location
+ *              - void* context: Not used
+ *
+ * Returns:     The pointer
+ *
+ * */
+static inline volatile unsigned* sdram_pattern_physical(const struct sdram_geometry* geometry, const struct sdram_location* location, void* context){
+    (void)context;
+
+    return (volatile unsigned*)(unsigned long)sdram_encode(geometry, location);
+}
+
+
+/* sdram_pattern_location
+ *
+ * Description: Location of an access of a scenario. The accesses of a row move one cache line further each time
+ *              (wrapping at the end of the row), the row conflict alternates origin row and next row, the round-robin
+ *              walks banks origin bank to origin bank + nb_banks - 1
+ *
+ * Parameter:
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - unsigned scenario: SDRAM_PATTERN_ROW_HIT, _ROW_CONFLICT, _BANK_ROUND_ROBIN or _TURNAROUND
+ *              - const struct sdram_location* origin: Location of the first access
+ *              - unsigned nb_banks: Banks of the round-robin
+ *              - unsigned access: Access index
+ *              - struct sdram_location* location: Where the location is written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void sdram_pattern_location(const struct sdram_geometry* geometry, unsigned scenario, const struct sdram_location* origin,
+                                          unsigned nb_banks, unsigned access, struct sdram_location* location){
+    unsigned columns_per_line = SDRAM_PATTERN_LINE_SIZE >> geometry->bus_bits;
+    unsigned line = access;
+
+    *location = *origin;
+
+    if(scenario == SDRAM_PATTERN_ROW_CONFLICT){
+        location->row = origin->row + (access & 1);
+        line = access / 2;
+    }
+    else if(scenario == SDRAM_PATTERN_BANK_ROUND_ROBIN){
+        location->bank = origin->bank + access % nb_banks;
+        line = access / nb_banks;
+    }
+
+    // Parts beyond their number of bits wrap in sdram_encode (column in the row, bank and row in the device)
+    location->column = origin->column + line * ((columns_per_line == 0) ? 1 : columns_per_line);
+}
+
+
+/* sdram_pattern_build
+ *
+ * Description: Builds the accesses of a scenario
+ *
+ * Parameter:
+ *              - struct sdram_pattern* pattern: Pattern to build
+ *              - const struct sdram_geometry* geometry: Geometry of the EMIF
+ *              - unsigned scenario: SDRAM_PATTERN_ROW_HIT, _ROW_CONFLICT, _BANK_ROUND_ROBIN or _TURNAROUND
+ *              - unsigned op: SDRAM_PATTERN_READ or _WRITE (the turnaround always reads then writes)
+ *              - const struct sdram_location* origin: Location of the first access
+ *              - unsigned nb_banks: Banks of the round-robin (2 to the number of banks of the device, otherwise not used)
+ *              - sdram_pattern_resolve resolve: Location to pointer (e.g., sdram_pattern_physical)
+ *              - void* context: Argument of resolve
+ *
+ * Returns:     0 on success, -1 if the scenario does not fit the geometry or a location cannot be resolved
+ *
+ * */
+static inline int sdram_pattern_build(struct sdram_pattern* pattern, const struct sdram_geometry* geometry, unsigned scenario, unsigned op,
+                                      const struct sdram_location* origin, unsigned nb_banks, sdram_pattern_resolve resolve, void* context){
+    struct sdram_location location;
+    unsigned i;
+
+    if(scenario >= SDRAM_NB_PATTERNS || op > SDRAM_PATTERN_WRITE)
+        return -1;
+    if(scenario == SDRAM_PATTERN_BANK_ROUND_ROBIN && (nb_banks < 2 || nb_banks > (1u << geometry->bank_bits)))
+        return -1;
+
+    pattern->scenario = scenario;
+    pattern->op = (scenario == SDRAM_PATTERN_TURNAROUND) ? SDRAM_PATTERN_READ_WRITE : op;
+
+    for(i = 0; i < SDRAM_PATTERN_NB_ACCESSES; i++){
+        sdram_pattern_location(geometry, scenario, origin, nb_banks, i, &location);
+        pattern->address[i] = resolve(geometry, &location, context);
+        if(pattern->address[i] == NULL)
+            return -1;
+    }
+
+    return 0;
+}
+
+
+/* sdram_pattern_run
+ *
+ * Description: Issues the accesses of a pattern, in order, with an unrolled kernel. The address table is read too:
+ *              it should not sit in the SDRAM measured when the data caches are disabled
+ *
+ * Parameter:
+ *              - const struct sdram_pattern* pattern: Pattern to run
+ *              - unsigned value: Value written by the writes
+ *
+ * Returns:     Nothing
+ *
+ * */
+#if defined(__arm__)
+static inline void sdram_pattern_run(const struct sdram_pattern* pattern, unsigned value){
+    volatile unsigned* const* table = pattern->address;
+    unsigned address, data;
+
+    if(pattern->op == SDRAM_PATTERN_READ)
+        __asm__ __volatile(SDRAM_PATTERN_X128(" ldr %1, [%0], #4\n ldr %2, [%1]\n")
+                           : "+r" (table), "=&r" (address), "=&r" (data) :: "memory");
+    else if(pattern->op == SDRAM_PATTERN_WRITE)
+        __asm__ __volatile(SDRAM_PATTERN_X128(" ldr %1, [%0], #4\n str %2, [%1]\n")
+                           : "+r" (table), "=&r" (address) : "r" (value) : "memory");
+    else
+        __asm__ __volatile(SDRAM_PATTERN_X64(" ldr %1, [%0], #4\n ldr %2, [%1]\n ldr %1, [%0], #4\n str %3, [%1]\n")
+                           : "+r" (table), "=&r" (address), "=&r" (data) : "r" (value) : "memory");
+}
+#else
+static inline void sdram_pattern_run(const struct sdram_pattern* pattern, unsigned value){
+    unsigned i;
+
+    if(pattern->op == SDRAM_PATTERN_READ){
+#if defined(_TMS320C6X)
+#pragma UNROLL(128)
+#endif
+        for(i = 0; i < SDRAM_PATTERN_NB_ACCESSES; i++)
+            (void)*pattern->address[i];
+    }
+    else if(pattern->op == SDRAM_PATTERN_WRITE){
+#if defined(_TMS320C6X)
+#pragma UNROLL(128)
+#endif
+        for(i = 0; i < SDRAM_PATTERN_NB_ACCESSES; i++)
+            *pattern->address[i] = value;
+    }
+    else{
+#if defined(_TMS320C6X)
+#pragma UNROLL(64)
+#endif
+        for(i = 0; i < SDRAM_PATTERN_NB_ACCESSES; i += 2){
+            (void)*pattern->address[i];
+            *pattern->address[i + 1] = value;
+        }
+    }
+}
+#endif
+
+
+/* sdram_pattern_print
+ *
+ * Description: Writes "<scenario> <op> <accesses> <rows> <banks>: chip <c> bank <b> row <r> column <col>" for the first access,
+ *              rows and banks being the number of distinct rows and banks of the pattern
+ *
+ * Parameter:
+ *              - const struct sdram_pattern* pattern: Pattern built
+ *              - const struct sdram_location* origin: Location of the first access
+ *              - unsigned nb_banks: Banks of the round-robin
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void sdram_pattern_print(const struct sdram_pattern* pattern, const struct sdram_location* origin, unsigned nb_banks, void (*write_line)(char* line)){
+    unsigned rows = (pattern->scenario == SDRAM_PATTERN_ROW_CONFLICT) ? 2 : 1;
+    unsigned banks = (pattern->scenario == SDRAM_PATTERN_BANK_ROUND_ROBIN) ? nb_banks : 1;
+    char line[256];
+
+    snprintf(line, sizeof(line), "%s %s %u %u %u: chip %u bank %u row %u column %u \n\r", SDRAM_PATTERN_NAMES[pattern->scenario], SDRAM_PATTERN_OP_NAMES[pattern->op],
+             SDRAM_PATTERN_NB_ACCESSES, rows, banks, origin->chip, origin->bank, origin->row, origin->column);
+    write_line(line);
+}
+
+#endif /* SDRAM_PATTERN_H_ */
@@ -0,0 +1,120 @@
+/*--------------------------- tile_tuner.h -------------------------------
+ |  File tile_tuner.h
+ |
+ |  Description: Tile size auto-tuner of the cache-blocked tasks. Every
+ |               candidate tile is run a few times, each run measured by
+ |               the caller (execution time and EMIF accesses), and the
+ |               tile with the fewest EMIF accesses per run is kept: on
+ |               the current cache configuration (enabled caches, page
+ |               coloring, L2 partition...), it is the one sending the
+ |               least interference to the shared memory. Tiles within
+ |               TILE_TUNER_TOLERANCE_PERMILLE of the fewest accesses are
+ |               ranked by execution time, since the counts vary slightly
+ |               from a run to the next.
+ |
+ |               Tile 0 stands for the untiled task: its accesses are the
+ |               reference of the reduction reported for the best tile.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef TILE_TUNER_H_
+#define TILE_TUNER_H_
+
+#include <stdio.h>
+
+// Maximum number of candidate tiles
+#define TILE_TUNER_MAX_TILES 16
+
+// Per mille above the fewest EMIF accesses within which tiles are ranked by execution time
+#define TILE_TUNER_TOLERANCE_PERMILLE 10
+
+// Runs of a candidate tile
+struct tile_tuner_result{
+    unsigned tile;
+    unsigned runs;
+    unsigned long long time;
+    unsigned long long emif_accesses;
+};
+
+// Measures one run of the task with a tile: execution time and EMIF accesses of the run
+typedef void (*tile_tuner_measure)(unsigned tile, unsigned long long* time, unsigned long long* emif_accesses);
+
+
+// Mean of a sum over the runs of a tile
+static inline unsigned long long tile_tuner_mean(unsigned long long sum, unsigned runs){
+    return (runs == 0) ? 0 : sum / runs;
+}
+
+
+/* tile_tune
+ *
+ * Description: Measures every candidate tile nb_runs times, writes "<name> <tile> <runs> <mean time> <mean EMIF accesses>" for each
+ *              tile, then "best <name> <tile> <mean time> <mean EMIF accesses> <reduction (per mille)>", the reduction being the
+ *              share of the EMIF accesses of the untiled task (tile 0) removed by the best tile (0 without tile 0 in the candidates)
+ *
+ * Parameter:
+ *              - const char* name: Task name
+ *              - const unsigned* tiles, unsigned nb_tiles: Candidate tiles (at most TILE_TUNER_MAX_TILES, 0: untiled task)
+ *              - unsigned nb_runs: Runs of each tile
+ *              - tile_tuner_measure measure: Measurement of a run
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     The best tile
+ *
+ * */
+static inline unsigned tile_tune(const char* name, const unsigned* tiles, unsigned nb_tiles, unsigned nb_runs, tile_tuner_measure measure,
+                                 void (*write_line)(char* line)){
+    struct tile_tuner_result results[TILE_TUNER_MAX_TILES];
+    unsigned long long time, accesses, fewest = 0, untiled = 0, best_accesses;
+    unsigned t, r, best = 0, reduction = 0;
+    char line[256];
+
+    if(nb_tiles > TILE_TUNER_MAX_TILES)
+        nb_tiles = TILE_TUNER_MAX_TILES;
+    if(nb_tiles == 0)
+        return 0;
+
+    for(t = 0; t < nb_tiles; t++){
+        results[t].tile = tiles[t];
+        results[t].runs = nb_runs;
+        results[t].time = 0;
+        results[t].emif_accesses = 0;
+
+        for(r = 0; r < nb_runs; r++){
+            measure(tiles[t], &time, &accesses);
+            results[t].time += time;
+            results[t].emif_accesses += accesses;
+        }
+
+        accesses = tile_tuner_mean(results[t].emif_accesses, nb_runs);
+        snprintf(line, sizeof(line), "%s %u %u %llu %llu \n\r", name, tiles[t], nb_runs, tile_tuner_mean(results[t].time, nb_runs), accesses);
+        write_line(line);
+
+        if(t == 0 || accesses < fewest)
+            fewest = accesses;
+        if(tiles[t] == 0)
+            untiled = accesses;
+    }
+
+    // Fastest tile among those within the tolerance of the fewest accesses (at least the tile of the fewest accesses)
+    best = nb_tiles;
+    for(t = 0; t < nb_tiles; t++){
+        accesses = tile_tuner_mean(results[t].emif_accesses, nb_runs);
+        if(accesses * 1000 > fewest * (1000 + TILE_TUNER_TOLERANCE_PERMILLE))
+            continue;
+        if(best == nb_tiles || results[t].time < results[best].time)
+            best = t;
+    }
+
+    best_accesses = tile_tuner_mean(results[best].emif_accesses, nb_runs);
+    if(untiled > best_accesses)
+        reduction = (unsigned)(((untiled - best_accesses) * 1000) / untiled);
+
+    snprintf(line, sizeof(line), "best %s %u %llu %llu %u \n\r", name, results[best].tile, tile_tuner_mean(results[best].time, nb_runs), best_accesses, reduction);
+    write_line(line);
+
+    return results[best].tile;
+}
+
+#endif /* TILE_TUNER_H_ */
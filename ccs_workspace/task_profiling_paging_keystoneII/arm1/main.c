@@ -7,9 +7,11 @@
  | File main.c
  |
  | Description:  The core is set up for causing interference
- |               and see the response of arm0 to them
+ |               and see the response of arm0 to them.
+ |               Its PMU counters are published to arm0 through
+ |               the MSMC SRAM exchange area (pmu_xcore.h)
  |
- | Version: 1.0
+ | Version: 1.6
  |
  | Contact:
  | alfonso.mascarenas-gonzalez@isae-supaero.fr
@@ -22,10 +24,24 @@
 
 /* ------------------------- FILE INCLUSION -------------------------- */
 #include <stdio.h>
+#include "../arm0/pmu_counter_source.h"
+#include "../arm0/pmu_xcore.h"
+
+static void xcore_poll(void);
+
+// The counters are published at the phase boundaries of the benchmarks when arm0 requests a new epoch
+#define BENCHMARK_REGION_BEGIN(id) xcore_poll()
+#define BENCHMARK_REGION_END(id) xcore_poll()
+
 #include "../arm0/benchmarks.h"
 #include "../arm0/MMU.h"
 #include "../arm0/PMH.h"
 #include "../arm0/MSMC.h"
+#include "../arm0/emif_driver.h"
+#include "../arm0/emif_event_scheduler.h"
+#include "../arm0/sdram_geometry.h"
+#include "../arm0/stream_kernels.h"
+#include "../arm0/interference_generator.h"
 
 
 /* ----------------------- LOCAL FUNCTIONS --------------------------- */
@@ -33,6 +49,11 @@ void ARM_disable_caches();
 static inline void ARM_init(unsigned page_level1_descriptor_addr);
 static inline void paging_setup(unsigned page_option, unsigned page_level1_descriptor_addr);
 void page_coloring(unsigned page_level1_descriptor_addr, unsigned page_level2_descriptor_addr, unsigned nb_partition_bits, unsigned initial_partition_position_bit, unsigned selected_partition_bit_id);
+static void xcore_read(struct pmu_snapshot* snapshot);
+static int interference_start(void);
+static void interference_sweep_step(void);
+static void interference_read_pmu(unsigned* time, unsigned* accesses);
+static void interference_read_emif(unsigned* time, unsigned* accesses);
 
 
 /* --------------- GLOBAL VARIABLES DEFINITIONS --------------- */
@@ -40,6 +61,56 @@ void page_coloring(unsigned page_level1_descriptor_addr, unsigned page_level2_de
 // ARM configuration mode. 0 = only L1 instruction cache, 1 = all caches plus others (MMU, branch predictor...)
 #define ARM_INIT_CONFIGURATION   1
 
+// Events of counters 0 to 5, the same as arm0 (see arm_pmu_management.c)
+const unsigned AGGRESSOR_EVENTS[PMU_NB_EVT_COUNTERS] = {0x19, 0x04, 0x03, 0x16, 0x17, 0x10};
+
+// PMU exchange area shared with arm0, slot of this core and last epoch answered
+struct pmu_xcore_area* const xcore_area = (struct pmu_xcore_area*)PMU_XCORE_AREA_ADDRESS;
+#define XCORE_SLOT 1
+unsigned xcore_last_epoch = 0;
+
+// Interference produced. 0 = system stress matrix, 1 = STREAM triad (peak-bandwidth aggressor),
+// 2 = cache-blocked system stress matrix (good citizen: same work, fewer EMIF accesses), 3 = rate-controlled generator
+#define AGGRESSOR_KERNEL 0
+// Tile of the cache-blocked matrix, e.g., the best tile found by the tile tuner of arm0
+#define AGGRESSOR_TILE 32
+
+// STREAM arrays placement: first word (identity mapped space free of partitioning, after the arrays of arm0) and words per array
+#define STREAM_ARRAYS_ADDRESS 0xF4000000
+#define STREAM_ARRAY_WORDS (4*1024*1024)
+
+struct stream_arrays stream_arrays;
+
+// Target rates of the rate-controlled generator (DDR accesses per microsecond, thousandths), each held INTERFERENCE_STEP_MS
+// then the next one, endlessly. The rate during each victim run is derived by arm0 from the harvested cycles and L2 refills
+const unsigned INTERFERENCE_RATES[] = {0, 2000, 5000, 10000, 20000, 40000, 80000};
+#define NB_INTERFERENCE_RATES (sizeof(INTERFERENCE_RATES)/sizeof(INTERFERENCE_RATES[0]))
+#define INTERFERENCE_STEP_MS 500
+
+// Writes per thousand accesses, target chip select and bank
+#define INTERFERENCE_WRITE_PERMILLE 300
+#define INTERFERENCE_CHIP 0
+#define INTERFERENCE_BANK 0
+// First row walked: row of this address (identity mapped space free of partitioning, between the pointer chasing buffer of
+// arm0 and the STREAM arrays)
+#define INTERFERENCE_ORIGIN_ADDRESS 0xE8000000
+
+// Feedback counters. 0 = PMU: cycles, and L2 refills of this core (counter 4) plus the write-back of each written line,
+// 1 = EMIF: PERF_CNT_TIM and PERF_CNT_1 of DDR3A, filtered on the ARM MSTID. The A15 cores share that MSTID, so the DDR3A accesses
+// of arm0 are counted too (the generator then holds the rate of the whole cluster). PERF_CNT_1 is programmed here: this mode cannot
+// run together with EMIF_EVENT_ROTATION or EMIF_MSTID_SWEEP of arm0, which reprogram the counter
+#define INTERFERENCE_FEEDBACK 0
+#define INTERFERENCE_EMIF_MSTID 0x8
+#define A15_CLOCK_MHZ 1200
+#define DDR3A_EMIF_CLOCK_MHZ 800
+
+const struct emif_controller interference_emif = {(volatile unsigned char*)EMIF_KEYSTONE2_DDR3A_ADDRESS, &EMIF_REGMAP_KEYSTONE2};
+struct sdram_geometry interference_geometry;
+struct interference_generator interference;
+// Rate held, and time (ticks of the feedback) when it was set
+unsigned interference_rate_index = 0;
+unsigned long long interference_step_start = 0;
+
 
 /* ========================================================================== */
 /*                   Internal Function Declarations                           */
@@ -57,11 +128,36 @@ int main(void)
         enable_caches(1,0);
 
 
+    // Program the events and let the counters run freely, arm0 only uses their increments
+    unsigned i;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++){
+        select_evt_counter(i);
+        event_track(AGGRESSOR_EVENTS[i]);
+    }
+    reset_all_counters(0);
+    __asm__ __volatile("isb");
+    enable_all_counters(0x3F);
+
+
     unsigned const MATRIX_SIZE = 512;
 
+    if(AGGRESSOR_KERNEL == 1)
+        stream_arrays_init(&stream_arrays, (unsigned*)STREAM_ARRAYS_ADDRESS, STREAM_ARRAY_WORDS, 0);
+
+    // Without the DDR3A geometry, the generator falls back to the system stress matrix
+    unsigned generator_ready = (AGGRESSOR_KERNEL == 3 && interference_start() == 0);
+
     // Produce memory interference endlessly
     while(1){
-        matrix_stress2_task(MATRIX_SIZE);
+        if(AGGRESSOR_KERNEL == 1)
+            stream_run(&stream_arrays, STREAM_TRIAD);
+        else if(AGGRESSOR_KERNEL == 2)
+            matrix_stress2_tiled_task(MATRIX_SIZE, AGGRESSOR_TILE);
+        else if(generator_ready)
+            interference_sweep_step();
+        else
+            matrix_stress2_task(MATRIX_SIZE);
+        xcore_poll();
 
     }
 
@@ -69,6 +165,94 @@ int main(void)
 }
 
 
+// Reads the free-running counters of this core
+static void xcore_read(struct pmu_snapshot* snapshot){
+    read_all_counters(&snapshot->cycles, snapshot->evt);
+}
+
+
+/* interference_start
+ *
+ * Description: Decodes the DDR3A geometry and starts the rate-controlled generator at the first rate of INTERFERENCE_RATES
+ *
+ * Parameter:   None
+ *
+ * Returns:     0 on success, -1 if the SDCFG of DDR3A cannot be decoded
+ *
+ * */
+static int interference_start(void){
+    struct interference_config config = {INTERFERENCE_RATES[0], INTERFERENCE_WRITE_PERMILLE, INTERFERENCE_CHIP, INTERFERENCE_BANK, 0};
+    struct sdram_location origin;
+
+    if(sdram_geometry_init(&interference_geometry, &SDRAM_SDCFG_KEYSTONE2, emif_get_sdcfg(&interference_emif), 0x80000000) < 0)
+        return -1;
+
+    sdram_decode(&interference_geometry, INTERFERENCE_ORIGIN_ADDRESS, &origin);
+    config.first_row = origin.row;
+
+    // EMIF: DDR3A accesses of the A15 cluster. PMU: each written line is refilled, then written back when evicted
+    if(INTERFERENCE_FEEDBACK == 1){
+        emif_set_event(&interference_emif, 0, EMIF_EVT_ACCESSES);
+        emif_set_master(&interference_emif, 0, INTERFERENCE_EMIF_MSTID);
+        interference_init(&interference, &interference_geometry, &config, interference_read_emif, DDR3A_EMIF_CLOCK_MHZ, 1000);
+    }
+    else
+        interference_init(&interference, &interference_geometry, &config, interference_read_pmu, A15_CLOCK_MHZ, 1000 + INTERFERENCE_WRITE_PERMILLE);
+
+    interference_rate_index = 0;
+    interference_step_start = interference.elapsed;
+
+    return 0;
+}
+
+
+/* interference_sweep_step
+ *
+ * Description: One step of the generator, then the next rate of INTERFERENCE_RATES once the current one was held INTERFERENCE_STEP_MS
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void interference_sweep_step(void){
+    struct interference_config config;
+
+    interference_step(&interference);
+
+    if(interference.elapsed - interference_step_start < (unsigned long long)INTERFERENCE_STEP_MS * 1000 * interference.ticks_per_us)
+        return;
+
+    interference_rate_index = (interference_rate_index + 1) % NB_INTERFERENCE_RATES;
+    config = interference.config;
+    config.rate_milli = INTERFERENCE_RATES[interference_rate_index];
+    interference_set_target(&interference, &config);
+    interference_step_start = interference.elapsed;
+}
+
+
+// Feedback of the generator: cycle counter and L2 refills (counter 4, event 0x17) of this core
+static void interference_read_pmu(unsigned* time, unsigned* accesses){
+    unsigned evt[PMU_NB_EVT_COUNTERS];
+
+    read_all_counters(time, evt);
+    *accesses = evt[4];
+}
+
+
+// Feedback of the generator: DDR3A timer and accesses (PERF_CNT_1, as configured by arm0)
+static void interference_read_emif(unsigned* time, unsigned* accesses){
+    *time = *emif_reg(&interference_emif, interference_emif.regs->perf_cnt_tim);
+    *accesses = *emif_reg(&interference_emif, interference_emif.regs->perf_cnt_1);
+}
+
+
+// Publishes the counters if arm0 requested a new epoch
+static void xcore_poll(void){
+    pmu_xcore_poll(xcore_area, XCORE_SLOT, &xcore_last_epoch, xcore_read);
+}
+
+
 /* ARM_disable_caches
  *
  * Description: Disables the L1I, L1D, L2 and invalidates the TLB
@@ -254,8 +438,15 @@ static inline void paging_setup(unsigned page_option, unsigned page_level1_descr
     // 4 KB page partitioned
     else if(page_option == 4){
         const unsigned NB_PARTITION_BITS = 2;
-        const unsigned INITIAL_PARTITION_BIT = 14;
         const unsigned SELECTED_PARTITION_BIT_ID = 1;
+        // Same partition bits as arm0: upper bank bits below the row decoded from the DDR3A SDCFG, bit 14 if it can't be decoded
+        const struct emif_controller ddr3a = {(volatile unsigned char*)EMIF_KEYSTONE2_DDR3A_ADDRESS, &EMIF_REGMAP_KEYSTONE2};
+        struct sdram_geometry ddr_geometry;
+        int color_bit = -1;
+
+        if(sdram_geometry_init(&ddr_geometry, &SDRAM_SDCFG_KEYSTONE2, emif_get_sdcfg(&ddr3a), 0x80000000) == 0)
+            color_bit = sdram_color_bit(&ddr_geometry, NB_PARTITION_BITS);
+        const unsigned INITIAL_PARTITION_BIT = (color_bit < 0) ? 14 : (unsigned)color_bit;
 
         page_coloring(page_level1_descriptor_addr, page_level2_descriptor_addr, NB_PARTITION_BITS, INITIAL_PARTITION_BIT, SELECTED_PARTITION_BIT_ID);
 
@@ -0,0 +1,173 @@
+/*--------------------------- emif_event_scheduler_test.c ----------------
+ |  File emif_event_scheduler_test.c
+ |
+ |  Description: Host test of the EMIF counter event rotation
+ |               (arm0/emif_event_scheduler.c). Two simulated EMIFs (a
+ |               memory block each, laid out as an EMIF) count every
+ |               CNTRn_CFG event programmed in their counters at a fixed
+ |               rate per EMIF cycle, from values close to 2^32 so that
+ |               the counters wrap during the runs. The rotation over the
+ |               pairs, the coverage, the scaled counts, the events never
+ |               counted and the read/write proportions are checked
+ |               against the exact totals.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "emif_event_scheduler.h"
+
+// Simulated EMIFs: registers up to RWTHRESH
+#define NB_EMIFS 2
+static unsigned registers[NB_EMIFS][0x124 / 4];
+static struct emif_bus bus;
+
+static unsigned failures = 0;
+
+// Lines written by emif_sched_print
+static char printed[16][256];
+static unsigned nb_printed;
+
+
+// Events per EMIF cycle of an event on an EMIF
+static unsigned event_rate(unsigned emif, unsigned event){
+    return (event + 1) * (emif + 1);
+}
+
+
+static void check(const char* name, unsigned index, unsigned long long value, unsigned long long expected){
+    if(value != expected){
+        printf("FAIL %s (event %u): %llu (expected %llu) \n", name, index, value, expected);
+        failures++;
+    }
+}
+
+
+static void capture(char* line){
+    if(nb_printed < 16)
+        strcpy(printed[nb_printed], line);
+    nb_printed++;
+}
+
+
+// Free-running counters close to a wrap
+static void sim_reset(void){
+    unsigned e;
+
+    memset(registers, 0, sizeof(registers));
+    emif_bus_init(&bus);
+    for(e = 0; e < NB_EMIFS; e++){
+        emif_bus_add(&bus, registers[e], &EMIF_REGMAP_KEYSTONE2);
+        registers[e][EMIF_REGMAP_KEYSTONE2.perf_cnt_tim / 4] = 0xFFFFF000u;
+        registers[e][EMIF_REGMAP_KEYSTONE2.perf_cnt_1 / 4] = 0xFFFFFF00u;
+        registers[e][EMIF_REGMAP_KEYSTONE2.perf_cnt_2 / 4] = 0xFFFFFFF0u;
+    }
+}
+
+
+// Runs the EMIFs for some cycles: each counter counts the event of its CNTRn_CFG field
+static void sim_run(unsigned cycles){
+    unsigned e, cfg;
+
+    for(e = 0; e < NB_EMIFS; e++){
+        cfg = registers[e][EMIF_REGMAP_KEYSTONE2.perf_cnt_cfg / 4];
+        registers[e][EMIF_REGMAP_KEYSTONE2.perf_cnt_tim / 4] += cycles;
+        registers[e][EMIF_REGMAP_KEYSTONE2.perf_cnt_1 / 4] += event_rate(e, cfg & 0xF) * cycles;
+        registers[e][EMIF_REGMAP_KEYSTONE2.perf_cnt_2 / 4] += event_rate(e, (cfg >> 16) & 0xF) * cycles;
+    }
+}
+
+
+// Measured runs of cycles, cycles + step, cycles + 2*step...
+static void run(struct emif_event_scheduler* sched, unsigned nb_runs, unsigned cycles, unsigned step){
+    unsigned i;
+
+    for(i = 0; i < nb_runs; i++){
+        emif_sched_start(sched);
+        sim_run(cycles + i*step);
+        emif_sched_stop(sched);
+    }
+}
+
+
+int main(void){
+    static struct emif_event_scheduler sched;
+    const unsigned events[5] = {EMIF_EVT_ACCESSES, EMIF_EVT_ACTIVATES, EMIF_EVT_READS, EMIF_EVT_WRITES, EMIF_EVT_DATA_BUS_ACTIVE};
+    unsigned long long group_cycles[3];
+    struct emif_snapshot begin, end;
+    unsigned i, e;
+
+    // Five events: pairs (0, 1) and (2, 3), then 0xA alone on both counters, every pair counted during 10 of the 30 runs
+    sim_reset();
+    emif_sched_init(&sched, &bus, events, 5);
+    run(&sched, 30, 4096, 0);
+    for(i = 0; i < 5; i++){
+        check("runs", i, sched.runs[i], 10);
+        for(e = 0; e < NB_EMIFS; e++){
+            check("coverage", i, emif_sched_coverage_permille(&sched, e, i), 333);
+            check("raw count", i, sched.count[e][i], 10ULL * 4096 * event_rate(e, events[i]));
+            check("scaled count", i, emif_sched_scaled_count(&sched, e, i), 30ULL * 4096 * event_rate(e, events[i]));
+        }
+    }
+    check("total cycles", 0, sched.total_cycles[1], 30ULL * 4096);
+    printf("ok rotation across wraps: %u pairs, coverage %u per mille \n", sched.nb_groups, emif_sched_coverage_permille(&sched, 0, 0));
+
+    // Runs of growing length: each pair is scaled by its own counted cycles
+    sim_reset();
+    emif_sched_init(&sched, &bus, events, 5);
+    run(&sched, 31, 1000, 37);
+    group_cycles[0] = group_cycles[1] = group_cycles[2] = 0;
+    for(i = 0; i < 31; i++)
+        group_cycles[i % 3] += 1000 + i*37;
+    for(i = 0; i < 5; i++)
+        for(e = 0; e < NB_EMIFS; e++){
+            check("uneven coverage", i, emif_sched_coverage_permille(&sched, e, i), (group_cycles[i / 2] * 1000) / sched.total_cycles[e]);
+            check("uneven scaled count", i, emif_sched_scaled_count(&sched, e, i), sched.total_cycles[e] * event_rate(e, events[i]));
+        }
+    printf("ok uneven runs: %llu cycles, coverage %u/%u/%u per mille \n", sched.total_cycles[0], emif_sched_coverage_permille(&sched, 0, 0),
+           emif_sched_coverage_permille(&sched, 0, 2), emif_sched_coverage_permille(&sched, 0, 4));
+
+    // Event vector and read/write proportions: reads 3 and writes 4 per cycle and per EMIF number
+    nb_printed = 0;
+    emif_sched_print(&sched, "bench", capture);
+    check("printed lines", 0, nb_printed, 6);
+    if(strcmp(printed[5], "bench rw 428 571 \n\r") != 0){
+        printf("FAIL read/write proportions: %s", printed[5]);
+        failures++;
+    }
+
+    // Fewer runs than pairs: the last event is never counted, no read/write line without both events
+    sim_reset();
+    emif_sched_init(&sched, &bus, events, 5);
+    run(&sched, 2, 1000, 0);
+    for(e = 0; e < NB_EMIFS; e++){
+        check("zero coverage", 4, emif_sched_coverage_permille(&sched, e, 4), 0);
+        check("zero coverage scaled", 4, emif_sched_scaled_count(&sched, e, 4), 0);
+    }
+    check("next pair", 4, sched.current_group, 2);
+    emif_sched_init(&sched, &bus, events, 2);
+    run(&sched, 2, 1000, 0);
+    nb_printed = 0;
+    emif_sched_print(&sched, "bench", capture);
+    check("printed lines without reads and writes", 0, nb_printed, 2);
+    printf("ok zero coverage \n");
+
+    // No run at all, no event (timer only), too many events
+    emif_sched_init(&sched, &bus, events, 2);
+    check("no run coverage", 0, emif_sched_coverage_permille(&sched, 0, 0), 0);
+    check("no run scaled", 0, emif_sched_scaled_count(&sched, 0, 0), 0);
+    emif_sched_init(&sched, &bus, events, 0);
+    memset(&begin, 0, sizeof(begin));
+    memset(&end, 0, sizeof(end));
+    begin.cycles[0] = 0xFFFFFFFFu;
+    end.cycles[0] = 99;
+    emif_sched_account(&sched, &begin, &end);
+    check("timer only across a wrap", 0, sched.total_cycles[0], 100);
+    check("too many events", 0, (unsigned long long)emif_sched_init(&sched, &bus, events, EMIF_SCHED_MAX_EVENTS + 1), (unsigned long long)-1);
+    printf("ok no run, no event \n");
+
+    printf("%s \n", failures ? "FAILED" : "PASSED");
+
+    return failures ? 1 : 0;
+}
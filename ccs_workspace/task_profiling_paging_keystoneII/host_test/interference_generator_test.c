@@ -0,0 +1,157 @@
+/*--------------------------- interference_generator_test.c --------------
+ |  File interference_generator_test.c
+ |
+ |  Description: Host test of the closed-loop gap control of the
+ |               interference generator (arm0/interference_generator.h).
+ |               The feedback counters are simulated: a window of
+ |               INTERFERENCE_CONTROL_BURSTS bursts takes the time of its
+ |               bursts (contention included) plus the time of its gaps
+ |               at the calibrated cost of an idle iteration, so that no
+ |               SDRAM access is issued. The measured rate must converge
+ |               to the targets from 2 to 80 accesses per microsecond,
+ |               follow a change of contention, saturate at the fastest
+ |               rate when the target cannot be reached, and be 0 on an
+ |               idle window.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "interference_generator.h"
+
+// Time base of the PMU feedback (A15 cycles per microsecond), and ticks elapsed by each read of the counters during the calibration
+#define TICKS_PER_US 1200
+#define CALIBRATION_TICKS 150000
+
+// Windows run before the rate is checked, and largest error allowed (per mille of the target)
+#define SETTLE_WINDOWS 40
+#define TOLERANCE_PERMILLE 20
+
+// Targets of the arm1 sweep (accesses per microsecond, thousandths)
+static const unsigned rates[] = {2000, 5000, 10000, 20000, 40000, 80000};
+#define NB_RATES (sizeof(rates)/sizeof(rates[0]))
+
+// Simulated counters (free running, close to a wrap), and ticks added by each read
+static unsigned sim_time;
+static unsigned sim_accesses;
+static unsigned sim_read_ticks;
+
+static unsigned failures = 0;
+
+
+static void sim_read(unsigned* time, unsigned* accesses){
+    sim_time += sim_read_ticks;
+    *time = sim_time;
+    *accesses = sim_accesses;
+}
+
+
+// One control window: bursts of burst_ticks each followed by the gap, counted accesses (DDR accesses * 1000 / scale_permille)
+static void sim_window(struct interference_generator* generator, unsigned burst_ticks){
+    unsigned long long ddr_accesses = (unsigned long long)INTERFERENCE_CONTROL_BURSTS * INTERFERENCE_BURST;
+
+    sim_time += INTERFERENCE_CONTROL_BURSTS * (burst_ticks + (unsigned)(((unsigned long long)generator->gap * generator->idle_cost) / 1024));
+    sim_accesses += (unsigned)((ddr_accesses * 1000) / generator->scale_permille);
+    generator->bursts = INTERFERENCE_CONTROL_BURSTS;
+    interference_update(generator);
+}
+
+
+static void sim_init(struct interference_generator* generator, const struct sdram_geometry* geometry, unsigned rate_milli, unsigned scale_permille){
+    struct interference_config config = {rate_milli, scale_permille - 1000, 0, 0, 0};
+
+    sim_time = 0xFFFF0000u;
+    sim_accesses = 0xFFFFFF00u;
+    sim_read_ticks = CALIBRATION_TICKS;
+    interference_init(generator, geometry, &config, sim_read, TICKS_PER_US, scale_permille);
+    sim_read_ticks = 0;
+}
+
+
+static void check_rate(const char* name, const struct interference_generator* generator, unsigned expected){
+    unsigned error = (generator->rate_milli > expected) ? generator->rate_milli - expected : expected - generator->rate_milli;
+
+    if(error * 1000 > (unsigned long long)expected * TOLERANCE_PERMILLE){
+        printf("FAIL %s: %u.%03u accesses per us (expected %u.%03u) \n", name, generator->rate_milli / 1000, generator->rate_milli % 1000,
+               expected / 1000, expected % 1000);
+        failures++;
+    }
+}
+
+
+static void check(const char* name, unsigned long long value, unsigned long long expected){
+    if(value != expected){
+        printf("FAIL %s: %llu (expected %llu) \n", name, value, expected);
+        failures++;
+    }
+}
+
+
+int main(void){
+    static struct sdram_geometry geometry;
+    struct interference_generator generator;
+    struct interference_config config;
+    unsigned i, w;
+
+    // Calibration: 1.5 cycles per idle iteration
+    sim_init(&generator, &geometry, rates[0], 1000);
+    check("idle cost", generator.idle_cost, (CALIBRATION_TICKS * 1024ULL) / INTERFERENCE_CALIBRATION_LOOPS);
+
+    // Every target of the sweep, bursts of 10 cycles per access (up to 120 accesses per us), from the initial gap and through set_target
+    for(i = 0; i < NB_RATES; i++){
+        sim_init(&generator, &geometry, rates[i], 1000);
+        for(w = 0; w < SETTLE_WINDOWS; w++)
+            sim_window(&generator, 10 * INTERFERENCE_BURST);
+        check_rate("target from init", &generator, rates[i]);
+    }
+    config = generator.config;
+    for(i = 0; i < NB_RATES; i++){
+        config.rate_milli = rates[i];
+        interference_set_target(&generator, &config);
+        for(w = 0; w < SETTLE_WINDOWS; w++)
+            sim_window(&generator, 10 * INTERFERENCE_BURST);
+        check_rate("target from set_target", &generator, rates[i]);
+    }
+    printf("ok targets from %u to %u accesses per us \n", rates[0] / 1000, rates[NB_RATES - 1] / 1000);
+
+    // Contention: bursts four times slower, the gap shrinks and the rate holds
+    sim_init(&generator, &geometry, 10000, 1000);
+    for(w = 0; w < SETTLE_WINDOWS; w++)
+        sim_window(&generator, 10 * INTERFERENCE_BURST);
+    i = generator.gap;
+    for(w = 0; w < SETTLE_WINDOWS; w++)
+        sim_window(&generator, 40 * INTERFERENCE_BURST);
+    check_rate("target under contention", &generator, 10000);
+    if(generator.gap >= i){
+        printf("FAIL gap under contention: %u (was %u) \n", generator.gap, i);
+        failures++;
+    }
+    printf("ok contention: gap %u then %u iterations \n", i, generator.gap);
+
+    // L2 refills as the count (1300 DDR accesses per thousand refills with 30 % writes)
+    sim_init(&generator, &geometry, 20000, 1300);
+    for(w = 0; w < SETTLE_WINDOWS; w++)
+        sim_window(&generator, 10 * INTERFERENCE_BURST);
+    check_rate("scaled count", &generator, 20000);
+    printf("ok scaled count \n");
+
+    // Unreachable target: no gap, fastest rate of the bursts (120 accesses per us)
+    sim_init(&generator, &geometry, 200000, 1000);
+    for(w = 0; w < SETTLE_WINDOWS; w++)
+        sim_window(&generator, 10 * INTERFERENCE_BURST);
+    check("saturated gap", generator.gap, 0);
+    check_rate("saturated rate", &generator, 120000);
+
+    // Idle target: a calibration loop of idle, no access counted
+    sim_init(&generator, &geometry, 0, 1000);
+    check("idle gap", generator.gap, 0);
+    sim_read_ticks = 1000;
+    interference_step(&generator);
+    check("idle rate", generator.rate_milli, 0);
+    check("idle elapsed", generator.elapsed, 1000);
+    printf("ok saturation and idle \n");
+
+    printf("%s \n", failures ? "FAILED" : "PASSED");
+
+    return failures ? 1 : 0;
+}
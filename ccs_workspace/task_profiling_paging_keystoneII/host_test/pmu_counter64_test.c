@@ -0,0 +1,121 @@
+/*--------------------------- pmu_counter64_test.c -----------------------
+ |  File pmu_counter64_test.c
+ |
+ |  Description: Host test of the 64-bit extension of the PMU counters
+ |               (arm0/pmu_counter64.c). A simulated 32-bit counter with
+ |               a sticky overflow flag (PMOVSR) runs for several wraps,
+ |               polled at phase boundaries less than 2^31 events apart,
+ |               sometimes wrapping between the read of the value and the
+ |               read of the flags, and the extended value is checked
+ |               against the exact count.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "pmu_counter64.h"
+
+// Simulated counters: exact 64-bit counts and PMOVSR
+static unsigned long long exact_cycles, exact_evt;
+static unsigned overflow_flags;
+
+static unsigned failures = 0;
+
+
+// Adds events to the simulated cycle counter and event counter 0, raising their overflow flag when they wrap
+static void advance(unsigned long long cycles, unsigned long long evt){
+    if((exact_cycles >> 32) != ((exact_cycles + cycles) >> 32))
+        overflow_flags |= PMU_OVF_CYCLE_FLAG;
+    if((exact_evt >> 32) != ((exact_evt + evt) >> 32))
+        overflow_flags |= 1u;
+
+    exact_cycles += cycles;
+    exact_evt += evt;
+}
+
+
+static void read_raw(struct pmu_snapshot* raw){
+    unsigned i;
+
+    raw->cycles = (unsigned)exact_cycles;
+    raw->evt[0] = (unsigned)exact_evt;
+    for(i = 1; i < PMU_NB_EVT_COUNTERS; i++)
+        raw->evt[i] = 0;
+}
+
+
+// Poll of counters_poll_overflows, with "late" events counted between the read of the values and the read of the flags
+static void poll(struct pmu_wrap_tracker* tracker, unsigned long long late){
+    struct pmu_snapshot raw;
+    unsigned accounted;
+
+    read_raw(&raw);
+    advance(late, late);
+
+    accounted = pmu_wrap_poll(tracker, overflow_flags, &raw);
+    overflow_flags &= ~accounted;
+}
+
+
+// End of measurement of critical_task_end_eval: counters stopped, every pending flag accounted
+static void check_end(const char* name, struct pmu_wrap_tracker* tracker){
+    struct pmu_snapshot raw;
+    struct pmu_snapshot64 extended;
+
+    read_raw(&raw);
+    pmu_wrap_account(tracker, overflow_flags);
+    overflow_flags = 0;
+    pmu_wrap_extend(tracker, &raw, &extended);
+
+    if(extended.cycles != exact_cycles || extended.evt[0] != exact_evt){
+        printf("FAIL %s: cycles %llu (expected %llu), events %llu (expected %llu) \n", name, extended.cycles, exact_cycles, extended.evt[0], exact_evt);
+        failures++;
+    }
+    else
+        printf("ok %s: %llu cycles, %llu events \n", name, extended.cycles, extended.evt[0]);
+}
+
+
+static void start(struct pmu_wrap_tracker* tracker){
+    exact_cycles = 0;
+    exact_evt = 0;
+    overflow_flags = 0;
+    pmu_wrap_reset(tracker);
+}
+
+
+int main(void){
+    struct pmu_wrap_tracker tracker;
+    unsigned i;
+
+    // Two wraps of the cycle counter (about 7 s at 1.2 GHz), one of the event counter, polled every 0.6e9 cycles
+    start(&tracker);
+    for(i = 0; i < 14; i++){
+        advance(600000000ULL, 150000000ULL);
+        poll(&tracker, 0);
+    }
+    check_end("two wraps", &tracker);
+
+    // Wraps between the read of the values and the read of the flags: the flag is left for the next poll
+    start(&tracker);
+    advance(0xFFFFFF00ULL, 0xFFFFFF80ULL);
+    poll(&tracker, 0x200);
+    for(i = 0; i < 8; i++){
+        advance(0x70000000ULL, 0x70000000ULL);
+        poll(&tracker, 0x100);
+    }
+    check_end("wrap during the poll", &tracker);
+
+    // Five wraps with the last one pending at the end of the measurement
+    start(&tracker);
+    for(i = 0; i < 10; i++){
+        advance(0x7FFFFFFFULL, 0x40000000ULL);
+        poll(&tracker, 0);
+    }
+    advance(0x10ULL, 0x10ULL);
+    check_end("pending wrap at the end", &tracker);
+
+    printf("%s \n", failures ? "FAILED" : "PASSED");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+/*--------------------------- pmu_event_scheduler_test.c -----------------
+ |  File pmu_event_scheduler_test.c
+ |
+ |  Description: Host test of the event-group multiplexing
+ |               (arm0/pmu_event_scheduler.c). A simulated counter source
+ |               counts every event at a fixed rate per cycle, so that the
+ |               exact full-run totals are known: the round robin over
+ |               the groups, the coverage and the scaled counts are
+ |               checked against them, as well as the events which were
+ |               never counted (zero coverage, zero scaled count).
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "pmu_event_scheduler.h"
+
+// Simulated source: events programmed, cycles of the next run, and runs per programmed group
+static unsigned programmed[PMU_NB_EVT_COUNTERS];
+static unsigned nb_programmed;
+static unsigned run_cycles;
+
+static unsigned failures = 0;
+
+
+// Events per cycle of an event (event id + 1)
+static unsigned event_rate(unsigned event_id){
+    return event_id + 1;
+}
+
+
+static int sim_init(const unsigned* event_ids, unsigned nb_events){
+    unsigned i;
+
+    for(i = 0; i < nb_events; i++)
+        programmed[i] = event_ids[i];
+    nb_programmed = nb_events;
+
+    return 0;
+}
+
+
+static void sim_start(void){
+}
+
+
+static void sim_stop(struct pmu_snapshot* snapshot){
+    unsigned i;
+
+    snapshot->cycles = run_cycles;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        snapshot->evt[i] = (i < nb_programmed) ? event_rate(programmed[i]) * run_cycles : 0;
+}
+
+
+static void sim_read(struct pmu_snapshot* snapshot){
+    sim_stop(snapshot);
+}
+
+
+static const struct pmu_counter_source sim_source = {"sim", sim_init, sim_start, sim_stop, sim_read};
+
+
+static void check(const char* name, unsigned index, unsigned long long value, unsigned long long expected){
+    if(value != expected){
+        printf("FAIL %s (event %u): %llu (expected %llu) \n", name, index, value, expected);
+        failures++;
+    }
+}
+
+
+// Measured runs of cycles, cycles + step, cycles + 2*step...
+static void run(struct pmu_event_scheduler* sched, unsigned nb_runs, unsigned cycles, unsigned step){
+    unsigned i;
+
+    for(i = 0; i < nb_runs; i++){
+        run_cycles = cycles + i*step;
+        pmu_sched_start(sched);
+        pmu_sched_stop(sched);
+    }
+}
+
+
+int main(void){
+    static struct pmu_event_scheduler sched;
+    unsigned events[PMU_SCHED_MAX_EVENTS + 1];
+    unsigned long long group_cycles[3];
+    unsigned i;
+
+    for(i = 0; i <= PMU_SCHED_MAX_EVENTS; i++)
+        events[i] = i;
+
+    // Fourteen events: groups of 6, 6 and 2 counted in turn, every group counted during 10 of the 30 runs
+    pmu_sched_init(&sched, &sim_source, events, 14);
+    run(&sched, 30, 1000, 0);
+    for(i = 0; i < 14; i++){
+        check("runs", i, sched.runs[i], 10);
+        check("coverage", i, pmu_sched_coverage_permille(&sched, i), 333);
+        check("raw count", i, sched.count[i], 10ULL * 1000 * event_rate(i));
+        check("scaled count", i, pmu_sched_scaled_count(&sched, i), 30ULL * 1000 * event_rate(i));
+    }
+    printf("ok round robin: %u groups, coverage %u per mille \n", sched.nb_groups, pmu_sched_coverage_permille(&sched, 0));
+
+    // Runs of growing length: each group is scaled by its own counted cycles
+    pmu_sched_init(&sched, &sim_source, events, 14);
+    run(&sched, 31, 1000, 97);
+    group_cycles[0] = group_cycles[1] = group_cycles[2] = 0;
+    for(i = 0; i < 31; i++)
+        group_cycles[i % 3] += 1000 + i*97;
+    for(i = 0; i < 14; i++){
+        check("coverage", i, pmu_sched_coverage_permille(&sched, i), (group_cycles[i / 6] * 1000) / sched.total_cycles);
+        check("scaled count", i, pmu_sched_scaled_count(&sched, i), sched.total_cycles * event_rate(i));
+    }
+    printf("ok uneven runs: %llu cycles, coverage %u/%u/%u per mille \n", sched.total_cycles, pmu_sched_coverage_permille(&sched, 0),
+           pmu_sched_coverage_permille(&sched, 6), pmu_sched_coverage_permille(&sched, 12));
+
+    // A single group: counted during every run, the scaled count is the raw count
+    pmu_sched_init(&sched, &sim_source, events, 4);
+    run(&sched, 5, 1234, 0);
+    for(i = 0; i < 4; i++){
+        check("full coverage", i, pmu_sched_coverage_permille(&sched, i), 1000);
+        check("scaled count", i, pmu_sched_scaled_count(&sched, i), sched.count[i]);
+    }
+    printf("ok single group \n");
+
+    // Fewer runs than groups: the last group is never counted
+    pmu_sched_init(&sched, &sim_source, events, 13);
+    run(&sched, 2, 1000, 0);
+    check("zero coverage", 12, pmu_sched_coverage_permille(&sched, 12), 0);
+    check("zero coverage scaled", 12, pmu_sched_scaled_count(&sched, 12), 0);
+    check("next group", 12, sched.current_group, 2);
+    printf("ok zero coverage \n");
+
+    // No run at all, no event (cycles only), too many events
+    pmu_sched_init(&sched, &sim_source, events, 6);
+    check("no run coverage", 0, pmu_sched_coverage_permille(&sched, 0), 0);
+    check("no run scaled", 0, pmu_sched_scaled_count(&sched, 0), 0);
+    nb_programmed = 0;
+    pmu_sched_init(&sched, &sim_source, events, 0);
+    run(&sched, 3, 1000, 0);
+    check("cycles only", 0, sched.total_cycles, 3000);
+    check("too many events", 0, (unsigned long long)pmu_sched_init(&sched, &sim_source, events, PMU_SCHED_MAX_EVENTS + 1), (unsigned long long)-1);
+    printf("ok no run, no event \n");
+
+    // Large totals: the two-step scaling holds where count * total_cycles would overflow 64 bits
+    pmu_sched_init(&sched, &sim_source, events, 1);
+    sched.count[0] = 3000000000000ULL;
+    sched.counted_cycles[0] = 1000000000000ULL;
+    sched.total_cycles = 7000000000001ULL;
+    check("large scaled count", 0, pmu_sched_scaled_count(&sched, 0), 21000000000003ULL);
+    printf("ok large totals \n");
+
+    printf("%s \n", failures ? "FAILED" : "PASSED");
+
+    return failures ? 1 : 0;
+}
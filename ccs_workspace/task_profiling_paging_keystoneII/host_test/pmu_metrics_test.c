@@ -0,0 +1,172 @@
+/*--------------------------- pmu_metrics_test.c -------------------------
+ |  File pmu_metrics_test.c
+ |
+ |  Description: Host test of the derived metrics (arm0/pmu_metrics.c).
+ |               The fixed-point metrics of runs with known counts are
+ |               checked (truncated to the thousandth), including ACOR
+ |               and row hit ratio, the metrics whose events were not
+ |               counted or whose denominator is 0 must be reported as
+ |               invalid, and the min/mean/max statistics and their
+ |               printed summary are checked over a few runs.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "pmu_metrics.h"
+
+// Default events of the paging project: instructions, L1D refill/access, L2D access/refill, bus access
+static const unsigned events[PMU_NB_EVT_COUNTERS] = {0x08, 0x03, 0x04, 0x16, 0x17, 0x19};
+
+static unsigned failures = 0;
+
+// Last line written by the statistics
+static char printed[8][160];
+static unsigned nb_printed;
+
+
+static void check(const char* name, unsigned long long value, unsigned long long expected){
+    if(value != expected){
+        printf("FAIL %s: %llu (expected %llu) \n", name, value, expected);
+        failures++;
+    }
+}
+
+
+static void check_valid(const char* name, unsigned valid, unsigned metric, int expected){
+    if(((valid >> metric) & 1) != (unsigned)expected){
+        printf("FAIL %s: metric %u %s \n", name, metric, expected ? "invalid" : "valid");
+        failures++;
+    }
+}
+
+
+static void capture(char* line){
+    if(nb_printed < 8)
+        strcpy(printed[nb_printed], line);
+    nb_printed++;
+}
+
+
+// Run of the default events with the given counts
+static void set_run(struct pmu_metrics_input* input, unsigned long long cycles, unsigned long long instructions, unsigned long long emif_accesses,
+                    unsigned long long emif_activates, unsigned long long emif_cycles){
+    unsigned i;
+
+    input->cycles = cycles;
+    input->event_ids = events;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        input->evt[i] = 0;
+    input->evt[0] = instructions;
+    input->emif_accesses = emif_accesses;
+    input->emif_activates = emif_activates;
+    input->emif_cycles = emif_cycles;
+}
+
+
+int main(void){
+    struct pmu_metrics_input input;
+    struct pmu_metrics_stats stats;
+    unsigned long long metrics[PMU_NB_METRICS];
+    unsigned valid, i;
+
+    // Every metric but the branch MPKI (0x10 not counted)
+    set_run(&input, 3000, 2000, 700, 300, 4000);
+    input.evt[1] = 1;        // L1D refills
+    input.evt[2] = 3;        // L1D accesses
+    input.evt[3] = 200;      // L2D accesses
+    input.evt[4] = 50;       // L2D refills
+    input.evt[5] = 7;        // Bus accesses
+    valid = pmu_metrics_compute(&input, metrics);
+    check("ipc", metrics[PMU_METRIC_IPC], 666);
+    check("l1d refill ratio", metrics[PMU_METRIC_L1D_REFILL_RATIO], 333);
+    check("l2 refill ratio", metrics[PMU_METRIC_L2_REFILL_RATIO], 250);
+    check("l2 mpki", metrics[PMU_METRIC_L2_MPKI], 25000);
+    check("bus per kcycle", metrics[PMU_METRIC_BUS_PER_KCYCLE], 2333);
+    check("emif act ratio", metrics[PMU_METRIC_EMIF_ACT_RATIO], 428);
+    check("emif utilization", metrics[PMU_METRIC_EMIF_UTILIZATION], 175);
+    check("acor", metrics[PMU_METRIC_ACOR], 2333);
+    check("row hit ratio", metrics[PMU_METRIC_ROW_HIT_RATIO], 571);
+    check("row switches", metrics[PMU_METRIC_ROW_SWITCHES], 300000);
+    check("valid mask", valid, ((1u << PMU_NB_METRICS) - 1) & ~(1u << PMU_METRIC_BRANCH_MPKI));
+    printf("ok metrics of a run: ipc %llu, acor %llu, row hit ratio %llu \n", metrics[PMU_METRIC_IPC], metrics[PMU_METRIC_ACOR], metrics[PMU_METRIC_ROW_HIT_RATIO]);
+
+    // Counts whose product with the scale overflows 64 bits: the two-step division keeps them exact
+    set_run(&input, 3, 0xFFFFFFFFFFFFFFFFULL / 2, 0, 0, 0);
+    pmu_metrics_compute(&input, metrics);
+    check("large ipc", metrics[PMU_METRIC_IPC], (0xFFFFFFFFFFFFFFFFULL / 2 / 3) * 1000 + (((0xFFFFFFFFFFFFFFFFULL / 2) % 3) * 1000) / 3);
+
+    // Zero denominators: no cycle, no instruction, no L1D or L2D access, no EMIF access, no activate, no EMIF timer
+    set_run(&input, 0, 0, 0, 0, 0);
+    input.evt[1] = 5;
+    input.evt[4] = 5;
+    input.evt[5] = 5;
+    valid = pmu_metrics_compute(&input, metrics);
+    for(i = 0; i < PMU_NB_METRICS; i++)
+        check_valid("zero denominators", valid, i, 0);
+    for(i = 0; i < PMU_NB_METRICS; i++)
+        check("zero denominators value", metrics[i], 0);
+
+    // Accesses without activates: ACOR invalid, row hit ratio 1. Refreshes: more activates than accesses, row hit ratio 0
+    set_run(&input, 1000, 1000, 100, 0, 500);
+    valid = pmu_metrics_compute(&input, metrics);
+    check_valid("no activate", valid, PMU_METRIC_ACOR, 0);
+    check_valid("no activate", valid, PMU_METRIC_EMIF_ACT_RATIO, 1);
+    check("no activate row hit ratio", metrics[PMU_METRIC_ROW_HIT_RATIO], 1000);
+    check("no activate row switches", metrics[PMU_METRIC_ROW_SWITCHES], 0);
+    set_run(&input, 1000, 1000, 10, 12, 500);
+    pmu_metrics_compute(&input, metrics);
+    check("refresh row hit ratio", metrics[PMU_METRIC_ROW_HIT_RATIO], 0);
+
+    // EMIFs not measured (timer 0): no row switches. No event list: only the EMIF metrics
+    set_run(&input, 1000, 1000, 100, 50, 0);
+    valid = pmu_metrics_compute(&input, metrics);
+    check_valid("emif not measured", valid, PMU_METRIC_ROW_SWITCHES, 0);
+    check_valid("emif not measured", valid, PMU_METRIC_EMIF_UTILIZATION, 0);
+    input.event_ids = NULL;
+    valid = pmu_metrics_compute(&input, metrics);
+    check("no event list", valid, (1u << PMU_METRIC_EMIF_ACT_RATIO) | (1u << PMU_METRIC_ACOR) | (1u << PMU_METRIC_ROW_HIT_RATIO));
+
+    // Speculatively executed instructions as a proxy of the instructions
+    set_run(&input, 1000, 1500, 0, 0, 0);
+    input.event_ids = (const unsigned[PMU_NB_EVT_COUNTERS]){0x1B, 0x03, 0x04, 0x16, 0x17, 0x19};
+    valid = pmu_metrics_compute(&input, metrics);
+    check("speculative ipc", metrics[PMU_METRIC_IPC], 1500);
+    printf("ok invalid metrics \n");
+
+    // Statistics: min, truncated mean and max over three runs, runs where a metric is invalid not counted
+    pmu_metrics_stats_reset(&stats, "bench");
+    set_run(&input, 1000, 1000, 300, 100, 1000);
+    pmu_metrics_stats_add(&stats, &input);
+    set_run(&input, 1000, 2000, 300, 200, 1000);
+    pmu_metrics_stats_add(&stats, &input);
+    set_run(&input, 1000, 1001, 0, 0, 1000);
+    pmu_metrics_stats_add(&stats, &input);
+    check("ipc runs", stats.nb_runs[PMU_METRIC_IPC], 3);
+    check("ipc min", stats.min[PMU_METRIC_IPC], 1000);
+    check("ipc max", stats.max[PMU_METRIC_IPC], 2000);
+    check("ipc sum", stats.sum[PMU_METRIC_IPC], 4001);
+    check("acor runs", stats.nb_runs[PMU_METRIC_ACOR], 2);
+    check("acor min", stats.min[PMU_METRIC_ACOR], 1500);
+    check("acor max", stats.max[PMU_METRIC_ACOR], 3000);
+
+    nb_printed = 0;
+    pmu_metrics_stats_print_mask(&stats, (1u << PMU_METRIC_IPC) | PMU_METRICS_ROW_LOCALITY, capture);
+    check("printed lines", nb_printed, 4);
+    if(strcmp(printed[0], "bench ipc 3 1.000 1.333 2.000 \n\r") != 0 || strcmp(printed[1], "bench acor 2 1.500 2.250 3.000 \n\r") != 0){
+        printf("FAIL printed summary: %s%s", printed[0], printed[1]);
+        failures++;
+    }
+
+    // Reset: nothing printed
+    pmu_metrics_stats_reset(&stats, "bench");
+    nb_printed = 0;
+    pmu_metrics_stats_print(&stats, capture);
+    check("printed lines after reset", nb_printed, 0);
+    printf("ok statistics \n");
+
+    printf("%s \n", failures ? "FAILED" : "PASSED");
+
+    return failures ? 1 : 0;
+}
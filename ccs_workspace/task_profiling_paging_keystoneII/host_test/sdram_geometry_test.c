@@ -0,0 +1,117 @@
+/*--------------------------- sdram_geometry_test.c ----------------------
+ |  File sdram_geometry_test.c
+ |
+ |  Description: Host test of the SDRAM geometry decoder
+ |               (arm0/sdram_geometry.h). SDCFG values recorded on the
+ |               boards are decoded and checked against the geometry of
+ |               their devices, addresses go through sdram_decode then
+ |               sdram_encode and must come back unchanged (bus bytes
+ |               dropped), and the first page coloring bit of the
+ |               Keystone II configuration must be the one of the paging
+ |               project (bit 14).
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "sdram_geometry.h"
+
+// Recorded SDCFG values: K2 DDR3A (2 ranks, 8 banks, 1024 columns, 64-bit bus) and AM5728 EMIF1 (8 banks, 1024 columns, 32-bit bus)
+#define K2_SDCFG 0x6200CE6A
+#define K2_DDR3A_BASE 0x800000000ULL
+#define AM5728_SDCFG 0x61851B32
+#define AM5728_EMIF_BASE 0x80000000ULL
+
+// Expected geometry: bits of the bus bytes, column, bank, row and chip select, then bank bits right above the column
+struct expected_geometry{
+    unsigned bus_bits;
+    unsigned column_bits;
+    unsigned bank_bits;
+    unsigned row_bits;
+    unsigned chip_bits;
+    unsigned bank_low_bits;
+};
+
+static unsigned failures = 0;
+
+
+static void check(const char* name, long long value, long long expected){
+    if(value != expected){
+        printf("FAILED %s: %lld instead of %lld \n", name, value, expected);
+        failures++;
+    }
+}
+
+
+// Decodes a SDCFG value and checks every part of the geometry
+static void check_decode(const struct sdram_sdcfg_layout* layout, unsigned sdcfg, unsigned long long base,
+                         const struct expected_geometry* expected, struct sdram_geometry* geometry){
+    if(sdram_geometry_init(geometry, layout, sdcfg, base) < 0){
+        printf("FAILED %s: SDCFG 0x%08X not decoded \n", layout->name, sdcfg);
+        failures++;
+        return;
+    }
+
+    check("bus bits", geometry->bus_bits, expected->bus_bits);
+    check("column bits", geometry->column_bits, expected->column_bits);
+    check("bank bits", geometry->bank_bits, expected->bank_bits);
+    check("row bits", geometry->row_bits, expected->row_bits);
+    check("chip bits", geometry->chip_bits, expected->chip_bits);
+    check("bank low bits", geometry->bank_low_bits, expected->bank_low_bits);
+}
+
+
+// Addresses spread over the whole SDRAM (and every bit of each part) go through sdram_decode then sdram_encode
+static void check_round_trip(const struct sdram_geometry* geometry){
+    unsigned long long size = 1ULL << (geometry->chip_shift + geometry->chip_bits);
+    unsigned long long bus_mask = (1ULL << geometry->bus_bits) - 1;
+    unsigned long long offset, address;
+    struct sdram_location location, back;
+    unsigned bit;
+
+    for(bit = 0; (1ULL << bit) < size; bit++){
+        offset = (1ULL << bit) | ((0x9E3779B97F4A7C15ULL * (bit + 1)) & (size - 1));
+        address = geometry->base + offset;
+
+        sdram_decode(geometry, address, &location);
+        check("decode then encode", sdram_encode(geometry, &location), address & ~bus_mask);
+
+        sdram_decode(geometry, sdram_encode(geometry, &location), &back);
+        check("encode then decode (chip)", back.chip, location.chip);
+        check("encode then decode (bank)", back.bank, location.bank);
+        check("encode then decode (row)", back.row, location.row);
+        check("encode then decode (column)", back.column, location.column);
+    }
+
+    // Each bank of the last row of the last chip select
+    for(bit = 0; bit < (1u << geometry->bank_bits); bit++){
+        sdram_decode(geometry, sdram_bank_address(geometry, (1u << geometry->chip_bits) - 1, bit, (1u << geometry->row_bits) - 1), &location);
+        check("bank address (bank)", location.bank, bit);
+        check("bank address (row)", location.row, (1u << geometry->row_bits) - 1);
+        check("bank address (column)", location.column, 0);
+    }
+}
+
+
+int main(void){
+    const struct expected_geometry k2 = {3, 10, 3, 16, 1, 3};
+    const struct expected_geometry am5728 = {2, 10, 3, 15, 0, 3};
+    struct sdram_geometry geometry;
+
+    check_decode(&SDRAM_SDCFG_KEYSTONE2, K2_SDCFG, K2_DDR3A_BASE, &k2, &geometry);
+    check_round_trip(&geometry);
+    // Two partition bits of the paging project: bank bits 1 and 2, right below the row
+    check("K2 color bit", sdram_color_bit(&geometry, 2), 14);
+    check("K2 color bit over the bank bits", sdram_color_bit(&geometry, 4), -1);
+
+    check_decode(&SDRAM_SDCFG_AM5728, AM5728_SDCFG, AM5728_EMIF_BASE, &am5728, &geometry);
+    check_round_trip(&geometry);
+
+    // Reserved encodings: quarter bus on the K2 (NARROW_MODE = 3), 16 banks on the AM5728 (IBANK = 4)
+    check("K2 reserved NARROW_MODE", sdram_geometry_init(&geometry, &SDRAM_SDCFG_KEYSTONE2, K2_SDCFG | (3u << 12), K2_DDR3A_BASE), -1);
+    check("AM5728 reserved IBANK", sdram_geometry_init(&geometry, &SDRAM_SDCFG_AM5728, (AM5728_SDCFG & ~(7u << 4)) | (4u << 4), AM5728_EMIF_BASE), -1);
+
+    printf("%s \n", failures ? "FAILED" : "PASSED");
+
+    return failures ? 1 : 0;
+}
@@ -10,7 +10,7 @@
  |                for analyzing the effect of different
  |                benchmarks on the system.
  |
- |  Version: 1.1V
+ |  Version: 1.4V
  |
  | Contact:
  | alfonso.mascarenas-gonzalez@isae-supaero.fr
@@ -29,6 +29,8 @@
 #include "PMH.h"
 #include "UART.h"
 #include "DDR3MemoryController.h"
+#include "emif_driver.h"
+#include "emif_interleave.h"
 
 
 /* ----------------------- GLOBAL FUNCTIONS --------------------------- */
@@ -91,10 +93,18 @@ void set_MPU_MA(unsigned priority);
 
 // ARM performance counter final read variables
 unsigned long value0f = 0, value1f = 0, value2f = 0, value3f = 0, value4f = 0, value5f = 0, valueCf = 0;
-// EMIF0 performance counters initial and final read variables
-unsigned t1_ddr_cycles_emif0,t2_ddr_cycles_emif0, result_ddr_cycles_emif0, t1_ddr_evt0_emif0, t2_ddr_evt0_emif0, result_ddr_evt0_emif0, t1_ddr_evt1_emif0, t2_ddr_evt1_emif0, result_ddr_evt1_emif0;
-// EMIF1 performance counters initial and final read variables
-unsigned t1_ddr_cycles_emif1,t2_ddr_cycles_emif1, result_ddr_cycles_emif1, t1_ddr_evt0_emif1, t2_ddr_evt0_emif1, result_ddr_evt0_emif1, t1_ddr_evt1_emif1 ,t2_ddr_evt1_emif1, result_ddr_evt1_emif1;
+// EMIF0 performance counters results
+unsigned result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0;
+// EMIF1 performance counters results
+unsigned result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1;
+// EMIF0 timer cycles between the first and the last read of a snapshot (largest of the two snapshots)
+unsigned result_ddr_skew;
+
+// Both EMIFs, read back-to-back
+struct emif_bus emif_bus_am5728 = {2, {{(volatile unsigned char*)EMIF_AM5728_EMIF1_ADDRESS, &EMIF_REGMAP_AM5728},
+                                       {(volatile unsigned char*)EMIF_AM5728_EMIF2_ADDRESS, &EMIF_REGMAP_AM5728}}};
+// Initial and final snapshots
+struct emif_snapshot ddr_begin, ddr_end;
 
 // Addresses to different DDR3 memory banks
 const unsigned DDR_BANK_0 = 0xC8012000;
@@ -102,6 +112,17 @@ const unsigned DDR_BANK_1 = 0xC8014000;
 const unsigned DDR_BANK_2 = 0xC8016000;
 const unsigned DDR_BANK_3 = 0xC8018000;
 
+// EMIF interleaving balance of stride kernels after the benchmarks. 0 = disabled, 1 = enabled
+#define EMIF_INTERLEAVE_ANALYSIS 0
+// Buffer walked by the stride kernels (DDR1, not used by the linker script)
+#define INTERLEAVE_BUFFER_ADDRESS 0xC9000000
+#define INTERLEAVE_BUFFER_SIZE (4*1024*1024)
+// Strides (bytes) and placement offsets of the buffer
+const unsigned INTERLEAVE_STRIDES[] = {64, 128, 256, 512, 1024, 2048, 4096, 8192};
+const unsigned INTERLEAVE_OFFSETS[] = {0, 64, 128, 256, 512};
+#define NB_INTERLEAVE_STRIDES (sizeof(INTERLEAVE_STRIDES)/sizeof(INTERLEAVE_STRIDES[0]))
+#define NB_INTERLEAVE_OFFSETS (sizeof(INTERLEAVE_OFFSETS)/sizeof(INTERLEAVE_OFFSETS[0]))
+
 
 /* ========================================================================== */
 /*                   Internal Function Declarations                           */
@@ -168,7 +189,7 @@ int main(void)
 
 
     // Intended for no data caches implementation
-    write_UART_THR("Store burst on DDR SDRAM bank 0: Utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
+    write_UART_THR("Store burst on DDR SDRAM bank 0: Utilization time (cycles), number of accesses and actives for both EMIFs, then the snapshot skew \n\r");
 
     for(i=0; i < MAX_ITERATIONS; i++){
         DDR_start_eval();
@@ -176,7 +197,7 @@ int main(void)
         __asm__ __volatile("dsb");
         DDR_end_eval();
 
-        sprintf(data_str, "%u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1);
+        sprintf(data_str, "%u %u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1, result_ddr_skew);
         write_UART_THR(data_str);
     }
 
@@ -196,7 +217,7 @@ int main(void)
     }
 
     // Intended for no data caches implementation
-    write_UART_THR("Load burst on DDR SDRAM bank 0: Utilization time (cycles), number of accesses and actives \n\r");
+    write_UART_THR("Load burst on DDR SDRAM bank 0: Utilization time (cycles), number of accesses and actives, then the snapshot skew \n\r");
 
     for(i=0; i < MAX_ITERATIONS; i++){
         DDR_start_eval();
@@ -204,7 +225,7 @@ int main(void)
         __asm__ __volatile("dsb");
         DDR_end_eval();
 
-        sprintf(data_str, "%u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1);
+        sprintf(data_str, "%u %u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1, result_ddr_skew);
         write_UART_THR(data_str);
     }
 
@@ -224,7 +245,7 @@ int main(void)
     }
 
     // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("Pointer chasing cache stress: Utilization time (cycles), number of accesses and actives for both EMIFs \n\r");
+    write_UART_THR("Pointer chasing cache stress: Utilization time (cycles), number of accesses and actives for both EMIFs, then the snapshot skew \n\r");
 
     for(i=0; i < MAX_ITERATIONS; i++){
         DDR_start_eval();
@@ -232,7 +253,7 @@ int main(void)
         __asm__ __volatile("dsb");
         DDR_end_eval();
 
-        sprintf(data_str, "%u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1);
+        sprintf(data_str, "%u %u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1, result_ddr_skew);
         write_UART_THR(data_str);
     }
 
@@ -254,7 +275,7 @@ int main(void)
     }
 
     // Intended especially for data caches implementation but also useful for the without data caches implementation
-    write_UART_THR("System stress matrix: Utilization time (cycles), number of accesses and actives for both EMIFs\n\r");
+    write_UART_THR("System stress matrix: Utilization time (cycles), number of accesses and actives for both EMIFs, then the snapshot skew \n\r");
 
     for(i=0; i < MAX_ITERATIONS; i++){
         DDR_start_eval();
@@ -262,7 +283,19 @@ int main(void)
         __asm__ __volatile("dsb");
         DDR_end_eval();
 
-        sprintf(data_str, "%u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1);
+        sprintf(data_str, "%u %u %u %u %u %u %u %u\n\r", i, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1, result_ddr_skew);
+        write_UART_THR(data_str);
+    }
+
+
+    if(EMIF_INTERLEAVE_ANALYSIS){
+        // Data caches disabled (ARM_INIT_CONFIGURATION 0): every access of the kernels reaches the EMIFs
+        write_UART_THR("EMIF interleaving: offset, stride, words accessed, then for both EMIFs access and activate shares (per mille) and accesses per 1000 EMIF cycles, balance \n\r");
+
+        i = emif_interleave_sweep(&emif_bus_am5728, (volatile unsigned char*)INTERLEAVE_BUFFER_ADDRESS, INTERLEAVE_BUFFER_SIZE, INTERLEAVE_OFFSETS, NB_INTERLEAVE_OFFSETS,
+                                  INTERLEAVE_STRIDES, NB_INTERLEAVE_STRIDES, NULL, write_UART_THR);
+
+        sprintf(data_str, "%u imbalanced runs \n\r", i);
         write_UART_THR(data_str);
     }
 
@@ -543,7 +576,7 @@ void DDR_configure_eval(unsigned filter_events){
 
 /* DDR_start_eval
  *
- * Description: Reads both EMIFs performance counters for the first time.
+ * Description: Reads both EMIFs performance counters for the first time, back-to-back.
  *
  * Parameter:   None
  *
@@ -551,13 +584,7 @@ void DDR_configure_eval(unsigned filter_events){
  *
  * */
 void DDR_start_eval(){
-    t1_ddr_evt0_emif0 = get_PERF_CNT_1(0);
-    t1_ddr_evt1_emif0 = get_PERF_CNT_2(0);
-    t1_ddr_cycles_emif0 = get_PERF_CNT_TIMER(0);
-
-    t1_ddr_evt0_emif1 = get_PERF_CNT_1(1);
-    t1_ddr_evt1_emif1 = get_PERF_CNT_2(1);
-    t1_ddr_cycles_emif1 = get_PERF_CNT_TIMER(1);
+    emif_bus_snapshot(&emif_bus_am5728, &ddr_begin);
 }
 
 /* DDR_end_eval
@@ -570,22 +597,17 @@ void DDR_start_eval(){
  *
  * */
 void DDR_end_eval(){
-    t2_ddr_evt0_emif0 = get_PERF_CNT_1(0);
-    t2_ddr_evt1_emif0 = get_PERF_CNT_2(0);
-    t2_ddr_cycles_emif0 = get_PERF_CNT_TIMER(0);
-
-    t2_ddr_evt0_emif1 = get_PERF_CNT_1(1);
-    t2_ddr_evt1_emif1 = get_PERF_CNT_2(1);
-    t2_ddr_cycles_emif1 = get_PERF_CNT_TIMER(1);
+    emif_bus_snapshot(&emif_bus_am5728, &ddr_end);
 
-    result_ddr_cycles_emif0 = t2_ddr_cycles_emif0 - t1_ddr_cycles_emif0;
-    result_ddr_evt0_emif0 = t2_ddr_evt0_emif0 - t1_ddr_evt0_emif0;
-    result_ddr_evt1_emif0 = t2_ddr_evt1_emif0 - t1_ddr_evt1_emif0;
+    result_ddr_cycles_emif0 = ddr_end.cycles[0] - ddr_begin.cycles[0];
+    result_ddr_evt0_emif0 = ddr_end.evt[0][0] - ddr_begin.evt[0][0];
+    result_ddr_evt1_emif0 = ddr_end.evt[0][1] - ddr_begin.evt[0][1];
 
-    result_ddr_cycles_emif1 = t2_ddr_cycles_emif1 - t1_ddr_cycles_emif1;
-    result_ddr_evt0_emif1 = t2_ddr_evt0_emif1 - t1_ddr_evt0_emif1;
-    result_ddr_evt1_emif1 = t2_ddr_evt1_emif1 - t1_ddr_evt1_emif1;
+    result_ddr_cycles_emif1 = ddr_end.cycles[1] - ddr_begin.cycles[1];
+    result_ddr_evt0_emif1 = ddr_end.evt[1][0] - ddr_begin.evt[1][0];
+    result_ddr_evt1_emif1 = ddr_end.evt[1][1] - ddr_begin.evt[1][1];
 
+    result_ddr_skew = (ddr_begin.skew > ddr_end.skew) ? ddr_begin.skew : ddr_end.skew;
 }
 
 
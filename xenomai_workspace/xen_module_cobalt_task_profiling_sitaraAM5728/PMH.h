@@ -288,3 +288,64 @@ static inline void clear_overflows() {
 	__asm__ __volatile("MRC p15, 0, %0, c9, c12, 3" : "=r"(value));
 	__asm__ __volatile("MCR p15, 0, %0, c9, c12, 3" :: "r"((value & PMOVSR_MASK) | 0x8000003F));
 }
+
+/* clear_counters_overflow
+ *
+ * Description: Clears only the given counters overflows flags (MSB = Counter cycle overflow), so that
+ *              an overflow raised after the flags were read is not lost
+ *
+ * Parameter:
+ *              - unsigned int flags: Overflow flags to clear, as returned by read_counters_overflow
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void clear_counters_overflow(unsigned int flags)  {
+	__asm__ __volatile("MCR p15, 0, %0, c9, c12, 3" :: "r"(flags & 0x8000003F));
+}
+
+
+/* read_all_counters
+ *
+ * Description: Reads the Cycle Counter Register (CCNT) and the six event counters in a single and fixed
+ *              instruction sequence (PMSELR write immediately followed by its PMXEVCNTR read), so that the
+ *              probe cost is the same for every sample and can be calibrated away.
+ *              The cycle counter is read first since it is the most sensitive one to the probe cost.
+ *
+ * Parameter:
+ *              - unsigned* cycles: Where the cycle counter value is written
+ *              - unsigned* evt: Array of six elements where the event counters 0 to 5 values are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void read_all_counters(unsigned* cycles, unsigned* evt)  {
+   unsigned int c, e0, e1, e2, e3, e4, e5, sel;
+
+   __asm__ __volatile("MRC p15, 0, %[c], c9, c13, 0  \n\t"
+                      "MOV %[sel], #0               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e0], c9, c13, 2 \n\t"
+                      "MOV %[sel], #1               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e1], c9, c13, 2 \n\t"
+                      "MOV %[sel], #2               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e2], c9, c13, 2 \n\t"
+                      "MOV %[sel], #3               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e3], c9, c13, 2 \n\t"
+                      "MOV %[sel], #4               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e4], c9, c13, 2 \n\t"
+                      "MOV %[sel], #5               \n\t"
+                      "MCR p15, 0, %[sel], c9, c12, 5 \n\t"
+                      "MRC p15, 0, %[e5], c9, c13, 2 \n\t"
+                      : [c] "=&r" (c), [e0] "=&r" (e0), [e1] "=&r" (e1), [e2] "=&r" (e2),
+                        [e3] "=&r" (e3), [e4] "=&r" (e4), [e5] "=&r" (e5), [sel] "=&r" (sel)
+                      );
+
+   *cycles = c;
+   evt[0] = e0; evt[1] = e1; evt[2] = e2;
+   evt[3] = e3; evt[4] = e4; evt[5] = e5;
+}
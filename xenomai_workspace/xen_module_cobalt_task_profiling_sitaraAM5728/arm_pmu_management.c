@@ -1,16 +1,23 @@
-/*--------------------------- arm_pmu_management.h ------------------------
+/*--------------------------- arm_pmu_management.c ------------------------
  |  File arm_pmu_management.c
  |
  |  Description: The functions definition for the ARMv7 PMU management
  |               are done here
  |
- |  Version: 1.1
+ |  Version: 1.8
  *-----------------------------------------------------------------------*/
 
 #include <stdio.h>
-#include "PMH.h"
 #include "arm_pmu_management.h"
 
+#if PMU_BACKEND == PMU_BACKEND_ARMV7
+#include "PMH.h"
+#elif PMU_BACKEND == PMU_BACKEND_PERF_EVENT
+#include "pmu_perf_event.h"
+#else
+#error "Unknown PMU_BACKEND"
+#endif
+
 
 // ARM performance counter ID to use
 #define COUNTER_ID_0 0x0
@@ -50,61 +57,48 @@
 #define EVENT_ID_5   0x10
 
 
-// ARM performance counter final read variables
-unsigned value0f = 0, value1f = 0, value2f = 0, value3f = 0, value4f = 0, value5f = 0, valueCf = 0;
+// ARM performance counter final read variables (extended to 64 bits through the overflow flags)
+unsigned long long value0f = 0, value1f = 0, value2f = 0, value3f = 0, value4f = 0, value5f = 0, valueCf = 0;
 
+// Events tracked by counters 0 to 5
+const unsigned counters_event_ids[PMU_NB_EVT_COUNTERS] = {EVENT_ID_0, EVENT_ID_1, EVENT_ID_2, EVENT_ID_3, EVENT_ID_4, EVENT_ID_5};
 
-void counters_init(){
-    // Select counter to program: counter_number can be between 0-5
-    select_evt_counter(COUNTER_ID_0);
+// Probe cost, zero until counters_calibrate is called
+struct pmu_snapshot pmu_overhead;
+
+// Counters wraps since the last critical_task_start_eval (upper parts of the 64-bit counts with the perf_event backend)
+static struct pmu_wrap_tracker pmu_wraps;
 
-    // Select event to track in selected counter: event_id numbers are in the ARM  TRM
-    event_track(EVENT_ID_0);
 
-    select_evt_counter(COUNTER_ID_1);
-    event_track(EVENT_ID_1);
+#if PMU_BACKEND == PMU_BACKEND_ARMV7
 
-    select_evt_counter(COUNTER_ID_2);
-    event_track(EVENT_ID_2);
+static int armv7_init(const unsigned* events, unsigned nb_events){
+    unsigned i;
 
-    select_evt_counter(COUNTER_ID_3);
-    event_track(EVENT_ID_3);
+    if(nb_events > PMU_NB_EVT_COUNTERS)
+        return -1;
 
-    select_evt_counter(COUNTER_ID_4);
-    event_track(EVENT_ID_4);
+    for(i = 0; i < nb_events; i++){
+        // Select counter to program: counter_number can be between 0-5
+        select_evt_counter(i);
 
-    select_evt_counter(COUNTER_ID_5);
-    event_track(EVENT_ID_5);
+        // Select event to track in selected counter: event_id numbers are in the ARM  TRM
+        event_track(events[i]);
+    }
 
+    return 0;
 }
 
 
-void critical_task_start_eval(){
+static void armv7_start(){
 
     // Clear possible overflows of every counter
     clear_overflows();
-
-    // Select counter to program: counter_number can be between 0-5
-//    select_evt_counter(COUNTER_ID_0);
+    pmu_wrap_reset(&pmu_wraps);
 
     // Reset the actual value and enables of the counter and don't enable the don't enable the divider
     reset_all_counters(0);
 
-//    select_evt_counter(COUNTER_ID_1);
-//    reset_all_counters(0);
-
-//    select_evt_counter(COUNTER_ID_2);
-//    reset_all_counters(0);
-
-//    select_evt_counter(COUNTER_ID_3);
-//    reset_all_counters(0);
-
-//    select_evt_counter(COUNTER_ID_4);
-//    reset_all_counters(0);
-
-//    select_evt_counter(COUNTER_ID_5);
-//    reset_all_counters(0);
-
     // Synchronize context (Instruction Synchronization Barrier)
     __asm__ __volatile("isb");
 
@@ -114,44 +108,113 @@ void critical_task_start_eval(){
 }
 
 
-void critical_task_end_eval(){
+static void armv7_stop(struct pmu_snapshot* snapshot){
 
     // Disable counters
     disable_all_counters(0x3F);
 
-    // Select general performance counter to read from
-    select_evt_counter(COUNTER_ID_0);
+    // Read the cycle counter and the six event counters back-to-back
+    read_all_counters(&snapshot->cycles, snapshot->evt);
+}
+
+
+static void armv7_read(struct pmu_snapshot* snapshot){
+    read_all_counters(&snapshot->cycles, snapshot->evt);
+}
 
-    // Read value
-    value0f=read_evt_counter();
 
-    select_evt_counter(COUNTER_ID_1);
-    value1f=read_evt_counter();
+const struct pmu_counter_source pmu_armv7_source = {"armv7", armv7_init, armv7_start, armv7_stop, armv7_read};
 
-    select_evt_counter(COUNTER_ID_2);
-    value2f=read_evt_counter();
+const struct pmu_counter_source* const pmu_source = &pmu_armv7_source;
 
-    select_evt_counter(COUNTER_ID_3);
-    value3f=read_evt_counter();
+#else
 
-    select_evt_counter(COUNTER_ID_4);
-    value4f=read_evt_counter();
+const struct pmu_counter_source* const pmu_source = &pmu_perf_event_source;
 
-    select_evt_counter(COUNTER_ID_5);
-    value5f=read_evt_counter();
+#endif
 
-    // Read from the dedicated execution cycles performance counter
-    valueCf = read_cycle_counter();
 
+void counters_init(){
+    if(pmu_source->init(counters_event_ids, PMU_NB_EVT_COUNTERS) < 0)
+        printf("PMU backend %s could not be initialized \n", pmu_source->name);
+
+#if PMU_BACKEND == PMU_BACKEND_PERF_EVENT
+    printf("PMU backend %s (%s mode) \n", pmu_source->name, pmu_perf_event_mode());
+#endif
 }
 
 
-void print_pmu_results(unsigned id){
-    printf("%u %u %u %u %u %u %u %u \n\r", id, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
+void counters_calibrate(unsigned nb_runs){
+    pmu_calibrate(pmu_source, nb_runs, &pmu_overhead);
 }
 
 
+void critical_task_start_eval(){
+    pmu_source->start();
+}
+
+
+void critical_task_end_eval(){
+    struct pmu_snapshot raw;
+    struct pmu_snapshot64 snapshot;
+
+    pmu_source->stop(&raw);
+
+#if PMU_BACKEND == PMU_BACKEND_ARMV7
+    unsigned flags;
+
+    // Counters are stopped: every pending overflow happened before the read
+    flags = read_counters_overflow();
+    pmu_wrap_account(&pmu_wraps, flags);
+    clear_counters_overflow(flags);
+#else
+    // The 32-bit snapshot is the lower part of the perf_event 64-bit counts
+    pmu_perf_event_wraps(&pmu_wraps);
+#endif
+
+    pmu_wrap_extend(&pmu_wraps, &raw, &snapshot);
+    pmu_subtract_overhead64(&snapshot, &pmu_overhead);
+
+    valueCf = snapshot.cycles;
+    value0f = snapshot.evt[COUNTER_ID_0];
+    value1f = snapshot.evt[COUNTER_ID_1];
+    value2f = snapshot.evt[COUNTER_ID_2];
+    value3f = snapshot.evt[COUNTER_ID_3];
+    value4f = snapshot.evt[COUNTER_ID_4];
+    value5f = snapshot.evt[COUNTER_ID_5];
+}
+
+
+void counters_poll_overflows(){
+#if PMU_BACKEND == PMU_BACKEND_ARMV7
+    struct pmu_snapshot raw;
+    unsigned flags;
 
+    // The flags must be read after the values
+    read_all_counters(&raw.cycles, raw.evt);
+    flags = read_counters_overflow();
+
+    clear_counters_overflow(pmu_wrap_poll(&pmu_wraps, flags, &raw));
+#endif
+}
 
 
+int counters_free_run(){
+#if PMU_BACKEND == PMU_BACKEND_ARMV7
+    armv7_init(counters_event_ids, PMU_NB_EVT_COUNTERS);
 
+    // No wrap accounting: only the increments of the free-running counters are used
+    reset_all_counters(0);
+    __asm__ __volatile("isb");
+    enable_all_counters(0x3F);
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+
+void print_pmu_results(unsigned id){
+    printf("%u %llu %llu %llu %llu %llu %llu %llu \n\r", id, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
+}
@@ -2,11 +2,45 @@
  |  File arm_pmu_management.h
  |
  |  Description: The functions declaration for the ARMv7 PMU management
- |               are done here
+ |               are done here.
+ |               Two backends are available, selected at build time with
+ |               -DPMU_BACKEND=...:
+ |                - PMU_BACKEND_ARMV7 (default): direct access to the PMU
+ |                  registers, requires the user_enable_pmu module,
+ |                - PMU_BACKEND_PERF_EVENT: Linux perf_event, no module
+ |                  required and runs on any Linux machine (e.g., x86).
  |
- |  Version: 1.0 
+ |  Version: 1.7
  *-----------------------------------------------------------------------*/
 
+#include "pmu_counter_source.h"
+#include "pmu_counter64.h"
+
+// Counter backends
+#define PMU_BACKEND_ARMV7       0
+#define PMU_BACKEND_PERF_EVENT  1
+
+#ifndef PMU_BACKEND
+#define PMU_BACKEND PMU_BACKEND_ARMV7
+#endif
+
+// ARM performance counter final read variables (extended to 64 bits through the overflow flags)
+extern unsigned long long value0f, value1f, value2f, value3f, value4f, value5f, valueCf;
+
+// ARM Cortex A15 events tracked by counters 0 to 5
+extern const unsigned counters_event_ids[PMU_NB_EVT_COUNTERS];
+
+// Probe cost measured by counters_calibrate and removed from every measurement
+extern struct pmu_snapshot pmu_overhead;
+
+#if PMU_BACKEND == PMU_BACKEND_ARMV7
+// ARMv7 PMU implementation of the counter source
+extern const struct pmu_counter_source pmu_armv7_source;
+#endif
+
+// Counter source of the selected backend
+extern const struct pmu_counter_source* const pmu_source;
+
 
 /* counters_init
  *
@@ -20,6 +54,21 @@
 void counters_init();
 
 
+/* counters_calibrate
+ *
+ * Description: Measures the probe cost through empty start/stop pairs. From then on,
+ *              critical_task_end_eval subtracts it from every value read.
+ *              To be called once at start-up, after counters_init.
+ *
+ * Parameter:
+ *		- unsigned nb_runs: the number of empty start/stop pairs measured
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_calibrate(unsigned nb_runs);
+
+
 /* critical_task_start_eval
  *
  * Description: Prepares the performance counters for its use by:
@@ -37,7 +86,8 @@ void critical_task_start_eval();
 
 /* critical_task_end_eval
  *
- * Description: Deactivates all performance counters at once and reads the event values for each of them
+ * Description: Deactivates all performance counters at once, reads the event values for each of them
+ *              in a single pass and removes the calibrated probe cost
  *
  * Parameter:   None
  *
@@ -47,6 +97,40 @@ void critical_task_start_eval();
 void critical_task_end_eval();
 
 
+/* counters_poll_overflows
+ *
+ * Description: Accounts the counters overflows while the counters are running.
+ *              Does nothing with the perf_event backend, whose 64-bit counts are extended by
+ *              critical_task_end_eval (pmu_perf_event_wraps).
+ *              Needed only for measurements where a counter may wrap more than once
+ *              (i.e., more than 2^32 events); calling it at least once every 2^31
+ *              events keeps the 64-bit values exact. The overflow interrupt is not
+ *              available from User mode, hence the polling: thread0 polls at the phase
+ *              boundaries of its task when PMU_OVERFLOW_POLLING is set, the cost of the
+ *              poll being then part of every measured run.
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void counters_poll_overflows();
+
+
+/* counters_free_run
+ *
+ * Description: Programs the events on the core of the calling thread and lets its counters run freely,
+ *              for a thread which only publishes its counters to another one (e.g., an aggressor).
+ *              Only available with the ARMv7 backend: the perf_event counters belong to a single thread.
+ *
+ * Parameter:   None
+ *
+ * Returns:     0 on success, -1 if not available
+ *
+ * */
+int counters_free_run();
+
+
 /* print_pmu_results
  *
  * Description: Prints the results for the chosen events
@@ -0,0 +1,153 @@
+/*--------------------------- cache_state_management.c -------------------
+ |  File cache_state_management.c
+ |
+ |  Description: The functions definition for the Linux cache state
+ |               management are done here. The caches cannot be
+ |               invalidated by set/way from User mode: they are emptied
+ |               by walking an eviction buffer sized from the cache
+ |               geometry given by sysfs.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cache_state_management.h"
+
+// Cache geometry of the CPU 0 caches
+#define SYSFS_CACHE_PATH "/sys/devices/system/cpu/cpu0/cache"
+#define SYSFS_MAX_CACHE_INDEX 8
+
+// Defaults when sysfs does not give the geometry
+#define DEFAULT_CACHE_LINE_SIZE 64
+#define DEFAULT_LARGEST_CACHE_SIZE (2*1024*1024)
+
+
+// Eviction and pollution buffer
+static volatile unsigned char* pollution_buffer = NULL;
+static unsigned pollution_buffer_size = 0;
+static unsigned line_size = DEFAULT_CACHE_LINE_SIZE;
+
+
+// Reads a sysfs cache attribute of a cache index. Returns 0 on success
+static int read_cache_attribute(unsigned index, const char* attribute, char* value, unsigned length){
+    char path[128];
+    FILE* f;
+
+    snprintf(path, sizeof(path), "%s/index%u/%s", SYSFS_CACHE_PATH, index, attribute);
+    f = fopen(path, "r");
+    if(f == NULL)
+        return -1;
+
+    if(fgets(value, length, f) == NULL){
+        fclose(f);
+        return -1;
+    }
+
+    fclose(f);
+    return 0;
+}
+
+
+// Size in bytes of the largest data or unified cache, line size of the data caches. Returns 0 if none was found
+static unsigned largest_cache_size(unsigned* line){
+    char type[32], size[32], coherency[32];
+    unsigned index, bytes, largest = 0;
+    char unit;
+
+    for(index = 0; index < SYSFS_MAX_CACHE_INDEX; index++){
+        if(read_cache_attribute(index, "type", type, sizeof(type)) < 0)
+            break;
+        if(strncmp(type, "Instruction", 11) == 0)
+            continue;
+        if(read_cache_attribute(index, "size", size, sizeof(size)) < 0)
+            continue;
+
+        // e.g., "32K", "2048K", "16M"
+        unit = 0;
+        if(sscanf(size, "%u%c", &bytes, &unit) < 1)
+            continue;
+        if(unit == 'K')
+            bytes *= 1024;
+        else if(unit == 'M')
+            bytes *= 1024*1024;
+
+        if(bytes > largest)
+            largest = bytes;
+
+        if(read_cache_attribute(index, "coherency_line_size", coherency, sizeof(coherency)) == 0)
+            *line = (unsigned)strtoul(coherency, NULL, 10);
+    }
+
+    return largest;
+}
+
+
+int cache_state_init(void* buffer, unsigned size){
+    unsigned largest = largest_cache_size(&line_size);
+
+    if(line_size == 0)
+        line_size = DEFAULT_CACHE_LINE_SIZE;
+
+    if(buffer == NULL){
+        // Twice the largest cache, so that a walk evicts all of it whatever the replacement policy
+        if(size == 0)
+            size = 2 * (largest ? largest : DEFAULT_LARGEST_CACHE_SIZE);
+
+        buffer = malloc(size);
+        if(buffer == NULL)
+            return -1;
+        memset(buffer, 0, size);
+    }
+
+    pollution_buffer = (volatile unsigned char*)buffer;
+    pollution_buffer_size = size;
+
+    return 0;
+}
+
+
+void caches_clean_invalidate(){
+    unsigned i, sum = 0;
+
+    // Dirty lines of the task are written back when the buffer lines replace them, then the buffer lines are read back clean
+    caches_pollute(pollution_buffer_size);
+    for(i = 0; i < pollution_buffer_size; i += line_size)
+        sum += pollution_buffer[i];
+
+    (void)sum;
+}
+
+
+void caches_pollute(unsigned size){
+    unsigned i;
+
+    if(size > pollution_buffer_size)
+        size = pollution_buffer_size;
+
+    for(i = 0; i < size; i += line_size)
+        pollution_buffer[i] = (unsigned char)i;
+
+    __sync_synchronize();
+}
+
+
+void cache_state_prepare(const struct cache_state_policy* policy, void (*task)(void)){
+    switch(policy->state){
+        case CACHE_STATE_COLD:
+            caches_clean_invalidate();
+            break;
+
+        case CACHE_STATE_WARM:
+            task();
+            break;
+
+        case CACHE_STATE_POLLUTED:
+            caches_pollute(policy->pollution_size);
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,83 @@
+/*--------------------------- cache_state_management.h -------------------
+ |  File cache_state_management.h
+ |
+ |  Description: The functions declaration for setting a deterministic
+ |               cache state before each measured run are done here.
+ |               Back-to-back runs otherwise start with whatever the
+ |               previous run left in the caches.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef CACHE_STATE_MANAGEMENT_H_
+#define CACHE_STATE_MANAGEMENT_H_
+
+// Cache state before a measured run
+#define CACHE_STATE_AS_IS     0   // Nothing done, state left by the previous run
+#define CACHE_STATE_COLD      1   // Data caches cleaned and invalidated
+#define CACHE_STATE_WARM      2   // One discarded priming run of the task
+#define CACHE_STATE_POLLUTED  3   // Thrashing kernel run over pollution_size bytes
+
+// Cache state policy of a benchmark
+struct cache_state_policy{
+    unsigned state;
+
+    // Bytes written by the thrashing kernel (CACHE_STATE_POLLUTED), at most the size of the pollution buffer
+    unsigned pollution_size;
+};
+
+
+/* cache_state_init
+ *
+ * Description: Sets the buffer walked by the thrashing kernel (and, where the caches cannot be invalidated
+ *              directly, by the eviction of the cold state)
+ *
+ * Parameter:
+ *              - void* buffer: Pollution buffer (NULL: allocated, when the platform allows it)
+ *              - unsigned size: Size of the buffer in bytes (0 with a NULL buffer: computed from the cache geometry)
+ *
+ * Returns:     0 on success, -1 otherwise
+ *
+ * */
+int cache_state_init(void* buffer, unsigned size);
+
+
+/* caches_clean_invalidate
+ *
+ * Description: Writes back and drops every line of the data caches
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void caches_clean_invalidate();
+
+
+/* caches_pollute
+ *
+ * Description: Thrashing kernel: writes one word per cache line over a part of the pollution buffer
+ *
+ * Parameter:
+ *              - unsigned size: Number of bytes walked (clamped to the pollution buffer size)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void caches_pollute(unsigned size);
+
+
+/* cache_state_prepare
+ *
+ * Description: Sets the cache state of a policy right before a measured run (to be called before the counters are started)
+ *
+ * Parameter:
+ *              - const struct cache_state_policy* policy: Cache state policy of the benchmark
+ *              - void (*task)(void): The measured task, run once and discarded for CACHE_STATE_WARM
+ *
+ * Returns:     Nothing
+ *
+ * */
+void cache_state_prepare(const struct cache_state_policy* policy, void (*task)(void));
+
+#endif /* CACHE_STATE_MANAGEMENT_H_ */
@@ -0,0 +1,158 @@
+/*--------------------------- config_sweep.h -----------------------------
+ |  File config_sweep.h
+ |
+ |  Description: Design-space exploration of the memory controller and
+ |               interconnect settings. A knob is a setting (e.g., AXI
+ |               priority, PR_OLD_COUNT, RWTHRESH) with the values of the
+ |               grid and the function writing it; for every point of the
+ |               grid (every combination of values), the knobs are set,
+ |               the benchmark set is run and the worst and mean execution
+ |               times of each benchmark are kept. The points are then
+ |               ranked by the worst case of the critical benchmark.
+ |
+ |               Nothing here touches the hardware: the knobs and the
+ |               measurement are given by the caller, so the same driver
+ |               runs on the targets and on a host with simulated registers.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef CONFIG_SWEEP_H_
+#define CONFIG_SWEEP_H_
+
+// Maximum number of knobs, points of the grid and benchmarks of a sweep
+#define CONFIG_SWEEP_MAX_KNOBS 8
+#define CONFIG_SWEEP_MAX_POINTS 256
+#define CONFIG_SWEEP_MAX_BENCHMARKS 8
+
+// A controller or interconnect setting
+struct config_knob{
+    const char* name;
+
+    // Writes a value of the setting
+    void (*apply)(unsigned value);
+
+    // Values of the grid
+    const unsigned* values;
+    unsigned nb_values;
+};
+
+// Execution times of a benchmark at a point of the grid
+struct config_point_times{
+    unsigned runs;
+    unsigned long long wcet;
+    unsigned long long sum;
+};
+
+// Measures one run of a benchmark (given by its index) and returns its execution time
+typedef unsigned long long (*config_sweep_measure)(unsigned benchmark);
+
+struct config_sweep{
+    const struct config_knob* knobs;
+    unsigned nb_knobs;
+
+    // Benchmark names, and the benchmark whose worst case ranks the points
+    const char* const* benchmarks;
+    unsigned nb_benchmarks;
+    unsigned critical;
+
+    // Points of the grid (product of the numbers of values) and their execution times
+    unsigned nb_points;
+    struct config_point_times times[CONFIG_SWEEP_MAX_POINTS][CONFIG_SWEEP_MAX_BENCHMARKS];
+};
+
+
+/* config_sweep_init
+ *
+ * Description: Builds the grid of a sweep and clears its execution times
+ *
+ * Parameter:
+ *              - struct config_sweep* sweep: Sweep to initialize
+ *              - const struct config_knob* knobs: Settings of the grid
+ *              - unsigned nb_knobs: Number of settings (at most CONFIG_SWEEP_MAX_KNOBS)
+ *              - const char* const* benchmarks: Benchmark names
+ *              - unsigned nb_benchmarks: Number of benchmarks (at most CONFIG_SWEEP_MAX_BENCHMARKS)
+ *              - unsigned critical: Index of the benchmark ranking the points
+ *
+ * Returns:     0 on success, -1 if a knob has no value, or if there are too many knobs, benchmarks or points
+ *
+ * */
+int config_sweep_init(struct config_sweep* sweep, const struct config_knob* knobs, unsigned nb_knobs,
+                      const char* const* benchmarks, unsigned nb_benchmarks, unsigned critical);
+
+
+/* config_sweep_value
+ *
+ * Description: Value of a knob at a point of the grid (the last knob changes first)
+ *
+ * Parameter:
+ *              - const struct config_sweep* sweep: Sweep to use
+ *              - unsigned point: Point of the grid
+ *              - unsigned knob: Knob
+ *
+ * Returns:     The value
+ *
+ * */
+unsigned config_sweep_value(const struct config_sweep* sweep, unsigned point, unsigned knob);
+
+
+/* config_sweep_apply
+ *
+ * Description: Writes every knob with its value at a point of the grid, in the order of the knobs
+ *
+ * Parameter:
+ *              - const struct config_sweep* sweep: Sweep to use
+ *              - unsigned point: Point of the grid
+ *
+ * Returns:     Nothing
+ *
+ * */
+void config_sweep_apply(const struct config_sweep* sweep, unsigned point);
+
+
+/* config_sweep_record
+ *
+ * Description: Adds a run of a benchmark to a point of the grid
+ *
+ * Parameter:
+ *              - struct config_sweep* sweep: Sweep to use
+ *              - unsigned point: Point of the grid
+ *              - unsigned benchmark: Benchmark index
+ *              - unsigned long long time: Execution time of the run
+ *
+ * Returns:     Nothing
+ *
+ * */
+void config_sweep_record(struct config_sweep* sweep, unsigned point, unsigned benchmark, unsigned long long time);
+
+
+/* config_sweep_run
+ *
+ * Description: Sweep driver. For every point of the grid, sets the knobs then measures runs times each benchmark
+ *
+ * Parameter:
+ *              - struct config_sweep* sweep: Sweep to run
+ *              - config_sweep_measure measure: Measurement of a benchmark run
+ *              - unsigned runs: Runs of each benchmark per point
+ *
+ * Returns:     Nothing
+ *
+ * */
+void config_sweep_run(struct config_sweep* sweep, config_sweep_measure measure, unsigned runs);
+
+
+/* config_sweep_print
+ *
+ * Description: Writes the points ranked by the worst case, then the mean, of the critical benchmark:
+ *              "<rank> <knob>=<value> ... <benchmark> <wcet> <mean> ..."
+ *
+ * Parameter:
+ *              - const struct config_sweep* sweep: Sweep to print
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void config_sweep_print(const struct config_sweep* sweep, void (*write_line)(char* line));
+
+#endif /* CONFIG_SWEEP_H_ */
@@ -4,7 +4,7 @@
  |  Description: This file provides functions for managing the
  |  EMIFs on Sitara AM5728
  |
- |  Version: 2.2
+ |  Version: 2.4
  *-----------------------------------------------------------------------*/
 
 #ifndef DDR3MEMORYCONTROLLER_H_
@@ -137,7 +137,8 @@ void enable_CNT_MSTID(unsigned id,  void* emif_base_address){
 
 /* set_MSTID
  *
- * Description: Sets the master to study for the selected EMIF performance counter (assuming master filtering is enable)
+ * Description: Sets the master to study for the selected EMIF performance counter (assuming master filtering is enable).
+ *              The previous master is replaced.
  *
  * Reference: https://www.ti.com/lit/ug/spruhz6l/spruhz6l.pdf (Table 14-10. ConnID Values)
  *
@@ -158,10 +159,94 @@ void set_MSTID(unsigned id, unsigned master_id, void* emif_base_address){
     unsigned int* perf_cnt_sel = NULL;
     perf_cnt_sel = (unsigned *)(emif_base_address + PERF_CNT_SEL_OFFSET);
 
-    if(id == 0)
+    if(id == 0){
+        *perf_cnt_sel &= 0xFFFF00FF; // Clear MSTID1 bits
         *perf_cnt_sel |= (master_id<<8); // Set MSTID1 bits
-    else if(id == 1)
+    }
+    else if(id == 1){
+        *perf_cnt_sel &= 0x00FFFFFF; // Clear MSTID2 bits
         *perf_cnt_sel |= (master_id<<24); // Set MSTID2 bits
+    }
+}
+
+
+/* enable_CNT_REGION
+ *
+ * Description: Restricts a performance counter to the accesses of the chip select (region) given by set_REGION.
+ *              Only the events which support it are filtered (e.g., 0x2 reads and 0x3 writes), see set_PERF_CNT_EVENT.
+ *              Combined with the MSTID filter, only the accesses of the master to the region are counted.
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *              - unsigned emif_base_address: Address of EMIF 0 or 1 
+ *
+ * Returns:     Nothing
+ *
+ * */
+void enable_CNT_REGION(unsigned id, void* emif_base_address){
+    unsigned int* perf_cnt_cfg = NULL;
+    perf_cnt_cfg = (unsigned *)(emif_base_address + PERF_CNT_CFG_OFFSET);
+
+    if(id == 0)
+        *perf_cnt_cfg |= (1<<14); // Set CNTR1_REGION_EN bit
+    else if(id == 1)
+        *perf_cnt_cfg |= (1<<30); // Set CNTR2_REGION_EN bit
+}
+
+
+/* disable_CNT_REGION
+ *
+ * Description: Counts the accesses to every chip select again
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *              - unsigned emif_base_address: Address of EMIF 0 or 1 
+ *
+ * Returns:     Nothing
+ *
+ * */
+void disable_CNT_REGION(unsigned id, void* emif_base_address){
+    unsigned int* perf_cnt_cfg = NULL;
+    perf_cnt_cfg = (unsigned *)(emif_base_address + PERF_CNT_CFG_OFFSET);
+
+    if(id == 0)
+        *perf_cnt_cfg &= ~(1u<<14); // Clear CNTR1_REGION_EN bit
+    else if(id == 1)
+        *perf_cnt_cfg &= ~(1u<<30); // Clear CNTR2_REGION_EN bit
+}
+
+
+/* set_REGION
+ *
+ * Description: Sets the chip select (region) to study for the selected EMIF performance counter (assuming region filtering is enabled).
+ *              The previous region is replaced.
+ *
+ * Reference: https://www.ti.com/lit/ug/spruhz6l/spruhz6l.pdf (Section 15.3.4.16 Performance Counters)
+ *
+ * Region       Entity
+ * 0            Chip select 0 (CS0)
+ * 1            Chip select 1 (CS1), when SDCFG.EBANK = 1
+ *
+ * Parameter:
+ *              - unsigned id: Performance counter to select (0 for first counter, 1 for second counter)
+ *              - unsigned region: Chip select to focus on
+ *              - unsigned emif_base_address: Address of EMIF 0 or 1 
+ *
+ * Returns:     Nothing
+ *
+ * */
+void set_REGION(unsigned id, unsigned region, void* emif_base_address){
+    unsigned int* perf_cnt_sel = NULL;
+    perf_cnt_sel = (unsigned *)(emif_base_address + PERF_CNT_SEL_OFFSET);
+
+    if(id == 0){
+        *perf_cnt_sel &= 0xFFFFFFF0; // Clear REGION_SEL1 bits
+        *perf_cnt_sel |= (region<<0); // Set REGION_SEL1 bits
+    }
+    else if(id == 1){
+        *perf_cnt_sel &= 0xFFF0FFFF; // Clear REGION_SEL2 bits
+        *perf_cnt_sel |= (region<<16); // Set REGION_SEL2 bits
+    }
 }
 
 
@@ -0,0 +1,333 @@
+/*--------------------------- emif_driver.h ------------------------------
+ |  File emif_driver.h
+ |
+ |  Description: EMIF performance counter driver shared by the Keystone II
+ |               and Sitara AM5728 projects (bare metal and Linux). A
+ |               controller is a base address and a register map; a bus
+ |               groups the controllers whose counters are read together.
+ |
+ |               A bus snapshot reads the timer and both counters of every
+ |               controller back-to-back, without any call or computation
+ |               in between, then reads the timer of the first controller
+ |               again: the difference is the skew of the snapshot (EMIF
+ |               cycles between its first and its last read), so that the
+ |               counters of two EMIFs are known to be comparable.
+ |
+ |               The functions are inline since the header is shared by
+ |               every image; the base address can be any memory block laid
+ |               out as an EMIF (e.g., a simulated register block on a host).
+ |
+ |               The arbitration fields (priority raise counter, read/write
+ |               execution thresholds, Sitara OCP thresholds) are set through
+ |               the same register map, so that a configuration sweep can
+ |               run against real or simulated controllers alike.
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#ifndef EMIF_DRIVER_H_
+#define EMIF_DRIVER_H_
+
+// Maximum number of controllers of a bus
+#define EMIF_MAX_CONTROLLERS 4
+
+// Performance counters of a controller
+#define EMIF_NB_EVT_COUNTERS 2
+
+// Controllers base addresses
+#define EMIF_KEYSTONE2_DDR3A_ADDRESS 0x21010000
+#define EMIF_AM5728_EMIF1_ADDRESS    0x4C000000
+#define EMIF_AM5728_EMIF2_ADDRESS    0x4D000000
+
+// Arbitration fields: register (EMIF_REG_LAT_CONFIG or EMIF_REG_RWTHRESH), first bit and width
+#define EMIF_REG_LAT_CONFIG 0
+#define EMIF_REG_RWTHRESH   1
+
+// LAT_CONFIG (Keystone II) / OCP_CONFIG (AM5728): priority raise old counter, AM5728 only: system and MPU thresholds
+#define EMIF_FIELD_PR_OLD_COUNT     EMIF_REG_LAT_CONFIG, 0, 8
+#define EMIF_FIELD_MPU_THRESH_MAX   EMIF_REG_LAT_CONFIG, 20, 4
+#define EMIF_FIELD_SYS_THRESH_MAX   EMIF_REG_LAT_CONFIG, 24, 4
+// RWTHRESH: read and write execution thresholds (commands of a batch)
+#define EMIF_FIELD_RD_THRESH        EMIF_REG_RWTHRESH, 0, 5
+#define EMIF_FIELD_WR_THRESH        EMIF_REG_RWTHRESH, 8, 5
+
+// Register offsets of a controller
+struct emif_regmap{
+    const char* name;
+    unsigned sdcfg;
+    unsigned lat_config;
+    unsigned perf_cnt_1;
+    unsigned perf_cnt_2;
+    unsigned perf_cnt_cfg;
+    unsigned perf_cnt_sel;
+    unsigned perf_cnt_tim;
+    unsigned rwthresh;
+};
+
+// Register maps (spruhn7c Section 4, spruhz6l Section 15.3.6)
+static const struct emif_regmap EMIF_REGMAP_KEYSTONE2 = {"keystone2_ddr3", 0x008, 0x054, 0x080, 0x084, 0x088, 0x08C, 0x090, 0x120};
+static const struct emif_regmap EMIF_REGMAP_AM5728 = {"am5728_emif", 0x008, 0x054, 0x080, 0x084, 0x088, 0x08C, 0x090, 0x120};
+
+// A controller
+struct emif_controller{
+    volatile unsigned char* base;
+    const struct emif_regmap* regs;
+};
+
+// Controllers read together
+struct emif_bus{
+    unsigned nb_controllers;
+    struct emif_controller controller[EMIF_MAX_CONTROLLERS];
+};
+
+// Counters of every controller of a bus at the same probe point
+struct emif_snapshot{
+    unsigned evt[EMIF_MAX_CONTROLLERS][EMIF_NB_EVT_COUNTERS];
+    unsigned cycles[EMIF_MAX_CONTROLLERS];
+
+    // Timer cycles of the first controller between the first and the last read of the snapshot
+    unsigned skew;
+};
+
+
+/* emif_reg
+ *
+ * Description: Address of a register of a controller
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *              - unsigned offset: Register offset (from the register map)
+ *
+ * Returns:     The register
+ *
+ * */
+static inline volatile unsigned* emif_reg(const struct emif_controller* controller, unsigned offset){
+    return (volatile unsigned*)(controller->base + offset);
+}
+
+
+/* emif_bus_init
+ *
+ * Description: Empties a bus
+ *
+ * Parameter:
+ *              - struct emif_bus* bus: Bus to initialize
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_bus_init(struct emif_bus* bus){
+    bus->nb_controllers = 0;
+}
+
+
+/* emif_bus_add
+ *
+ * Description: Adds a controller to a bus. The controllers are read in the order they are added.
+ *
+ * Parameter:
+ *              - struct emif_bus* bus: Bus to use
+ *              - void* base_address: Base address of the controller (physical, mapped or simulated)
+ *              - const struct emif_regmap* regs: Register map of the controller
+ *
+ * Returns:     The controller number, -1 if the bus is full
+ *
+ * */
+static inline int emif_bus_add(struct emif_bus* bus, void* base_address, const struct emif_regmap* regs){
+    if(bus->nb_controllers == EMIF_MAX_CONTROLLERS)
+        return -1;
+
+    bus->controller[bus->nb_controllers].base = (volatile unsigned char*)base_address;
+    bus->controller[bus->nb_controllers].regs = regs;
+
+    return bus->nb_controllers++;
+}
+
+
+/* emif_set_event
+ *
+ * Description: Sets the CNTRn_CFG event of a performance counter (the master and region filters are kept)
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *              - unsigned counter: Performance counter (0 for PERF_CNT_1, 1 for PERF_CNT_2)
+ *              - unsigned event: Event to count
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_set_event(const struct emif_controller* controller, unsigned counter, unsigned event){
+    volatile unsigned* cfg = emif_reg(controller, controller->regs->perf_cnt_cfg);
+    unsigned shift = 16 * counter;
+
+    *cfg = (*cfg & ~(0xFu << shift)) | ((event & 0xF) << shift);
+}
+
+
+/* emif_set_master
+ *
+ * Description: Restricts a performance counter to the accesses of a master (MSTID filter enabled)
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *              - unsigned counter: Performance counter (0 for PERF_CNT_1, 1 for PERF_CNT_2)
+ *              - unsigned master_id: Master to count
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_set_master(const struct emif_controller* controller, unsigned counter, unsigned master_id){
+    volatile unsigned* sel = emif_reg(controller, controller->regs->perf_cnt_sel);
+    volatile unsigned* cfg = emif_reg(controller, controller->regs->perf_cnt_cfg);
+    unsigned shift = 16 * counter;
+
+    *sel = (*sel & ~(0xFFu << (shift + 8))) | ((master_id & 0xFF) << (shift + 8));
+    *cfg |= 1u << (shift + 15);
+}
+
+
+/* emif_set_region
+ *
+ * Description: Restricts a performance counter to the accesses to a chip select (region filter enabled, reads and writes events only)
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *              - unsigned counter: Performance counter (0 for PERF_CNT_1, 1 for PERF_CNT_2)
+ *              - unsigned region: Chip select to count
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_set_region(const struct emif_controller* controller, unsigned counter, unsigned region){
+    volatile unsigned* sel = emif_reg(controller, controller->regs->perf_cnt_sel);
+    volatile unsigned* cfg = emif_reg(controller, controller->regs->perf_cnt_cfg);
+    unsigned shift = 16 * counter;
+
+    *sel = (*sel & ~(0xFu << shift)) | ((region & 0xF) << shift);
+    *cfg |= 1u << (shift + 14);
+}
+
+
+/* emif_clear_filters
+ *
+ * Description: Counts the accesses of every master to every chip select again
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *              - unsigned counter: Performance counter (0 for PERF_CNT_1, 1 for PERF_CNT_2)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_clear_filters(const struct emif_controller* controller, unsigned counter){
+    volatile unsigned* cfg = emif_reg(controller, controller->regs->perf_cnt_cfg);
+
+    *cfg &= ~(3u << (16 * counter + 14));
+}
+
+
+/* emif_get_sdcfg
+ *
+ * Description: Reads the SDRAM configuration register of a controller
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *
+ * Returns:     The SDCFG value
+ *
+ * */
+static inline unsigned emif_get_sdcfg(const struct emif_controller* controller){
+    return *emif_reg(controller, controller->regs->sdcfg);
+}
+
+
+/* emif_set_field
+ *
+ * Description: Sets an arbitration field of a controller (the other bits of the register are kept)
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *              - unsigned reg, shift, width: Field (e.g., EMIF_FIELD_PR_OLD_COUNT)
+ *              - unsigned value: New value (reduced to the field width)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_set_field(const struct emif_controller* controller, unsigned reg, unsigned shift, unsigned width, unsigned value){
+    volatile unsigned* address = emif_reg(controller, (reg == EMIF_REG_RWTHRESH) ? controller->regs->rwthresh : controller->regs->lat_config);
+    unsigned mask = ((1u << width) - 1) << shift;
+
+    *address = (*address & ~mask) | ((value << shift) & mask);
+}
+
+
+/* emif_bus_set_field
+ *
+ * Description: Sets an arbitration field of every controller of a bus
+ *
+ * Parameter:
+ *              - const struct emif_bus* bus: Bus to use
+ *              - unsigned reg, shift, width: Field (e.g., EMIF_FIELD_RD_THRESH)
+ *              - unsigned value: New value (reduced to the field width)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_bus_set_field(const struct emif_bus* bus, unsigned reg, unsigned shift, unsigned width, unsigned value){
+    unsigned i;
+
+    for(i = 0; i < bus->nb_controllers; i++)
+        emif_set_field(&bus->controller[i], reg, shift, width, value);
+}
+
+
+/* emif_get_field
+ *
+ * Description: Reads an arbitration field of a controller
+ *
+ * Parameter:
+ *              - const struct emif_controller* controller: Controller
+ *              - unsigned reg, shift, width: Field (e.g., EMIF_FIELD_PR_OLD_COUNT)
+ *
+ * Returns:     The field value
+ *
+ * */
+static inline unsigned emif_get_field(const struct emif_controller* controller, unsigned reg, unsigned shift, unsigned width){
+    volatile unsigned* address = emif_reg(controller, (reg == EMIF_REG_RWTHRESH) ? controller->regs->rwthresh : controller->regs->lat_config);
+
+    return (*address >> shift) & ((1u << width) - 1);
+}
+
+
+/* emif_bus_snapshot
+ *
+ * Description: Reads the timer and both counters of every controller of a bus back-to-back, then the first timer again for the skew
+ *
+ * Parameter:
+ *              - const struct emif_bus* bus: Bus to read
+ *              - struct emif_snapshot* snapshot: Where the counters are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_bus_snapshot(const struct emif_bus* bus, struct emif_snapshot* snapshot){
+    const struct emif_controller* controller;
+    unsigned i;
+
+    if(bus->nb_controllers == 0){
+        snapshot->skew = 0;
+        return;
+    }
+
+    for(i = 0; i < bus->nb_controllers; i++){
+        controller = &bus->controller[i];
+        snapshot->cycles[i] = *emif_reg(controller, controller->regs->perf_cnt_tim);
+        snapshot->evt[i][0] = *emif_reg(controller, controller->regs->perf_cnt_1);
+        snapshot->evt[i][1] = *emif_reg(controller, controller->regs->perf_cnt_2);
+    }
+
+    controller = &bus->controller[0];
+    snapshot->skew = *emif_reg(controller, controller->regs->perf_cnt_tim) - snapshot->cycles[0];
+}
+
+#endif /* EMIF_DRIVER_H_ */
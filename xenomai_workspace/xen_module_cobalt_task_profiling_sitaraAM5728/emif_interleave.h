@@ -0,0 +1,182 @@
+/*--------------------------- emif_interleave.h --------------------------
+ |  File emif_interleave.h
+ |
+ |  Description: Interleaving balance of the EMIFs of a bus. On AM5728 the
+ |               DDR space is interleaved across EMIF1 and EMIF2 by the DMM,
+ |               so a buffer only gets the bandwidth of both controllers if
+ |               its accesses split evenly between them. A stride kernel
+ |               walks a buffer once (read-modify-write of one word every
+ |               stride bytes from a placement offset, no line touched
+ |               twice) while the accesses and activates of every EMIF are
+ |               counted; the share of each EMIF and its utilization
+ |               (accesses per thousand PERF_CNT_TIM cycles) are reported,
+ |               and the stride and placement is flagged when one EMIF
+ |               takes more than a given share of the accesses.
+ |
+ |               The functions are inline since the header is shared by the
+ |               bare-metal and the Linux Sitara profilers. The counters of
+ |               the bus must count the accesses (PERF_CNT_1) and the
+ |               activates (PERF_CNT_2); a master filter on the MPU keeps
+ |               the traffic of the other masters out of the shares.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef EMIF_INTERLEAVE_H_
+#define EMIF_INTERLEAVE_H_
+
+#include <stdio.h>
+#include "emif_driver.h"
+
+// Per mille of the accesses above which a single EMIF is flagged (500 is an even split on two EMIFs)
+#define EMIF_INTERLEAVE_IMBALANCE_PERMILLE 700
+
+// Counters of every EMIF during a stride kernel
+struct emif_interleave_result{
+    unsigned stride;
+    unsigned offset;
+    unsigned nb_accesses;
+    unsigned long long accesses[EMIF_MAX_CONTROLLERS];
+    unsigned long long activates[EMIF_MAX_CONTROLLERS];
+    unsigned long long cycles[EMIF_MAX_CONTROLLERS];
+};
+
+
+// Per mille of a value in a total, 0 for an empty total
+static inline unsigned emif_interleave_permille(unsigned long long value, unsigned long long total){
+    return (total == 0) ? 0 : (unsigned)((value * 1000) / total);
+}
+
+
+/* emif_stride_kernel
+ *
+ * Description: Read-modify-write of one word every stride bytes, from buffer + offset to the end of the buffer
+ *
+ * Parameter:
+ *              - volatile unsigned char* buffer: Buffer walked
+ *              - unsigned size: Buffer size (bytes)
+ *              - unsigned offset: Placement of the first access in the buffer (bytes, word aligned)
+ *              - unsigned stride: Bytes between two accesses (word aligned, not 0)
+ *
+ * Returns:     The number of words accessed
+ *
+ * */
+static inline unsigned emif_stride_kernel(volatile unsigned char* buffer, unsigned size, unsigned offset, unsigned stride){
+    unsigned position, nb_accesses = 0;
+
+    for(position = offset; position + sizeof(unsigned) <= size; position += stride){
+        (*(volatile unsigned*)(buffer + position))++;
+        nb_accesses++;
+    }
+
+    return nb_accesses;
+}
+
+
+/* emif_interleave_measure
+ *
+ * Description: Runs the stride kernel between two snapshots of the bus
+ *
+ * Parameter:
+ *              - const struct emif_bus* bus: EMIFs sharing the interleaved space
+ *              - volatile unsigned char* buffer, unsigned size, unsigned offset, unsigned stride: Kernel (see emif_stride_kernel)
+ *              - struct emif_interleave_result* result: Where the counters increments are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void emif_interleave_measure(const struct emif_bus* bus, volatile unsigned char* buffer, unsigned size, unsigned offset, unsigned stride,
+                                           struct emif_interleave_result* result){
+    struct emif_snapshot begin, end;
+    unsigned e;
+
+    emif_bus_snapshot(bus, &begin);
+    result->nb_accesses = emif_stride_kernel(buffer, size, offset, stride);
+    emif_bus_snapshot(bus, &end);
+
+    result->stride = stride;
+    result->offset = offset;
+
+    // Counters are free running: unsigned differences also hold across a wrap
+    for(e = 0; e < bus->nb_controllers; e++){
+        result->accesses[e] = end.evt[e][0] - begin.evt[e][0];
+        result->activates[e] = end.evt[e][1] - begin.evt[e][1];
+        result->cycles[e] = end.cycles[e] - begin.cycles[e];
+    }
+}
+
+
+/* emif_interleave_print
+ *
+ * Description: Writes "<offset> <stride> <words accessed>", then for each EMIF its access share, activate share (per mille) and
+ *              utilization (accesses per 1000 timer cycles), then "imbalanced <EMIF>" or "balanced"
+ *
+ * Parameter:
+ *              - const struct emif_bus* bus: EMIFs measured
+ *              - const struct emif_interleave_result* result: Counters of the kernel
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     1 if the run is imbalanced, 0 otherwise
+ *
+ * */
+static inline int emif_interleave_print(const struct emif_bus* bus, const struct emif_interleave_result* result, void (*write_line)(char* line)){
+    unsigned long long accesses = 0, activates = 0;
+    unsigned e, length, busiest = 0, share;
+    char line[256];
+
+    for(e = 0; e < bus->nb_controllers; e++){
+        accesses += result->accesses[e];
+        activates += result->activates[e];
+        if(result->accesses[e] > result->accesses[busiest])
+            busiest = e;
+    }
+
+    length = snprintf(line, sizeof(line), "%u %u %u", result->offset, result->stride, result->nb_accesses);
+    for(e = 0; e < bus->nb_controllers; e++)
+        length += snprintf(line + length, sizeof(line) - length, " %u %u %u", emif_interleave_permille(result->accesses[e], accesses),
+                           emif_interleave_permille(result->activates[e], activates), emif_interleave_permille(result->accesses[e], result->cycles[e]));
+
+    share = emif_interleave_permille(result->accesses[busiest], accesses);
+    if(bus->nb_controllers > 1 && share > EMIF_INTERLEAVE_IMBALANCE_PERMILLE)
+        snprintf(line + length, sizeof(line) - length, " imbalanced %u \n\r", busiest);
+    else
+        snprintf(line + length, sizeof(line) - length, " balanced \n\r");
+    write_line(line);
+
+    return bus->nb_controllers > 1 && share > EMIF_INTERLEAVE_IMBALANCE_PERMILLE;
+}
+
+
+/* emif_interleave_sweep
+ *
+ * Description: Measures and prints the stride kernel for every placement offset and every stride
+ *
+ * Parameter:
+ *              - const struct emif_bus* bus: EMIFs sharing the interleaved space
+ *              - volatile unsigned char* buffer: Buffer walked (e.g., where a large task buffer would be placed)
+ *              - unsigned size: Buffer size (bytes), so that size / stride lines do not fit in the last level cache
+ *              - const unsigned* offsets, unsigned nb_offsets: Placements of the first access
+ *              - const unsigned* strides, unsigned nb_strides: Strides (bytes)
+ *              - void (*prepare)(void): Called before each run, e.g., to clean the caches (NULL: nothing)
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     The number of imbalanced runs
+ *
+ * */
+static inline unsigned emif_interleave_sweep(const struct emif_bus* bus, volatile unsigned char* buffer, unsigned size, const unsigned* offsets, unsigned nb_offsets,
+                                             const unsigned* strides, unsigned nb_strides, void (*prepare)(void), void (*write_line)(char* line)){
+    struct emif_interleave_result result;
+    unsigned o, s, nb_imbalanced = 0;
+
+    for(o = 0; o < nb_offsets; o++)
+        for(s = 0; s < nb_strides; s++){
+            if(prepare != NULL)
+                prepare();
+            emif_interleave_measure(bus, buffer, size, offsets[o], strides[s], &result);
+            nb_imbalanced += emif_interleave_print(bus, &result, write_line);
+        }
+
+    return nb_imbalanced;
+}
+
+#endif /* EMIF_INTERLEAVE_H_ */
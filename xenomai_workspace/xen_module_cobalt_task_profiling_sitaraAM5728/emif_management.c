@@ -4,7 +4,7 @@
  |  Description: The functions definition for the Sitara AM5728 EMIF
  |               management are done here
  |
- |  Version: 1.1
+ |  Version: 1.6
  *-----------------------------------------------------------------------*/
 
 #include <stdio.h>
@@ -38,13 +38,31 @@
 #define MASTER_ID_EMIF_1 0x0
 
 
-// EMIF0 performance counters initial and final read variables
-unsigned t1_ddr_cycles_emif0,t2_ddr_cycles_emif0, result_ddr_cycles_emif0, t1_ddr_evt0_emif0, t2_ddr_evt0_emif0, result_ddr_evt0_emif0, t1_ddr_evt1_emif0, t2_ddr_evt1_emif0, result_ddr_evt1_emif0;
-// EMIF1 performance counters initial and final read variables
-unsigned t1_ddr_cycles_emif1,t2_ddr_cycles_emif1, result_ddr_cycles_emif1, t1_ddr_evt0_emif1, t2_ddr_evt0_emif1, result_ddr_evt0_emif1, t1_ddr_evt1_emif1 ,t2_ddr_evt1_emif1, result_ddr_evt1_emif1;
+// EMIF0 performance counters results
+unsigned result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0;
+// EMIF1 performance counters results
+unsigned result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1;
+// Largest skew of the initial and final snapshots
+unsigned result_ddr_skew;
+
+// Both EMIFs, read back-to-back
+struct emif_bus emif_bus_am5728;
+
+// Initial and final snapshots
+static struct emif_snapshot ddr_begin, ddr_end;
+
+
+// Points the bus at both EMIFs
+static void ddr_bus_select(void* emif0_addr, void* emif1_addr){
+    emif_bus_init(&emif_bus_am5728);
+    emif_bus_add(&emif_bus_am5728, emif0_addr, &EMIF_REGMAP_AM5728);
+    emif_bus_add(&emif_bus_am5728, emif1_addr, &EMIF_REGMAP_AM5728);
+}
 
 
 void DDR_configure_eval(unsigned filter_events, void* emif0_addr, void* emif1_addr){
+    ddr_bus_select(emif0_addr, emif1_addr);
+
     /* EMIF1, performance counter 0 */
     set_PERF_CNT_EVENT(0, EMIF_EVENT_ID_0, emif0_addr);
 
@@ -78,38 +96,62 @@ void DDR_configure_eval(unsigned filter_events, void* emif0_addr, void* emif1_ad
 }
 
 
-void DDR_start_eval(void* emif0_addr, void* emif1_addr){
-    t1_ddr_evt0_emif0 = get_PERF_CNT_1(emif0_addr);
-    t1_ddr_evt1_emif0 = get_PERF_CNT_2(emif0_addr);
-    t1_ddr_cycles_emif0 = get_PERF_CNT_TIMER(emif0_addr);
+void DDR_configure_region(unsigned filter_region, unsigned region, void* emif0_addr, void* emif1_addr){
+    void* emif_addr[2] = {emif0_addr, emif1_addr};
+    unsigned i, id;
+
+    for(i = 0; i < 2; i++){
+        for(id = 0; id < 2; id++){
+            if(filter_region){
+                set_REGION(id, region, emif_addr[i]);
+                enable_CNT_REGION(id, emif_addr[i]);
+            }
+            else
+                disable_CNT_REGION(id, emif_addr[i]);
+        }
+    }
+}
+
 
-    t1_ddr_evt0_emif1 = get_PERF_CNT_1(emif1_addr);
-    t1_ddr_evt1_emif1 = get_PERF_CNT_2(emif1_addr);
-    t1_ddr_cycles_emif1 = get_PERF_CNT_TIMER(emif1_addr);
+void DDR_start_eval(void* emif0_addr, void* emif1_addr){
+    ddr_bus_select(emif0_addr, emif1_addr);
+    emif_bus_snapshot(&emif_bus_am5728, &ddr_begin);
 }
 
 
 void DDR_end_eval(void* emif0_addr, void* emif1_addr){
-    t2_ddr_evt0_emif0 = get_PERF_CNT_1(emif0_addr);
-    t2_ddr_evt1_emif0 = get_PERF_CNT_2(emif0_addr);
-    t2_ddr_cycles_emif0 = get_PERF_CNT_TIMER(emif0_addr);
+    emif_bus_snapshot(&emif_bus_am5728, &ddr_end);
+
+    result_ddr_cycles_emif0 = ddr_end.cycles[0] - ddr_begin.cycles[0];
+    result_ddr_evt0_emif0 = ddr_end.evt[0][0] - ddr_begin.evt[0][0];
+    result_ddr_evt1_emif0 = ddr_end.evt[0][1] - ddr_begin.evt[0][1];
+
+    result_ddr_cycles_emif1 = ddr_end.cycles[1] - ddr_begin.cycles[1];
+    result_ddr_evt0_emif1 = ddr_end.evt[1][0] - ddr_begin.evt[1][0];
+    result_ddr_evt1_emif1 = ddr_end.evt[1][1] - ddr_begin.evt[1][1];
+
+    result_ddr_skew = (ddr_begin.skew > ddr_end.skew) ? ddr_begin.skew : ddr_end.skew;
+}
+
+
+void DDR_read_counters(void* emif0_addr, void* emif1_addr, unsigned* values){
+    struct emif_snapshot snapshot;
 
-    t2_ddr_evt0_emif1 = get_PERF_CNT_1(emif1_addr);
-    t2_ddr_evt1_emif1 = get_PERF_CNT_2(emif1_addr);
-    t2_ddr_cycles_emif1 = get_PERF_CNT_TIMER(emif1_addr);
+    ddr_bus_select(emif0_addr, emif1_addr);
+    emif_bus_snapshot(&emif_bus_am5728, &snapshot);
 
-    result_ddr_cycles_emif0 = t2_ddr_cycles_emif0 - t1_ddr_cycles_emif0;
-    result_ddr_evt0_emif0 = t2_ddr_evt0_emif0 - t1_ddr_evt0_emif0;
-    result_ddr_evt1_emif0 = t2_ddr_evt1_emif0 - t1_ddr_evt1_emif0;
+    values[0] = snapshot.evt[0][0];
+    values[1] = snapshot.evt[0][1];
+    values[2] = snapshot.cycles[0];
 
-    result_ddr_cycles_emif1 = t2_ddr_cycles_emif1 - t1_ddr_cycles_emif1;
-    result_ddr_evt0_emif1 = t2_ddr_evt0_emif1 - t1_ddr_evt0_emif1;
-    result_ddr_evt1_emif1 = t2_ddr_evt1_emif1 - t1_ddr_evt1_emif1;
+    values[3] = snapshot.evt[1][0];
+    values[4] = snapshot.evt[1][1];
+    values[5] = snapshot.cycles[1];
 }
 
 
 void print_emif_results(unsigned id){
- printf("%u %u %u %u %u %u %u \n", id, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1);
+ printf("%u %u %u %u %u %u %u %u \n", id, result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0, result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1, result_ddr_skew);
 }
 
 
@@ -4,9 +4,20 @@
  |  Description: The functions declaration for Sitara AM5728 emif management
  |               are done here
  |
- |  Version: 1.1
+ |  Version: 1.7
  *-----------------------------------------------------------------------*/
 
+#include "emif_driver.h"
+
+// Results of the last DDR_start_eval/DDR_end_eval pair: timer cycles, SDRAM accesses (event 0) and activates (event 1)
+extern unsigned result_ddr_cycles_emif0, result_ddr_evt0_emif0, result_ddr_evt1_emif0;
+extern unsigned result_ddr_cycles_emif1, result_ddr_evt0_emif1, result_ddr_evt1_emif1;
+// EMIF 0 timer cycles between the first and the last read of a snapshot (largest of the two snapshots)
+extern unsigned result_ddr_skew;
+
+// Both EMIFs (EMIF 0 then EMIF 1), set by DDR_configure_eval, for the event rotation and the master sweep
+extern struct emif_bus emif_bus_am5728;
+
 
 /* DDR_configure_eval
  *
@@ -24,9 +35,26 @@
 void DDR_configure_eval(unsigned filter_events, void* emif0_addr, void* emif1_addr);
 
 
+/* DDR_configure_region
+ *
+ * Description: Restricts the performance counters of both EMIFs to the accesses to a chip select (region), on top of the master filter.
+ *              Only the events which support it are filtered (reads and writes, not accesses and activates).
+ *
+ * Parameter:
+ *              - unsigned filter_region: 1 to count the given chip select only, 0 to count every chip select
+ *              - unsigned region: Chip select to count
+ *              - void* emif0_addr: Indicates the base address of the EMIF 0
+ *              - void* emif1_addr: Indicates the base address of the EMIF 1
+ *
+ * Returns: Nothing
+ *
+ * */
+void DDR_configure_region(unsigned filter_region, unsigned region, void* emif0_addr, void* emif1_addr);
+
+
 /* DDR_start_eval
  *
- * Description: Reads both EMIFs performance counters for the first time.
+ * Description: Reads both EMIFs performance counters for the first time, back-to-back.
  *
  * Parameter:
  *              - void* emif0_addr: Indicates the base address of the EMIF 0
@@ -52,9 +80,24 @@ void DDR_start_eval(void* emif0_addr, void* emif1_addr);
 void DDR_end_eval(void* emif0_addr, void* emif1_addr);
 
 
+/* DDR_read_counters
+ *
+ * Description: Reads the free-running performance counters of both EMIFs without computing any difference
+ *
+ * Parameter:
+ *              - void* emif0_addr: Indicates the base address of the EMIF 0
+ *              - void* emif1_addr: Indicates the base address of the EMIF 1
+ *              - unsigned* values: Six elements where counter 1, counter 2 and timer of EMIF 0 then EMIF 1 are written
+ *
+ * Returns: Nothing
+ *
+ */
+void DDR_read_counters(void* emif0_addr, void* emif1_addr, unsigned* values);
+
+
 /* print_emif_results
  *
- * Description: Prints the results for the chosen DDR SDRAM events
+ * Description: Prints the results for the chosen DDR SDRAM events, followed by the snapshot skew
  *
  * Parameter:
  *				- unsigned id: the identification number for the printed result
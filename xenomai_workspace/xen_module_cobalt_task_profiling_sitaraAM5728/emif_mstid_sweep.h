@@ -0,0 +1,113 @@
+/*--------------------------- emif_mstid_sweep.h -------------------------
+ |  File emif_mstid_sweep.h
+ |
+ |  Description: Per-master EMIF attribution. While a co-run scenario
+ |               keeps running, the master filter (MSTID) of both EMIF
+ |               counters is moved over a list of masters, one measured
+ |               window per master and per pair of events (accesses and
+ |               activates, then reads and writes). Once every master was
+ |               measured, the masters x {accesses, activates, reads,
+ |               writes} matrix of the window is complete; each cell is a
+ |               rate per EMIF_MSTID_RATE_CYCLES EMIF cycles, since the
+ |               cells come from different windows.
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#ifndef EMIF_MSTID_SWEEP_H_
+#define EMIF_MSTID_SWEEP_H_
+
+#include "emif_event_scheduler.h"
+
+// Maximum number of masters of a sweep (MSTID is 8 bits)
+#define EMIF_MSTID_MAX_MASTERS 256
+
+// Events of a matrix row, measured two by two
+#define EMIF_MSTID_NB_EVENTS 4
+
+// EMIF cycles of a rate
+#define EMIF_MSTID_RATE_CYCLES 1000000
+
+// A master of the SoC
+struct emif_master{
+    // Printed name (NULL: the master ID is printed)
+    const char* name;
+    unsigned id;
+};
+
+struct emif_mstid_sweep{
+    const struct emif_bus* bus;
+
+    // Masters of the matrix
+    const struct emif_master* masters;
+    unsigned nb_masters;
+
+    // Per-master accesses, activates, reads and writes summed over the EMIFs, and EMIF cycles of each pair of events
+    unsigned long long count[EMIF_MSTID_MAX_MASTERS][EMIF_MSTID_NB_EVENTS];
+    unsigned long long cycles[EMIF_MSTID_MAX_MASTERS][EMIF_MSTID_NB_EVENTS / EMIF_NB_EVT_COUNTERS];
+
+    // Next measured window (master * 2 + pair of events), number of complete matrices, counters read by emif_mstid_start
+    unsigned current;
+    unsigned window;
+    struct emif_snapshot begin;
+};
+
+
+/* emif_mstid_init
+ *
+ * Description: Prepares a master sweep and clears its matrix
+ *
+ * Parameter:
+ *              - struct emif_mstid_sweep* sweep: Sweep to initialize
+ *              - const struct emif_bus* bus: EMIFs measured
+ *              - const struct emif_master* masters: Masters of the matrix
+ *              - unsigned nb_masters: Number of masters (at most EMIF_MSTID_MAX_MASTERS)
+ *
+ * Returns:     0 on success, -1 if there are no masters or too many
+ *
+ * */
+int emif_mstid_init(struct emif_mstid_sweep* sweep, const struct emif_bus* bus, const struct emif_master* masters, unsigned nb_masters);
+
+
+/* emif_mstid_start
+ *
+ * Description: Sets the master filter and the events of the next window, then reads the counters of every EMIF
+ *
+ * Parameter:
+ *              - struct emif_mstid_sweep* sweep: Sweep to use
+ *
+ * Returns:     Nothing
+ *
+ * */
+void emif_mstid_start(struct emif_mstid_sweep* sweep);
+
+
+/* emif_mstid_stop
+ *
+ * Description: Reads the counters of every EMIF again and adds the window to the matrix
+ *
+ * Parameter:
+ *              - struct emif_mstid_sweep* sweep: Sweep to use
+ *
+ * Returns:     1 if the matrix is complete (to be printed by emif_mstid_print), 0 otherwise
+ *
+ * */
+int emif_mstid_stop(struct emif_mstid_sweep* sweep);
+
+
+/* emif_mstid_print
+ *
+ * Description: Writes the matrix, "<window> <master> <accesses> <activates> <reads> <writes>" per master
+ *              in events per EMIF_MSTID_RATE_CYCLES EMIF cycles, then clears it for the next window
+ *
+ * Parameter:
+ *              - struct emif_mstid_sweep* sweep: Sweep to use
+ *              - unsigned skip_idle: 1 to leave out the masters without any access (e.g., when sweeping every MSTID), 0 otherwise
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void emif_mstid_print(struct emif_mstid_sweep* sweep, unsigned skip_idle, void (*write_line)(char* line));
+
+#endif /* EMIF_MSTID_SWEEP_H_ */
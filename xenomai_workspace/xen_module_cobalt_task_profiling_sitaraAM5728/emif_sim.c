@@ -0,0 +1,225 @@
+/*--------------------------- emif_sim.c ---------------------------------
+ |  File emif_sim.c
+ |
+ |  Description: Host companion process simulating the performance
+ |               counters of the two AM5728 EMIFs in a file (or a shared
+ |               memory segment, e.g., /dev/shm/...) mapped by the profiler
+ |               through EMIF_SIM_FILE, so that the whole periodic-task
+ |               harness runs on any Linux host.
+ |
+ |               The file holds one 4 KB register block per EMIF, laid out
+ |               as EMIF_REGMAP_AM5728. The process writes PERF_CNT_1,
+ |               PERF_CNT_2 and PERF_CNT_TIM; the profiler writes
+ |               PERF_CNT_CFG and PERF_CNT_SEL, whose event selection, MSTID
+ |               filter and chip select filter are applied from the next
+ |               update on. The timer runs freely at EMIF_SIM_CLOCK_MHZ and
+ |               a counter keeps its value when its configuration changes,
+ |               as on the board.
+ |
+ |               The traffic is a synthetic model: every master of
+ |               SIM_MASTERS issues accesses at a constant rate to one chip
+ |               select, split evenly over both EMIFs (interleaving).
+ |               The process runs at a real-time priority above the
+ |               profiler threads, otherwise the counters would stall
+ |               during a measurement on a shared core.
+ |
+ |               Usage: emif_sim <file> [seconds]   (0 or none: until killed)
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "emif_event_scheduler.h"
+
+
+// EMIFs and size of a register block in the file
+#define SIM_NB_EMIFS 2
+#define SIM_BLOCK_SIZE 4096
+
+// EMIF clock (MHz) driving PERF_CNT_TIM, and update period of the counters (microseconds)
+#define EMIF_SIM_CLOCK_MHZ 266
+#define EMIF_SIM_PERIOD_US 10
+
+// Real-time priority of the process, above the profiler threads (SCHED_FIFO 71 and 70) so that the counters
+// keep running during a measurement when both share a core
+#define EMIF_SIM_PRIORITY 80
+
+// SDRAM data bus cycles of an access (burst of 8 on a double data rate bus)
+#define SIM_BURST_CYCLES 4
+
+// Events of the model, by EMIF event code (the other events stay at 0)
+#define SIM_NB_EVENTS (EMIF_EVT_DATA_BUS_ACTIVE + 1)
+
+// A master of the traffic model
+struct sim_master{
+    const char* name;
+    unsigned mstid;
+
+    // Accesses per microsecond (both EMIFs), activates and reads per thousand accesses, chip select
+    unsigned accesses_per_us;
+    unsigned activate_permille;
+    unsigned read_permille;
+    unsigned region;
+};
+
+// Traffic model (MSTIDs of spruhz6l Table 14-10, as AM5728_MASTERS of main.c)
+static const struct sim_master SIM_MASTERS[] = {
+    {"mpu", 0x0, 200, 300, 700, 0},
+    {"dsp1_mdma", 0x20, 100, 500, 500, 0},
+    {"dsp2_mdma", 0x34, 50, 500, 500, 1},
+};
+#define SIM_NB_MASTERS (sizeof(SIM_MASTERS)/sizeof(SIM_MASTERS[0]))
+
+// Configuration of a performance counter and its value when the configuration was last changed
+struct sim_counter{
+    unsigned cfg;
+    unsigned sel;
+    unsigned base_value;
+    unsigned long long base_count;
+};
+
+
+// Register of a block
+static volatile unsigned* sim_reg(volatile unsigned char* block, unsigned offset){
+    return (volatile unsigned*)(block + offset);
+}
+
+
+// Events of a master on one EMIF after ns nanoseconds of simulation
+static unsigned long long master_events(const struct sim_master* master, unsigned event, unsigned long long ns){
+    unsigned long long accesses = (master->accesses_per_us * ns) / (1000ULL * SIM_NB_EMIFS);
+
+    switch(event){
+        case EMIF_EVT_ACCESSES:
+            return accesses;
+        case EMIF_EVT_ACTIVATES:
+            return (accesses * master->activate_permille) / 1000;
+        case EMIF_EVT_READS:
+            return (accesses * master->read_permille) / 1000;
+        case EMIF_EVT_WRITES:
+            return accesses - (accesses * master->read_permille) / 1000;
+        case EMIF_EVT_CMD_PENDING:
+        case EMIF_EVT_DATA_BUS_ACTIVE:
+            return accesses * SIM_BURST_CYCLES;
+        default:
+            return 0;
+    }
+}
+
+
+// Count of a counter configuration (CNTRn_CFG and CNTRn_SEL half-words) after ns nanoseconds of simulation
+static unsigned long long counter_events(unsigned cfg, unsigned sel, unsigned long long ns){
+    unsigned event = cfg & 0xF;
+    unsigned long long count = 0;
+    unsigned m;
+
+    for(m = 0; m < SIM_NB_MASTERS; m++){
+        // MSTID filter (CNTRn_MSTID_EN) and chip select filter (CNTRn_REGION_EN)
+        if((cfg & (1u << 15)) && SIM_MASTERS[m].mstid != ((sel >> 8) & 0xFF))
+            continue;
+        if((cfg & (1u << 14)) && SIM_MASTERS[m].region != (sel & 0xF))
+            continue;
+
+        count += master_events(&SIM_MASTERS[m], event, ns);
+    }
+
+    return count;
+}
+
+
+// Writes the counters of an EMIF after ns nanoseconds of simulation
+static void update_emif(volatile unsigned char* block, struct sim_counter* counters, unsigned long long ns){
+    const struct emif_regmap* regs = &EMIF_REGMAP_AM5728;
+    unsigned offsets[EMIF_NB_EVT_COUNTERS] = {regs->perf_cnt_1, regs->perf_cnt_2};
+    unsigned cfg_reg = *sim_reg(block, regs->perf_cnt_cfg);
+    unsigned sel_reg = *sim_reg(block, regs->perf_cnt_sel);
+    unsigned cfg, sel, i;
+    unsigned long long count;
+
+    for(i = 0; i < EMIF_NB_EVT_COUNTERS; i++){
+        cfg = (cfg_reg >> (16 * i)) & 0xFFFF;
+        sel = (sel_reg >> (16 * i)) & 0xFFFF;
+
+        // New configuration: the counter goes on from its current value
+        if(cfg != counters[i].cfg || sel != counters[i].sel){
+            counters[i].cfg = cfg;
+            counters[i].sel = sel;
+            counters[i].base_value = *sim_reg(block, offsets[i]);
+            counters[i].base_count = counter_events(cfg, sel, ns);
+        }
+
+        count = counter_events(cfg, sel, ns) - counters[i].base_count;
+        *sim_reg(block, offsets[i]) = counters[i].base_value + (unsigned)count;
+    }
+
+    *sim_reg(block, regs->perf_cnt_tim) = (unsigned)((ns * EMIF_SIM_CLOCK_MHZ) / 1000);
+}
+
+
+// Nanoseconds of a monotonic clock
+static unsigned long long now_ns(void){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+
+int main(int argc, char **argv){
+    struct sim_counter counters[SIM_NB_EMIFS][EMIF_NB_EVT_COUNTERS];
+    struct timespec period = {0, EMIF_SIM_PERIOD_US * 1000};
+    struct sched_param param = {.sched_priority = EMIF_SIM_PRIORITY};
+    unsigned long long start, ns, duration_ns = 0;
+    volatile unsigned char* blocks;
+    unsigned e;
+    int fd;
+
+    if(argc < 2){
+        fprintf(stderr, "Usage: %s <file> [seconds] \n", argv[0]);
+        return -1;
+    }
+    if(argc > 2)
+        duration_ns = strtoull(argv[2], NULL, 0) * 1000000000ULL;
+
+    // Register blocks cleared: every counter counts the accesses of every master
+    fd = open(argv[1], O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if(fd < 0 || ftruncate(fd, SIM_NB_EMIFS * SIM_BLOCK_SIZE) < 0){
+        perror("Can't create the register file");
+        return -1;
+    }
+
+    blocks = mmap(NULL, SIM_NB_EMIFS * SIM_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(blocks == MAP_FAILED){
+        perror("Can't map the register file");
+        return -1;
+    }
+
+    if(sched_setscheduler(0, SCHED_FIFO, &param) < 0)
+        perror("No real-time priority, the counters may stall while the profiler runs");
+
+    memset(counters, 0, sizeof(counters));
+    start = now_ns();
+
+    printf("EMIF simulation in %s: %u EMIFs, %u MHz, %u masters \n", argv[1], SIM_NB_EMIFS, EMIF_SIM_CLOCK_MHZ, (unsigned)SIM_NB_MASTERS);
+    fflush(stdout);
+
+    do{
+        ns = now_ns() - start;
+        for(e = 0; e < SIM_NB_EMIFS; e++)
+            update_emif(blocks + e * SIM_BLOCK_SIZE, counters[e], ns);
+        nanosleep(&period, NULL);
+    } while(duration_ns == 0 || ns < duration_ns);
+
+    munmap((void*)blocks, SIM_NB_EMIFS * SIM_BLOCK_SIZE);
+
+    return 0;
+}
@@ -10,9 +10,12 @@
  |                for analyzing the effect of different
  |                benchmarks on the system. A Linux module for
  |                enabling User mode access to the Performance Monitors
- |                is required. 
+ |                is required, unless the perf_event backend
+ |                is built (make -f make_v2 host). The EMIF
+ |                registers are read from /dev/mem, or from the
+ |                file of emif_sim given by EMIF_SIM_FILE.
  |
- |  Version: 1.1
+ |  Version: 1.22
  |
  | Contact:
  | alfonso.mascarenas-gonzalez@isae-supaero.fr
@@ -31,15 +34,133 @@
 #include <sys/mman.h>
 #include <sys/resource.h>
 #include <errno.h>
+#include <time.h>
 
 #include "periodic_task.h"
 #include "arm_pmu_management.h"
+#include "pmu_event_scheduler.h"
+#include "pmu_perf_sampling.h"
+#include "pmu_region.h"
+#include "pmu_metrics.h"
+#include "pmu_event_sweep.h"
+#include "pmu_xcore.h"
+#include "cache_state_management.h"
 #include "emif_management.h"
+#include "emif_mstid_sweep.h"
+#include "config_sweep.h"
+#include "emif_interleave.h"
+#include "stream_kernels.h"
+#include "pointer_chase.h"
 
 
 #define C_MATRIX_SIZE 1024
 #define T1 500000
 
+// Number of empty start/stop pairs used to measure the PMU probe cost
+#define PMU_CALIBRATION_RUNS 1000
+
+// Overflow polling of the 64-bit counters at the phase boundaries of the task, for runs where a counter may wrap more than
+// once (more than 2^32 events). The poll is not part of the calibrated probe cost: it adds to every measured run.
+// 0 = disabled (a single wrap is still accounted at the end of the measurement), 1 = enabled
+#define PMU_OVERFLOW_POLLING 0
+
+// PMU mode. 0 = fixed six events, 1 = event fingerprint (FINGERPRINT_EVENTS rotated in groups of six)
+#define PMU_MULTIPLEXING 0
+// Number of task periods between two event fingerprint reports
+#define PMU_FINGERPRINT_PERIODS 100
+
+// Statistical sampling through perf_event instead of the start/stop measurements. 0 = disabled, 1 = enabled
+#define PMU_SAMPLING 0
+// Event counter whose overflows are sampled (4 = L2 data cache refill, see arm_pmu_management.c) and events between two samples
+#define PMU_SAMPLING_COUNTER 4
+#define PMU_SAMPLING_PERIOD 10000
+// Preallocated samples and number of task periods between two sample reports
+#define PMU_SAMPLING_BUFFER_SIZE 8192
+#define PMU_SAMPLING_PERIODS 10
+
+// Phases of the dummy task recorded as regions (with the fixed six events only). 0 = disabled, 1 = enabled
+#define PMU_REGIONS 0
+// Number of region records of the ring buffer and number of task periods between two dumps
+#define PMU_REGION_RING_SIZE 1024
+#define PMU_REGION_PERIODS 10
+
+// Derived metrics summary (runs, min, mean, max) instead of the raw lines (with the fixed six events only). 0 = disabled, 1 = enabled
+#define PMU_SUMMARY 0
+// Number of task periods summarized together
+#define PMU_SUMMARY_PERIODS 100
+
+// Row-buffer locality (ACOR, row hit ratio, row switches) of each task period, summarized every PMU_SUMMARY_PERIODS,
+// and of each phase when PMU_REGIONS is set (EMIF accesses and activates, no EMIF_REGION_FILTER, not with PMU_SAMPLING).
+// 0 = disabled, 1 = enabled
+#define PMU_ROW_LOCALITY 0
+
+// Event fingerprint sweep of the whole A15 event space (0x00-0x7F) instead of the periodic tasks. 0 = disabled, 1 = enabled
+#define PMU_EVENT_SWEEP 0
+
+// EMIF arbitration sweep over the CONFIG_KNOBS grid instead of the periodic tasks, ranked by the dummy task worst case.
+// Runs on a host against the simulated EMIF registers. 0 = disabled, 1 = enabled
+#define CONFIG_SWEEP 0
+// Runs of each benchmark per point of the grid
+#define CONFIG_SWEEP_RUNS 10
+
+// EMIF interleaving balance of stride kernels instead of the periodic tasks: access/activate share and utilization of
+// each EMIF per placement offset and stride, imbalanced runs flagged. 0 = disabled, 1 = enabled
+#define EMIF_INTERLEAVE_ANALYSIS 0
+// Buffer walked by the stride kernels (page aligned, larger than the L2 cache)
+#define INTERLEAVE_BUFFER_SIZE (32*1024*1024)
+
+// STREAM bandwidth kernels (copy, scale, add, triad) instead of the periodic tasks, STREAM_RUNS runs each, then the
+// bandwidth ceiling. 0 = disabled, 1 = enabled
+#define STREAM_BANDWIDTH 0
+#define STREAM_RUNS 10
+// Words per array (much larger than the L2 cache) and words between two arrays
+#define STREAM_ARRAY_WORDS (4*1024*1024)
+#define STREAM_ARRAY_OFFSET_WORDS 0
+
+// Latency of randomized pointer chasing over working sets from 4 KB doubling up to POINTER_CHASE_SIZE instead of the periodic
+// tasks, then the plateau of each memory level. 0 = disabled, 1 = enabled
+#define POINTER_CHASE_LATENCY 0
+#define POINTER_CHASE_SIZE (64*1024*1024)
+// Window of the row-local chains: a page is physically contiguous, and holds one SDRAM row of each EMIF on AM5728
+// (1024 columns on the 32-bit bus, 2 KB of the page on each EMIF)
+#define POINTER_CHASE_ROW_WINDOW 4096
+
+// Task of thread1 (aggressor). 0 = dummy task, 1 = STREAM triad (peak-bandwidth aggressor)
+#define AGGRESSOR_KERNEL 0
+
+// Counters of thread1 (aggressor, CPU 1) harvested during each thread0 run, ARMv7 backend only. 0 = disabled, 1 = enabled
+#define PMU_XCORE 0
+// Slots of the threads and slot polls before the aggressor is reported as missing
+#define XCORE_VICTIM_SLOT     0
+#define XCORE_AGGRESSOR_SLOT  1
+#define PMU_XCORE_TIMEOUT 10000000
+
+// Cache state before each thread0 run: CACHE_STATE_AS_IS, _COLD (eviction buffer of twice the largest cache walked),
+// _WARM (one discarded priming run) or _POLLUTED (thrashing kernel over pollution_size bytes first)
+const struct cache_state_policy TASK_CACHE_STATE = {CACHE_STATE_AS_IS, 0};
+
+// EMIF event rotation: both counters of both EMIFs get the next pair of EMIF_ROTATION_EVENTS each run,
+// instead of accesses and activates. 0 = disabled, 1 = enabled
+#define EMIF_ROTATION 0
+// Number of task periods between two EMIF event vector reports
+#define EMIF_ROTATION_PERIODS 100
+
+// Per-master EMIF attribution: the MSTID filter of both EMIFs is swept over AM5728_MASTERS, one thread0 run
+// per master and per pair of events, while thread1 (and the DSPs) keep running. 0 = disabled, 1 = enabled
+#define EMIF_MSTID_SWEEP 0
+
+// EMIF chip select (region) filter applied to every EMIF measurement, reads and writes events only
+// (e.g., with EMIF_ROTATION). 0 = disabled, 1 = enabled
+#define EMIF_REGION_FILTER 0
+#define EMIF_REGION 0
+
+// Regions of the dummy task
+#define TASK_REGION       0
+#define PHASE_INIT        1
+#define PHASE_TRANSPOSE   2
+#define PHASE_REDUCTION   3
+#define NB_TASK_REGIONS   4
+
 #define DDR3A_EMIF1_BASE_ADDRESS 0x4C000000
 #define DDR3A_EMIF2_BASE_ADDRESS 0x4D000000
 
@@ -48,6 +169,28 @@
 
 void *thread0(void *arg);
 void *thread1(void *arg);
+static void region_read_counters(struct pmu_region_counters* counters);
+static void period_input(struct pmu_metrics_input* input);
+static void summary_add_period(void);
+static void locality_add_period(unsigned id);
+static void print_locality(void);
+static void print_line(char* line);
+static void phase_boundary(void);
+static void sweep_dummy_task(unsigned size);
+static void warm_dummy_task(void);
+static unsigned long long config_measure(unsigned benchmark);
+static void interleave_prepare(void);
+static int stream_alloc(void);
+static void measure_stream(void);
+static unsigned long long chase_measure(void* head, unsigned nb_hops);
+static void measure_pointer_chase(unsigned char* buffer);
+static void apply_sys_thresh_max(unsigned value);
+static void apply_mpu_thresh_max(unsigned value);
+static void apply_pr_old_count(unsigned value);
+static void apply_rd_thresh(unsigned value);
+static void apply_wr_thresh(unsigned value);
+static void aggressor_poll(unsigned idle);
+static int xcore_harvest(unsigned epoch, struct pmu_snapshot* snapshot);
 int main(int argc, char **argv);
 
 
@@ -59,48 +202,511 @@ unsigned int mat1[C_MATRIX_SIZE][C_MATRIX_SIZE];
 // Virtual address for EMIF 0 and 1
 void *ptr_emifA, *ptr_emifB;
 
+// Register blocks laid out as both EMIFs when they can't be mapped (e.g., host machine)
+static unsigned emif_simulated_regs[2][4096 / sizeof(unsigned)];
+
 // IDs for threads
 pthread_t t0_id, t1_id;
 
+// Events multiplexed over the six ARM counters for the event fingerprint of a task
+const unsigned FINGERPRINT_EVENTS[] = {0x01, 0x03, 0x04, 0x05, 0x08, 0x10, 0x12, 0x13, 0x14, 0x15,
+                                       0x16, 0x17, 0x18, 0x19, 0x1B, 0x1D, 0x60, 0x61, 0x66, 0x67};
+#define NB_FINGERPRINT_EVENTS (sizeof(FINGERPRINT_EVENTS)/sizeof(FINGERPRINT_EVENTS[0]))
+
+// Event-group scheduler used for the event fingerprint
+struct pmu_event_scheduler pmu_sched;
+
+// Statistical sampling buffer
+struct pmu_sample pmu_samples[PMU_SAMPLING_BUFFER_SIZE];
+struct pmu_sample_buffer pmu_sample_buf;
+
+// Events of counters 0 to 5 while sampling (same as arm_pmu_management.c)
+const unsigned SAMPLING_EVENTS[PMU_NB_EVT_COUNTERS] = {0x19, 0x04, 0x03, 0x16, 0x17, 0x10};
+
+// Region records ring buffer
+struct pmu_region_record region_ring[PMU_REGION_RING_SIZE];
+
+// Derived metrics of the last task periods
+struct pmu_metrics_stats task_stats;
+
+// Names of the dummy task regions in the row-buffer locality, by region identifier
+const char* const TASK_REGION_NAMES[NB_TASK_REGIONS] = {"dummy_task", "init", "transpose", "reduction"};
+
+// Matrix sizes of the dummy task for the event fingerprint sweep
+const unsigned SWEEP_SIZES[] = {128, 256, 512, C_MATRIX_SIZE};
+
+// Tasks fingerprinted by the sweep
+const struct pmu_sweep_task SWEEP_TASKS[] = {
+    {"dummy_task", sweep_dummy_task, SWEEP_SIZES, 4},
+};
+#define NB_SWEEP_TASKS (sizeof(SWEEP_TASKS)/sizeof(SWEEP_TASKS[0]))
+
+// EMIF arbitration grid, set on both EMIFs (spruhz6l Section 15.3.6.4: OCP_CONFIG and RWTHRESH)
+const unsigned SYS_THRESH_MAX_VALUES[] = {0x1, 0xF};
+const unsigned MPU_THRESH_MAX_VALUES[] = {0x1, 0xF};
+const unsigned PR_OLD_COUNT_VALUES[] = {0x20, 0xFF};
+const unsigned RD_THRESH_VALUES[] = {1, 5};
+const unsigned WR_THRESH_VALUES[] = {1, 3};
+const struct config_knob CONFIG_KNOBS[] = {
+    {"sys_thresh_max", apply_sys_thresh_max, SYS_THRESH_MAX_VALUES, 2},
+    {"mpu_thresh_max", apply_mpu_thresh_max, MPU_THRESH_MAX_VALUES, 2},
+    {"pr_old_count", apply_pr_old_count, PR_OLD_COUNT_VALUES, 2},
+    {"rd_thresh", apply_rd_thresh, RD_THRESH_VALUES, 2},
+    {"wr_thresh", apply_wr_thresh, WR_THRESH_VALUES, 2},
+};
+#define NB_CONFIG_KNOBS (sizeof(CONFIG_KNOBS)/sizeof(CONFIG_KNOBS[0]))
+
+// Benchmarks of the arbitration sweep (dummy task sizes), the critical one first
+const char* const CONFIG_BENCHMARKS[] = {"dummy_task", "dummy_task_512", "dummy_task_256"};
+const unsigned CONFIG_BENCHMARK_SIZES[] = {C_MATRIX_SIZE, 512, 256};
+#define NB_CONFIG_BENCHMARKS (sizeof(CONFIG_BENCHMARKS)/sizeof(CONFIG_BENCHMARKS[0]))
+
+struct config_sweep config_sweep;
+
+// Strides (bytes) and placement offsets in the page of the interleaving analysis. Strides above the page size
+// cross physical pages placed by Linux, so only the offsets below 4096 are placements of the physical buffer
+const unsigned INTERLEAVE_STRIDES[] = {64, 128, 256, 512, 1024, 2048, 4096, 8192};
+const unsigned INTERLEAVE_OFFSETS[] = {0, 64, 128, 256, 512};
+#define NB_INTERLEAVE_STRIDES (sizeof(INTERLEAVE_STRIDES)/sizeof(INTERLEAVE_STRIDES[0]))
+#define NB_INTERLEAVE_OFFSETS (sizeof(INTERLEAVE_OFFSETS)/sizeof(INTERLEAVE_OFFSETS[0]))
+
+// Caches cleaned before each stride kernel, so that the previous one does not leave lines of the buffer
+const struct cache_state_policy INTERLEAVE_CACHE_STATE = {CACHE_STATE_COLD, 0};
+
+// Execution time in ns. Both EMIFs: PERF_CNT_TIM at 533 MHz (DDR3-1066), 32-byte accesses (burst of 8 on a 32-bit bus),
+// 16 bytes per cycle at the peak of the two data buses
+const struct stream_platform STREAM_PLATFORM = {"am5728_a15_emif", 1000, 533, 32, 16};
+
+struct stream_arrays stream_arrays;
+// Run of highest bandwidth of each kernel
+struct stream_result stream_best[STREAM_NB_KERNELS];
+
+struct pointer_chase_point pointer_chase_points[32];
+// Memory levels of the A15 cluster: 32 KB L1D per core, 2 MB shared L2, then the EMIFs (a host has other sizes, but
+// its curve is printed as well)
+const struct pointer_chase_level AM5728_LEVELS[] = {{"l1", 32*1024}, {"l2", 2*1024*1024}, {"ddr", 0}};
+#define NB_AM5728_LEVELS (sizeof(AM5728_LEVELS)/sizeof(AM5728_LEVELS[0]))
+
+// CNTRn_CFG events rotated over the two counters of the EMIFs
+const unsigned EMIF_ROTATION_EVENTS[] = {EMIF_EVT_ACCESSES, EMIF_EVT_ACTIVATES, EMIF_EVT_READS, EMIF_EVT_WRITES,
+                                         EMIF_EVT_CMD_FIFO_FULL, EMIF_EVT_WDATA_FIFO_FULL, EMIF_EVT_RDATA_FIFO_FULL,
+                                         EMIF_EVT_RCMD_FIFO_FULL, EMIF_EVT_PRIORITY_ELEVATIONS, EMIF_EVT_CMD_PENDING,
+                                         EMIF_EVT_DATA_BUS_ACTIVE};
+#define NB_EMIF_ROTATION_EVENTS (sizeof(EMIF_ROTATION_EVENTS)/sizeof(EMIF_ROTATION_EVENTS[0]))
+
+// EMIF event scheduler of the event rotation
+struct emif_event_scheduler emif_sched;
+
+// Masters of the AM5728 (spruhz6l Table 14-10. ConnID Values)
+const struct emif_master AM5728_MASTERS[] = {
+    {"mpu", 0x0},
+    {"dsp1_mdma", 0x20},
+    {"dsp2_mdma", 0x34},
+};
+#define NB_AM5728_MASTERS (sizeof(AM5728_MASTERS)/sizeof(AM5728_MASTERS[0]))
+
+// Per-master EMIF attribution sweep
+struct emif_mstid_sweep mstid_sweep;
+
+// Exchange area between the threads, last epoch answered by the aggressor and whether it publishes its counters
+struct pmu_xcore_area xcore_area;
+unsigned xcore_last_epoch = 0;
+int xcore_publishing = 0;
+
 
 
 /* ----------------------- LOCAL FUNCTIONS DEFINITION ----------------- */
 
+// Reads the free-running ARM and EMIF performance counters for the region markers
+static void region_read_counters(struct pmu_region_counters* counters){
+    pmu_source->read(&counters->pmu);
+
+    if(ptr_emifA != NULL)
+        DDR_read_counters(ptr_emifA, ptr_emifB, counters->emif);
+    else
+        memset(counters->emif, 0, sizeof(counters->emif));
+}
+
+
+// Raw values of the last task period (ARM counters and both EMIFs)
+static void period_input(struct pmu_metrics_input* input){
+    memset(input, 0, sizeof(*input));
+
+    input->cycles = valueCf;
+    input->event_ids = counters_event_ids;
+    input->evt[0] = value0f;
+    input->evt[1] = value1f;
+    input->evt[2] = value2f;
+    input->evt[3] = value3f;
+    input->evt[4] = value4f;
+    input->evt[5] = value5f;
+
+    // Both EMIFs serve the same interleaved address space: their accesses and activates are summed
+    if(ptr_emifA != NULL && !EMIF_ROTATION && !EMIF_MSTID_SWEEP){
+        input->emif_cycles = result_ddr_cycles_emif0;
+        input->emif_accesses = (unsigned long long)result_ddr_evt0_emif0 + result_ddr_evt0_emif1;
+        input->emif_activates = (unsigned long long)result_ddr_evt1_emif0 + result_ddr_evt1_emif1;
+    }
+}
+
+
+// Adds the derived metrics of the last task period to the summary
+static void summary_add_period(void){
+    struct pmu_metrics_input input;
+
+    period_input(&input);
+
+    pmu_metrics_stats_add(&task_stats, &input);
+}
+
+
+// Prints the ACOR, row hit ratio and row switches of the last task period, and adds its metrics to the summary
+static void locality_add_period(unsigned id){
+    struct pmu_metrics_input input;
+    unsigned long long metrics[PMU_NB_METRICS];
+
+    period_input(&input);
+    pmu_metrics_compute(&input, metrics);
+    pmu_metrics_stats_add(&task_stats, &input);
+
+    printf("RL %u %llu.%03llu %llu.%03llu %llu \n", id, metrics[PMU_METRIC_ACOR] / PMU_METRIC_SCALE, metrics[PMU_METRIC_ACOR] % PMU_METRIC_SCALE,
+           metrics[PMU_METRIC_ROW_HIT_RATIO] / PMU_METRIC_SCALE, metrics[PMU_METRIC_ROW_HIT_RATIO] % PMU_METRIC_SCALE, input.emif_activates);
+}
+
+
+// Prints the row-buffer locality min/mean/max of the whole task and of each phase still in the region ring
+static void print_locality(void){
+    struct pmu_metrics_stats phase_stats;
+    unsigned id;
+
+    for(id = 0; id < NB_TASK_REGIONS; id++){
+        pmu_metrics_stats_reset(&phase_stats, TASK_REGION_NAMES[id]);
+        region_stats_add(id, counters_event_ids, &phase_stats);
+        pmu_metrics_stats_print_mask(&phase_stats, PMU_METRICS_ROW_LOCALITY, print_line);
+    }
+}
+
+
+static void print_line(char* line){
+    fputs(line, stdout);
+}
+
+
+// Phase boundary of the measured task: overflow poll point of the 64-bit counters (the sampling and multiplexing counters are not extended)
+static void phase_boundary(void){
+    if(PMU_OVERFLOW_POLLING && !PMU_SAMPLING && !PMU_MULTIPLEXING)
+        counters_poll_overflows();
+}
+
+
+// Dummy task of thread0 on a size x size matrix, for the event fingerprint sweep
+static void sweep_dummy_task(unsigned size){
+    volatile unsigned int temp = 0;
+    unsigned int i, j;
+
+    for(i = 0; i<size; i++)
+        for(j = 0; j<size; j++)
+                mat1[i][j] = i+j;
+    for(i = 0; i<size; i++)
+        for(j = 0; j<size; j++)
+                mat1[i][j] = mat1[j][i]+i;
+    for(i = 0; i<size; i++)
+        for(j = 0; j<size; j++)
+                temp = temp + mat1[j][i];
+}
+
+
+// Dummy task run by the warm cache state
+static void warm_dummy_task(void){
+    sweep_dummy_task(C_MATRIX_SIZE);
+}
+
+
+// One run of a benchmark of the arbitration sweep, from the cache state of thread0
+static unsigned long long config_measure(unsigned benchmark){
+    cache_state_prepare(&TASK_CACHE_STATE, warm_dummy_task);
+    critical_task_start_eval();
+    sweep_dummy_task(CONFIG_BENCHMARK_SIZES[benchmark]);
+    critical_task_end_eval();
+
+    return valueCf;
+}
+
+
+// Cold caches before a stride kernel of the interleaving analysis
+static void interleave_prepare(void){
+    cache_state_prepare(&INTERLEAVE_CACHE_STATE, NULL);
+}
+
+
+// Allocates and fills the STREAM arrays
+static int stream_alloc(void){
+    void* base = NULL;
+
+    if(posix_memalign(&base, 64, 3 * (STREAM_ARRAY_WORDS + STREAM_ARRAY_OFFSET_WORDS) * sizeof(unsigned)) != 0)
+        return -1;
+
+    if(stream_arrays_init(&stream_arrays, base, STREAM_ARRAY_WORDS, STREAM_ARRAY_OFFSET_WORDS) < 0){
+        free(base);
+        stream_arrays.a = NULL;
+        return -1;
+    }
+
+    // Pages mapped by stream_arrays_init, locked before the measurements
+    mlock(base, 3 * (STREAM_ARRAY_WORDS + STREAM_ARRAY_OFFSET_WORDS) * sizeof(unsigned));
+
+    return 0;
+}
+
+
+// Runs every STREAM kernel STREAM_RUNS times between two EMIF snapshots, prints each run, then the ceiling
+static void measure_stream(void){
+    struct stream_result result;
+    struct timespec begin, end;
+    unsigned kernel, i;
+
+    memset(stream_best, 0, sizeof(stream_best));
+
+    for(kernel = 0; kernel < STREAM_NB_KERNELS; kernel++)
+        for(i = 0; i < STREAM_RUNS; i++){
+            DDR_start_eval(ptr_emifA, ptr_emifB);
+            clock_gettime(CLOCK_MONOTONIC, &begin);
+            stream_run(&stream_arrays, kernel);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            DDR_end_eval(ptr_emifA, ptr_emifB);
+
+            // Both EMIFs serve the same interleaved address space: their accesses are summed
+            result.kernel = kernel;
+            result.nb_words = stream_arrays.nb_words;
+            result.time = (unsigned long long)(end.tv_sec - begin.tv_sec) * 1000000000ULL + end.tv_nsec - begin.tv_nsec;
+            result.emif_cycles = result_ddr_cycles_emif0;
+            result.emif_accesses = (unsigned long long)result_ddr_evt0_emif0 + result_ddr_evt0_emif1;
+
+            stream_print(&STREAM_PLATFORM, &result, print_line);
+            stream_ceiling_update(&STREAM_PLATFORM, stream_best, &result);
+        }
+
+    stream_print_ceiling(&STREAM_PLATFORM, stream_best, print_line);
+}
+
+
+// Time (ns) of the hops of a pointer chasing chain
+static unsigned long long chase_measure(void* head, unsigned nb_hops){
+    struct timespec begin, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    pointer_chase_sink = pointer_chase_run(head, nb_hops);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (unsigned long long)(end.tv_sec - begin.tv_sec) * 1000000000ULL + end.tv_nsec - begin.tv_nsec;
+}
+
+
+// Sweeps the working set of random chains (cache line nodes, anywhere or within a page, and page nodes), with the plateaus
+static void measure_pointer_chase(unsigned char* buffer){
+    unsigned nb_points;
+
+    nb_points = pointer_chase_sweep("random", buffer, POINTER_CHASE_SIZE, POINTER_CHASE_LINE_SIZE, 0, chase_measure, pointer_chase_points, 32, print_line);
+    pointer_chase_print_plateaus("random", pointer_chase_points, nb_points, AM5728_LEVELS, NB_AM5728_LEVELS, print_line);
+
+    nb_points = pointer_chase_sweep("row_local", buffer, POINTER_CHASE_SIZE, POINTER_CHASE_LINE_SIZE, POINTER_CHASE_ROW_WINDOW, chase_measure, pointer_chase_points, 32, print_line);
+    pointer_chase_print_plateaus("row_local", pointer_chase_points, nb_points, AM5728_LEVELS, NB_AM5728_LEVELS, print_line);
+
+    nb_points = pointer_chase_sweep("page", buffer, POINTER_CHASE_SIZE, POINTER_CHASE_PAGE_SIZE, 0, chase_measure, pointer_chase_points, 32, print_line);
+    pointer_chase_print_plateaus("page", pointer_chase_points, nb_points, AM5728_LEVELS, NB_AM5728_LEVELS, print_line);
+}
+
+
+// Knobs of the arbitration sweep
+static void apply_sys_thresh_max(unsigned value){
+    emif_bus_set_field(&emif_bus_am5728, EMIF_FIELD_SYS_THRESH_MAX, value);
+}
+
+static void apply_mpu_thresh_max(unsigned value){
+    emif_bus_set_field(&emif_bus_am5728, EMIF_FIELD_MPU_THRESH_MAX, value);
+}
+
+static void apply_pr_old_count(unsigned value){
+    emif_bus_set_field(&emif_bus_am5728, EMIF_FIELD_PR_OLD_COUNT, value);
+}
+
+static void apply_rd_thresh(unsigned value){
+    emif_bus_set_field(&emif_bus_am5728, EMIF_FIELD_RD_THRESH, value);
+}
+
+static void apply_wr_thresh(unsigned value){
+    emif_bus_set_field(&emif_bus_am5728, EMIF_FIELD_WR_THRESH, value);
+}
+
+
+// Poll point of the aggressor: publishes its counters if thread0 requested them, or as idle before sleeping
+static void aggressor_poll(unsigned idle){
+    if(!xcore_publishing)
+        return;
+
+    if(idle)
+        pmu_xcore_idle(&xcore_area, XCORE_AGGRESSOR_SLOT, &xcore_last_epoch, pmu_source->read);
+    else
+        pmu_xcore_poll(&xcore_area, XCORE_AGGRESSOR_SLOT, &xcore_last_epoch, pmu_source->read);
+}
+
+
+// Requests the aggressor counters for a new epoch. Returns 0 if they were collected, -1 otherwise
+static int xcore_harvest(unsigned epoch, struct pmu_snapshot* snapshot){
+    pmu_xcore_request(&xcore_area, epoch);
+    return pmu_xcore_collect(&xcore_area, XCORE_AGGRESSOR_SLOT, epoch, PMU_XCORE_TIMEOUT, snapshot);
+}
+
+
 void *thread0(void *arg){
 
  struct periodic_info info;
  unsigned int i,j,temp = 0, ctr = 0;
  unsigned long accum;
+ struct pmu_snapshot xcore_begin = {0}, xcore_end = {0};
+ int xcore_begin_answered = 0, xcore_end_answered = 0;
+ int mstid_complete = 0;
 
  make_periodic (T1, &info);
 
- while(1){
-    // Read the DDR memory controller PMCs for the first time
-    DDR_start_eval(ptr_emifA, ptr_emifB);
+ // The perf_event counters follow the thread which opens them
+ if(PMU_SAMPLING && pmu_perf_sampling_start(&pmu_sample_buf, SAMPLING_EVENTS) < 0)
+    printf("PMU sampling could not be started \n");
 
-    // Read the PMUs for the first time
-    critical_task_start_eval();
+ // The regions need the counters started by critical_task_start_eval
+ if(PMU_REGIONS && !PMU_SAMPLING && !PMU_MULTIPLEXING)
+    region_init(region_ring, PMU_REGION_RING_SIZE, region_read_counters);
+
+ pmu_metrics_stats_reset(&task_stats, "dummy_task");
+
+ while(1){
+    // Aggressor counters before the run (outside of the measurements)
+    if(PMU_XCORE)
+        xcore_begin_answered = (xcore_harvest(2*ctr + 1, &xcore_begin) == 0);
+
+    // Deterministic cache state before the run
+    cache_state_prepare(&TASK_CACHE_STATE, warm_dummy_task);
+
+    // Read the DDR memory controller PMCs for the first time (after programming the next pair of events when rotating)
+    if(ptr_emifA != NULL && EMIF_MSTID_SWEEP)
+        emif_mstid_start(&mstid_sweep);
+    else if(ptr_emifA != NULL && EMIF_ROTATION)
+        emif_sched_start(&emif_sched);
+    else if(ptr_emifA != NULL)
+        DDR_start_eval(ptr_emifA, ptr_emifB);
+
+    // Read the PMUs for the first time (nothing to do while sampling, the sampling counters run continuously)
+    if(PMU_MULTIPLEXING && !PMU_SAMPLING)
+        pmu_sched_start(&pmu_sched);
+    else if(!PMU_SAMPLING)
+        critical_task_start_eval();
 
     // Dummy task
+    region_begin(TASK_REGION);
+    region_begin(PHASE_INIT);
     for(i = 0; i<C_MATRIX_SIZE; i++)
         for(j = 0; j<C_MATRIX_SIZE; j++)
                 mat1[i][j] = i+j;
+    region_end(PHASE_INIT);
+    phase_boundary();
+    region_begin(PHASE_TRANSPOSE);
     for(i = 0; i<C_MATRIX_SIZE; i++)
         for(j = 0; j<C_MATRIX_SIZE; j++)
                 mat1[i][j] = mat1[j][i]+i;
+    region_end(PHASE_TRANSPOSE);
+    phase_boundary();
+    region_begin(PHASE_REDUCTION);
     for(i = 0; i<C_MATRIX_SIZE; i++)
         for(j = 0; j<C_MATRIX_SIZE; j++)
                 temp = temp + mat1[j][i];
+    region_end(PHASE_REDUCTION);
+    region_end(TASK_REGION);
 
     // Read the PMUs for the second time and calculate the execution time
-    critical_task_end_eval();
+    if(PMU_SAMPLING)
+        pmu_perf_sampling_drain();
+    else if(PMU_MULTIPLEXING)
+        pmu_sched_stop(&pmu_sched);
+    else
+        critical_task_end_eval();
 
     // Read the DDR memory controller PMCs for the second time
-    DDR_end_eval(ptr_emifA, ptr_emifB);
+    if(ptr_emifA != NULL && EMIF_MSTID_SWEEP)
+        mstid_complete = emif_mstid_stop(&mstid_sweep);
+    else if(ptr_emifA != NULL && EMIF_ROTATION)
+        emif_sched_stop(&emif_sched);
+    else if(ptr_emifA != NULL)
+        DDR_end_eval(ptr_emifA, ptr_emifB);
+
+    // Aggressor counters after the run
+    if(PMU_XCORE)
+        xcore_end_answered = (xcore_harvest(2*ctr + 2, &xcore_end) == 0);
 
     // Print the metrics
-    print_pmu_results(ctr);
-    print_emif_results(ctr);
+    if(PMU_SAMPLING){
+        // Samples folded on the host by pmu_fold_samples
+        if((ctr+1) % PMU_SAMPLING_PERIODS == 0)
+            pmu_sample_print(&pmu_sample_buf);
+    }
+    else if(PMU_REGIONS && !PMU_MULTIPLEXING){
+        // Region, depth, start (cycles), cycles, ARM events, EMIF 0 and 1 accesses, activates and utilization time
+        if((ctr+1) % PMU_REGION_PERIODS == 0){
+            // Task and phases metric, runs, min, mean, max over the periods
+            if(PMU_ROW_LOCALITY && !EMIF_REGION_FILTER && ptr_emifA != NULL)
+                print_locality();
+            region_dump();
+        }
+    }
+    else if(PMU_SUMMARY && !PMU_MULTIPLEXING){
+        // Benchmark, metric, runs, min, mean, max (ARM and EMIF metrics)
+        summary_add_period();
+        if((ctr+1) % PMU_SUMMARY_PERIODS == 0){
+            pmu_metrics_stats_print(&task_stats, print_line);
+            pmu_metrics_stats_reset(&task_stats, "dummy_task");
+        }
+    }
+    else if(PMU_XCORE && !PMU_MULTIPLEXING){
+        // Victim cycles and ARM events, then aggressor slot, cycles and ARM events during the run ("-" if it did not answer)
+        printf("%u %llu %llu %llu %llu %llu %llu %llu", ctr, valueCf, value0f, value1f, value2f, value3f, value4f, value5f);
+        if(!xcore_begin_answered || !xcore_end_answered)
+            printf(" %u - \n", XCORE_AGGRESSOR_SLOT);
+        else
+            printf(" %u %u %u %u %u %u %u %u \n", XCORE_AGGRESSOR_SLOT, xcore_end.cycles - xcore_begin.cycles,
+                   xcore_end.evt[0] - xcore_begin.evt[0], xcore_end.evt[1] - xcore_begin.evt[1], xcore_end.evt[2] - xcore_begin.evt[2],
+                   xcore_end.evt[3] - xcore_begin.evt[3], xcore_end.evt[4] - xcore_begin.evt[4], xcore_end.evt[5] - xcore_begin.evt[5]);
+    }
+    else if(!PMU_MULTIPLEXING)
+        print_pmu_results(ctr);
+    else if((ctr+1) % PMU_FINGERPRINT_PERIODS == 0){
+        // Event, raw count, coverage (per mille), scaled count
+        for(i = 0; i < pmu_sched.nb_events; i++)
+            printf("0x%02X %llu %u %llu \n", pmu_sched.event_ids[i], pmu_sched.count[i], pmu_sched_coverage_permille(&pmu_sched, i), pmu_sched_scaled_count(&pmu_sched, i));
+    }
+    if(ptr_emifA != NULL && EMIF_MSTID_SWEEP){
+        // Window, master, accesses, activates, reads, writes per 1000000 EMIF cycles
+        if(mstid_complete)
+            emif_mstid_print(&mstid_sweep, 0, print_line);
+    }
+    else if(ptr_emifA != NULL && EMIF_ROTATION){
+        // Event, then raw count, coverage (per mille) and scaled count of EMIF 0 and 1, and the read/write proportions
+        if((ctr+1) % EMIF_ROTATION_PERIODS == 0){
+            emif_sched_print(&emif_sched, "dummy_task", print_line);
+            emif_sched_init(&emif_sched, &emif_bus_am5728, EMIF_ROTATION_EVENTS, NB_EMIF_ROTATION_EVENTS);
+        }
+    }
+    else if(ptr_emifA != NULL && !(PMU_SUMMARY && !PMU_MULTIPLEXING)){
+        print_emif_results(ctr);
+
+        // Period, ACOR, row hit ratio, row switches, then every PMU_SUMMARY_PERIODS metric, runs, min, mean, max
+        // (the sample reports own the output while sampling)
+        if(PMU_ROW_LOCALITY && !PMU_SAMPLING && !EMIF_REGION_FILTER && !(PMU_REGIONS && !PMU_MULTIPLEXING)){
+            locality_add_period(ctr);
+            if((ctr+1) % PMU_SUMMARY_PERIODS == 0){
+                pmu_metrics_stats_print_mask(&task_stats, PMU_METRICS_ROW_LOCALITY, print_line);
+                pmu_metrics_stats_reset(&task_stats, "dummy_task");
+            }
+        }
+    }
 
 
     temp = 0;
@@ -120,21 +726,40 @@ void *thread1(void *arg){
 
  make_periodic (T1, &info);
 
+ // The counters of CPU 1 run freely and are published at the phase boundaries
+ if(PMU_XCORE){
+    xcore_publishing = (counters_free_run() == 0);
+    if(!xcore_publishing)
+        printf("Aggressor counters not available with the %s backend \n", pmu_source->name);
+ }
+
  while(1){
 
+    // Peak-bandwidth aggressor
+    if(AGGRESSOR_KERNEL == 1 && stream_arrays.a != NULL){
+        aggressor_poll(0);
+        stream_run(&stream_arrays, STREAM_TRIAD);
+    }
     // Dummy task
-    for(i = 0; i<C_MATRIX_SIZE; i++)
-        for(j = 0; j<C_MATRIX_SIZE; j++)
-                mat1[i][j] = i+j;
-    for(i = 0; i<C_MATRIX_SIZE; i++)
-        for(j = 0; j<C_MATRIX_SIZE; j++)
-                mat1[i][j] = mat1[j][i]+i;
-    for(i = 0; i<C_MATRIX_SIZE; i++)
-        for(j = 0; j<C_MATRIX_SIZE; j++)
-                temp = temp + mat1[j][i];
+    else{
+        aggressor_poll(0);
+        for(i = 0; i<C_MATRIX_SIZE; i++)
+            for(j = 0; j<C_MATRIX_SIZE; j++)
+                    mat1[i][j] = i+j;
+        aggressor_poll(0);
+        for(i = 0; i<C_MATRIX_SIZE; i++)
+            for(j = 0; j<C_MATRIX_SIZE; j++)
+                    mat1[i][j] = mat1[j][i]+i;
+        aggressor_poll(0);
+        for(i = 0; i<C_MATRIX_SIZE; i++)
+            for(j = 0; j<C_MATRIX_SIZE; j++)
+                    temp = temp + mat1[j][i];
+    }
 
     temp = 0;
 
+    // thread0 does not wait for the aggressor while it sleeps
+    aggressor_poll(1);
     wait_period (&info);
   }
 
@@ -144,24 +769,158 @@ void *thread1(void *arg){
 
 int main(int argc, char **argv){
 
-  // Access the memory file and extract the virtual address for both EMIFs
-  int fd = open("/dev/mem", O_RDWR);
-  ptr_emifA = mmap(NULL,4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, DDR3A_EMIF1_BASE_ADDRESS);
-  ptr_emifB = mmap(NULL,4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, DDR3A_EMIF2_BASE_ADDRESS);
+  // Access the memory file and extract the virtual address for both EMIFs, or the register blocks of emif_sim
+  const char* sim_file = getenv("EMIF_SIM_FILE");
+  int fd;
+
+  if (sim_file != NULL) {
+        // Both 4 KB register blocks of the simulator, EMIF1 first
+        fd = open(sim_file, O_RDWR);
+        ptr_emifA = mmap(NULL, 2*4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ptr_emifB = (ptr_emifA == MAP_FAILED) ? MAP_FAILED : (unsigned char*)ptr_emifA + 4096;
+        if (ptr_emifA != MAP_FAILED)
+            printf("EMIF registers mapped from %s \n", sim_file);
+  }
+  else {
+        fd = open("/dev/mem", O_RDWR);
+        ptr_emifA = mmap(NULL,4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, DDR3A_EMIF1_BASE_ADDRESS);
+        ptr_emifB = mmap(NULL,4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, DDR3A_EMIF2_BASE_ADDRESS);
+  }
 
   if (ptr_emifA == MAP_FAILED || ptr_emifB == MAP_FAILED) {
         perror("Can't map memory");
+#if PMU_BACKEND == PMU_BACKEND_ARMV7
         return -1;
+#else
+        // Not an AM5728 (e.g., host machine) and no emif_sim: the EMIF code runs against static register blocks
+        printf("EMIF registers simulated \n");
+        ptr_emifA = emif_simulated_regs[0];
+        ptr_emifB = emif_simulated_regs[1];
+#endif
   }
 
-  close(fd);
+  if (fd >= 0)
+        close(fd);
 
   // Configure the EMIFs
-  DDR_configure_eval(1, ptr_emifA, ptr_emifB); // 1 = Filter by master enabled
+  if (ptr_emifA != NULL){
+        DDR_configure_eval(1, ptr_emifA, ptr_emifB); // 1 = Filter by master enabled
+        DDR_configure_region(EMIF_REGION_FILTER, EMIF_REGION, ptr_emifA, ptr_emifB);
+  }
+
+  // Prepare the EMIF event rotation on the bus set by DDR_configure_eval (the master filters set above are kept)
+  emif_sched_init(&emif_sched, &emif_bus_am5728, EMIF_ROTATION_EVENTS, NB_EMIF_ROTATION_EVENTS);
+  emif_mstid_init(&mstid_sweep, &emif_bus_am5728, AM5728_MASTERS, NB_AM5728_MASTERS);
 
   // Configure ARM Cortex A15 performance counters
   counters_init();
 
+  // Measure the probe cost, which is then removed from every PMU measurement
+  counters_calibrate(PMU_CALIBRATION_RUNS);
+  printf("PMU probe cost (subtracted): %u %u %u %u %u %u %u \n", pmu_overhead.cycles, pmu_overhead.evt[0], pmu_overhead.evt[1], pmu_overhead.evt[2], pmu_overhead.evt[3], pmu_overhead.evt[4], pmu_overhead.evt[5]);
+
+  if(PMU_EVENT_SWEEP){
+        // Task sizes, cycles per run, non-zero events (count per size, growth exponent), dead events
+        pmu_sweep_run(pmu_source, SWEEP_TASKS, NB_SWEEP_TASKS, print_line);
+        return 0;
+  }
+
+  if(CONFIG_SWEEP && ptr_emifA != NULL){
+        // Arbitration registers of both EMIFs, restored after the sweep
+        unsigned lat_config[2], rwthresh[2], e;
+        for(e = 0; e < 2; e++){
+            lat_config[e] = *emif_reg(&emif_bus_am5728.controller[e], emif_bus_am5728.controller[e].regs->lat_config);
+            rwthresh[e] = *emif_reg(&emif_bus_am5728.controller[e], emif_bus_am5728.controller[e].regs->rwthresh);
+        }
+
+        if(cache_state_init(NULL, 0) < 0)
+            printf("Cache state buffer could not be allocated \n");
+
+        // Rank, settings, then worst and mean execution time of each benchmark
+        if(config_sweep_init(&config_sweep, CONFIG_KNOBS, NB_CONFIG_KNOBS, CONFIG_BENCHMARKS, NB_CONFIG_BENCHMARKS, 0) < 0)
+            printf("Configuration grid too large \n");
+        else{
+            config_sweep_run(&config_sweep, config_measure, CONFIG_SWEEP_RUNS);
+            config_sweep_print(&config_sweep, print_line);
+        }
+
+        for(e = 0; e < 2; e++){
+            *emif_reg(&emif_bus_am5728.controller[e], emif_bus_am5728.controller[e].regs->lat_config) = lat_config[e];
+            *emif_reg(&emif_bus_am5728.controller[e], emif_bus_am5728.controller[e].regs->rwthresh) = rwthresh[e];
+        }
+        return 0;
+  }
+
+  if(EMIF_INTERLEAVE_ANALYSIS && ptr_emifA != NULL){
+        void* buffer = NULL;
+
+        if(cache_state_init(NULL, 0) < 0)
+            printf("Cache state buffer could not be allocated \n");
+
+        if(posix_memalign(&buffer, 4096, INTERLEAVE_BUFFER_SIZE) != 0){
+            printf("Interleaving buffer could not be allocated \n");
+            return -1;
+        }
+
+        // Pages mapped and locked before the measurements
+        memset(buffer, 0, INTERLEAVE_BUFFER_SIZE);
+        mlock(buffer, INTERLEAVE_BUFFER_SIZE);
+
+        // Offset, stride, words accessed, then access and activate shares (per mille) and accesses per 1000 EMIF cycles of EMIF 0 and 1, balance
+        printf("%u imbalanced runs \n", emif_interleave_sweep(&emif_bus_am5728, buffer, INTERLEAVE_BUFFER_SIZE, INTERLEAVE_OFFSETS, NB_INTERLEAVE_OFFSETS,
+                                                              INTERLEAVE_STRIDES, NB_INTERLEAVE_STRIDES, interleave_prepare, print_line));
+
+        free(buffer);
+        return 0;
+  }
+
+  if(STREAM_BANDWIDTH && ptr_emifA != NULL){
+        if(stream_alloc() < 0){
+            printf("STREAM arrays could not be allocated \n");
+            return -1;
+        }
+
+        // Kernel, bytes, time (ns), MB/s, EMIF 0 cycles, accesses of both EMIFs, EMIF MB/s, data bus utilization (per mille), then the ceiling
+        measure_stream();
+        return 0;
+  }
+
+  if(POINTER_CHASE_LATENCY){
+        void* buffer = NULL;
+
+        if(posix_memalign(&buffer, POINTER_CHASE_PAGE_SIZE, POINTER_CHASE_SIZE) != 0){
+            printf("Pointer chasing buffer could not be allocated \n");
+            return -1;
+        }
+
+        // Pages mapped and locked before the measurements
+        memset(buffer, 0, POINTER_CHASE_SIZE);
+        mlock(buffer, POINTER_CHASE_SIZE);
+
+        // Sweep, working set (bytes), node granularity, window, hops, time (ns), ns per hop, then the plateau of each level
+        measure_pointer_chase(buffer);
+
+        free(buffer);
+        return 0;
+  }
+
+  // Arrays of the peak-bandwidth aggressor
+  if(AGGRESSOR_KERNEL == 1 && stream_alloc() < 0)
+        printf("STREAM arrays could not be allocated, thread1 runs the dummy task \n");
+
+  // Eviction buffer sized from the cache geometry (sysfs)
+  if(cache_state_init(NULL, 0) < 0)
+        printf("Cache state buffer could not be allocated \n");
+
+  // Clear the exchange area before the threads start
+  pmu_xcore_init(&xcore_area);
+
+  // Prepare the event fingerprint
+  pmu_sched_init(&pmu_sched, pmu_source, FINGERPRINT_EVENTS, NB_FINGERPRINT_EVENTS);
+
+  // Prepare the statistical sampling
+  pmu_sample_buffer_init(&pmu_sample_buf, pmu_samples, PMU_SAMPLING_BUFFER_SIZE, PMU_SAMPLING_COUNTER, PMU_SAMPLING_PERIOD);
+
   // set CPU affinity of task 1
   cpu_set_t t0_mask;
   CPU_ZERO(&t0_mask);    // clear all CPUs
@@ -205,11 +964,20 @@ int main(int argc, char **argv){
 
   // Create task 0
   errno = pthread_create(&t0_id, &t0_attr, &thread0, NULL);
+  if (errno == EPERM) {
+        // No real-time privileges (e.g., host machine without root): default scheduling
+        pthread_attr_setinheritsched(&t0_attr, PTHREAD_INHERIT_SCHED);
+        errno = pthread_create(&t0_id, &t0_attr, &thread0, NULL);
+  }
   if (errno)
   	printf("task0 pthread_create error %u \n", errno);
 
   // Create task 1
   errno = pthread_create(&t1_id, &t1_attr, &thread1, NULL);
+  if (errno == EPERM) {
+        pthread_attr_setinheritsched(&t1_attr, PTHREAD_INHERIT_SCHED);
+        errno = pthread_create(&t1_id, &t1_attr, &thread1, NULL);
+  }
   if (errno)
         printf("task1 pthread_create error %u \n", errno);
 
@@ -0,0 +1,71 @@
+/*--------------------------- pmu_counter64.c ----------------------------
+ |  File pmu_counter64.c
+ |
+ |  Description: The functions definition for the 64-bit extension of
+ |               the PMU counters are done here
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include "pmu_counter64.h"
+
+// Value added to the upper part for every wrap of a 32-bit counter
+#define PMU_WRAP_VALUE  0x100000000ULL
+
+
+void pmu_wrap_reset(struct pmu_wrap_tracker* tracker){
+    unsigned i;
+
+    tracker->cycles_high = 0;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        tracker->evt_high[i] = 0;
+}
+
+
+void pmu_wrap_account(struct pmu_wrap_tracker* tracker, unsigned overflow_flags){
+    unsigned i;
+
+    if(overflow_flags & PMU_OVF_CYCLE_FLAG)
+        tracker->cycles_high += PMU_WRAP_VALUE;
+
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        if(overflow_flags & (1u << i))
+            tracker->evt_high[i] += PMU_WRAP_VALUE;
+}
+
+
+unsigned pmu_wrap_poll(struct pmu_wrap_tracker* tracker, unsigned overflow_flags, const struct pmu_snapshot* raw){
+    unsigned accounted = 0;
+    unsigned i;
+
+    // A wrapped counter restarts from 0: a value in the lower half means the wrap happened before the read
+    if((overflow_flags & PMU_OVF_CYCLE_FLAG) && raw->cycles < 0x80000000)
+        accounted |= PMU_OVF_CYCLE_FLAG;
+
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        if((overflow_flags & (1u << i)) && raw->evt[i] < 0x80000000)
+            accounted |= (1u << i);
+
+    pmu_wrap_account(tracker, accounted);
+
+    return accounted;
+}
+
+
+void pmu_wrap_extend(const struct pmu_wrap_tracker* tracker, const struct pmu_snapshot* raw, struct pmu_snapshot64* extended){
+    unsigned i;
+
+    extended->cycles = tracker->cycles_high + raw->cycles;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        extended->evt[i] = tracker->evt_high[i] + raw->evt[i];
+}
+
+
+void pmu_subtract_overhead64(struct pmu_snapshot64* snapshot, const struct pmu_snapshot* overhead){
+    unsigned i;
+
+    snapshot->cycles = (snapshot->cycles > overhead->cycles) ? snapshot->cycles - overhead->cycles : 0;
+
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        snapshot->evt[i] = (snapshot->evt[i] > overhead->evt[i]) ? snapshot->evt[i] - overhead->evt[i] : 0;
+}
@@ -0,0 +1,102 @@
+/*--------------------------- pmu_event_scheduler.c ----------------------
+ |  File pmu_event_scheduler.c
+ |
+ |  Description: The functions definition for the PMU event-group
+ |               multiplexing are done here
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include "pmu_event_scheduler.h"
+
+
+// Number of events of a group (the last group can be smaller)
+static unsigned group_length(const struct pmu_event_scheduler* sched, unsigned group){
+    unsigned first = group * PMU_NB_EVT_COUNTERS;
+    unsigned left = sched->nb_events - first;
+
+    return (left < PMU_NB_EVT_COUNTERS) ? left : PMU_NB_EVT_COUNTERS;
+}
+
+
+int pmu_sched_init(struct pmu_event_scheduler* sched, const struct pmu_counter_source* source, const unsigned* event_ids, unsigned nb_events){
+    unsigned i;
+
+    if(nb_events > PMU_SCHED_MAX_EVENTS)
+        return -1;
+
+    sched->source = source;
+    sched->nb_events = nb_events;
+
+    for(i = 0; i < nb_events; i++){
+        sched->event_ids[i] = event_ids[i];
+        sched->count[i] = 0;
+        sched->counted_cycles[i] = 0;
+        sched->runs[i] = 0;
+    }
+
+    sched->total_cycles = 0;
+    sched->total_runs = 0;
+    sched->nb_groups = (nb_events + PMU_NB_EVT_COUNTERS - 1) / PMU_NB_EVT_COUNTERS;
+    sched->current_group = 0;
+
+    return 0;
+}
+
+
+void pmu_sched_start(struct pmu_event_scheduler* sched){
+    unsigned first = sched->current_group * PMU_NB_EVT_COUNTERS;
+
+    // Only the cycle counter is needed when there are no events
+    if(sched->nb_groups > 0)
+        sched->source->init(&sched->event_ids[first], group_length(sched, sched->current_group));
+
+    sched->source->start();
+}
+
+
+void pmu_sched_stop(struct pmu_event_scheduler* sched){
+    struct pmu_snapshot snapshot;
+
+    sched->source->stop(&snapshot);
+    pmu_sched_account(sched, &snapshot);
+}
+
+
+void pmu_sched_account(struct pmu_event_scheduler* sched, const struct pmu_snapshot* snapshot){
+    unsigned first = sched->current_group * PMU_NB_EVT_COUNTERS;
+    unsigned i;
+
+    sched->total_cycles += snapshot->cycles;
+    sched->total_runs++;
+
+    if(sched->nb_groups == 0)
+        return;
+
+    for(i = 0; i < group_length(sched, sched->current_group); i++){
+        sched->count[first + i] += snapshot->evt[i];
+        sched->counted_cycles[first + i] += snapshot->cycles;
+        sched->runs[first + i]++;
+    }
+
+    // Next group (round robin)
+    sched->current_group = (sched->current_group + 1) % sched->nb_groups;
+}
+
+
+unsigned pmu_sched_coverage_permille(const struct pmu_event_scheduler* sched, unsigned index){
+    if(sched->total_cycles == 0)
+        return 0;
+
+    return (unsigned)((sched->counted_cycles[index] * 1000) / sched->total_cycles);
+}
+
+
+unsigned long long pmu_sched_scaled_count(const struct pmu_event_scheduler* sched, unsigned index){
+    if(sched->counted_cycles[index] == 0)
+        return 0;
+
+    // Scaled in two steps to limit the risk of a 64-bit overflow on long runs
+    return (sched->count[index] / sched->counted_cycles[index]) * sched->total_cycles +
+           ((sched->count[index] % sched->counted_cycles[index]) * sched->total_cycles) / sched->counted_cycles[index];
+}
@@ -0,0 +1,167 @@
+/*--------------------------- pmu_event_sweep.c --------------------------
+ |  File pmu_event_sweep.c
+ |
+ |  Description: The functions definition for the event fingerprint
+ |               sweep are done here
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "pmu_event_sweep.h"
+#include "pmu_event_scheduler.h"
+
+// Events printed per dead events line
+#define DEAD_EVENTS_PER_LINE 16
+
+
+// Rotates the groups of the whole event space
+static struct pmu_event_scheduler sweep_sched;
+
+// Events of the event space and their counts per size for the current task
+static unsigned all_events[PMU_SWEEP_NB_EVENTS];
+static unsigned long long counts[PMU_SWEEP_MAX_SIZES][PMU_SWEEP_NB_EVENTS];
+static unsigned long long cycles[PMU_SWEEP_MAX_SIZES];
+
+// Events seen non-zero by at least one task
+static unsigned char alive[PMU_SWEEP_NB_EVENTS];
+
+
+// Base 2 logarithm in 1/256 units of a non-zero value, integer only
+static int log2_q8(unsigned long long x){
+    unsigned long long mantissa;
+    int msb = 63, result, i;
+
+    while(!(x >> msb))
+        msb--;
+
+    // Mantissa in [1, 2) with 30 fractional bits
+    mantissa = (msb >= 30) ? x >> (msb - 30) : x << (30 - msb);
+    result = msb * 256;
+
+    // One fractional bit per squaring
+    for(i = 7; i >= 0; i--){
+        mantissa = (mantissa * mantissa) >> 30;
+        if(mantissa >= (2ULL << 30)){
+            mantissa >>= 1;
+            result += 1 << i;
+        }
+    }
+
+    return result;
+}
+
+
+// Writes the growth exponent of an event count with the problem size ("-" when it cannot be computed)
+static int print_growth(char* str, unsigned length, const struct pmu_sweep_task* task, unsigned event){
+    unsigned long long first = counts[0][event], last = counts[task->nb_sizes - 1][event];
+    int size_log, exponent;
+
+    if(task->nb_sizes < 2 || first == 0 || last == 0 || task->sizes[task->nb_sizes - 1] <= task->sizes[0])
+        return snprintf(str, length, " -");
+
+    size_log = log2_q8(task->sizes[task->nb_sizes - 1]) - log2_q8(task->sizes[0]);
+    exponent = (log2_q8(last) - log2_q8(first)) * 100 / size_log;
+
+    return snprintf(str, length, " %s%d.%02d", (exponent < 0) ? "-" : "", ((exponent < 0) ? -exponent : exponent) / 100, ((exponent < 0) ? -exponent : exponent) % 100);
+}
+
+
+// Measures every event group of the event space for each size of a task
+static void sweep_task(const struct pmu_counter_source* source, const struct pmu_sweep_task* task){
+    unsigned s, g, i;
+
+    for(s = 0; s < task->nb_sizes; s++){
+        pmu_sched_init(&sweep_sched, source, all_events, PMU_SWEEP_NB_EVENTS);
+
+        for(g = 0; g < sweep_sched.nb_groups; g++){
+            pmu_sched_start(&sweep_sched);
+            task->run(task->sizes[s]);
+            pmu_sched_stop(&sweep_sched);
+        }
+
+        // A single run per group: the totals are the counts of one run
+        for(i = 0; i < PMU_SWEEP_NB_EVENTS; i++)
+            counts[s][i] = sweep_sched.count[i];
+        cycles[s] = sweep_sched.total_cycles / sweep_sched.total_runs;
+    }
+}
+
+
+void pmu_sweep_run(const struct pmu_counter_source* source, const struct pmu_sweep_task* tasks, unsigned nb_tasks, void (*write_line)(char* line)){
+    const struct pmu_sweep_task* task;
+    unsigned t, s, i, nb_dead, length;
+    char line[256];
+    int non_zero;
+
+    for(i = 0; i < PMU_SWEEP_NB_EVENTS; i++){
+        all_events[i] = i;
+        alive[i] = 0;
+    }
+
+    for(t = 0; t < nb_tasks; t++){
+        task = &tasks[t];
+        if(task->nb_sizes == 0 || task->nb_sizes > PMU_SWEEP_MAX_SIZES)
+            continue;
+
+        sweep_task(source, task);
+
+        length = snprintf(line, sizeof(line), "T %s", task->name);
+        for(s = 0; s < task->nb_sizes; s++)
+            length += snprintf(line + length, sizeof(line) - length, " %u", task->sizes[s]);
+        snprintf(line + length, sizeof(line) - length, " \n\r");
+        write_line(line);
+
+        length = snprintf(line, sizeof(line), "C %s", task->name);
+        for(s = 0; s < task->nb_sizes; s++)
+            length += snprintf(line + length, sizeof(line) - length, " %llu", cycles[s]);
+        snprintf(line + length, sizeof(line) - length, " \n\r");
+        write_line(line);
+
+        nb_dead = 0;
+        for(i = 0; i < PMU_SWEEP_NB_EVENTS; i++){
+            non_zero = 0;
+            for(s = 0; s < task->nb_sizes; s++)
+                if(counts[s][i] != 0)
+                    non_zero = 1;
+
+            if(!non_zero){
+                nb_dead++;
+                continue;
+            }
+            alive[i] = 1;
+
+            length = snprintf(line, sizeof(line), "F %s 0x%02X", task->name, i);
+            for(s = 0; s < task->nb_sizes; s++)
+                length += snprintf(line + length, sizeof(line) - length, " %llu", counts[s][i]);
+            length += print_growth(line + length, sizeof(line) - length, task, i);
+            snprintf(line + length, sizeof(line) - length, " \n\r");
+            write_line(line);
+        }
+
+        snprintf(line, sizeof(line), "Z %s %u \n\r", task->name, nb_dead);
+        write_line(line);
+    }
+
+    // Events never counted by any task
+    length = 0;
+    nb_dead = 0;
+    for(i = 0; i < PMU_SWEEP_NB_EVENTS; i++){
+        if(alive[i])
+            continue;
+
+        if(nb_dead % DEAD_EVENTS_PER_LINE == 0)
+            length = snprintf(line, sizeof(line), "D");
+        length += snprintf(line + length, sizeof(line) - length, " 0x%02X", i);
+        nb_dead++;
+
+        if(nb_dead % DEAD_EVENTS_PER_LINE == 0){
+            snprintf(line + length, sizeof(line) - length, " \n\r");
+            write_line(line);
+        }
+    }
+    if(nb_dead % DEAD_EVENTS_PER_LINE != 0){
+        snprintf(line + length, sizeof(line) - length, " \n\r");
+        write_line(line);
+    }
+}
@@ -0,0 +1,284 @@
+/*--------------------------- pmu_fold_samples.c -------------------------
+ |  File pmu_fold_samples.c
+ |
+ |  Description: Host tool folding the statistical samples printed by
+ |               pmu_sample_print (Linux stdout or bare-metal UART log)
+ |               into a per-function and a per-address profile, so that
+ |               the memory-hot loops of a task can be found.
+ |               The symbols are read with nm (NM environment variable,
+ |               e.g., NM=arm-none-eabi-nm for a bare-metal executable).
+ |
+ |               Usage: pmu_fold_samples <executable> [top] < samples.txt
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// Default number of addresses in the per-address profile
+#define DEFAULT_TOP_ADDRESSES 20
+
+// Number of event counters of a sample
+#define NB_EVT 6
+
+struct symbol{
+    unsigned long address;
+    char name[128];
+};
+
+struct sample{
+    unsigned long pc;
+    unsigned long long cycles;
+    unsigned long long evt[NB_EVT];
+};
+
+// A folded profile line (function or address)
+struct bucket{
+    unsigned long key;
+    const struct symbol* sym;
+    unsigned long nb_samples;
+    unsigned long long cycles;
+    unsigned long long evt[NB_EVT];
+};
+
+
+static struct symbol* symbols = NULL;
+static unsigned long nb_symbols = 0;
+
+static struct sample* samples = NULL;
+static unsigned long nb_samples = 0;
+
+
+/* load_symbols
+ *
+ * Description: Reads the text symbols of an executable through nm, sorted by address
+ *
+ * Parameter:
+ *              - const char* executable: Executable the samples come from
+ *
+ * Returns:     0 on success, -1 otherwise
+ *
+ * */
+static int load_symbols(const char* executable){
+    const char* nm = getenv("NM") ? getenv("NM") : "nm";
+    char command[512], line[512], type;
+    unsigned long capacity = 0, address;
+    struct symbol* s;
+    FILE* f;
+
+    snprintf(command, sizeof(command), "%s -n --defined-only '%s'", nm, executable);
+    f = popen(command, "r");
+    if(f == NULL)
+        return -1;
+
+    while(fgets(line, sizeof(line), f) != NULL){
+        if(nb_symbols == capacity){
+            capacity = capacity ? 2 * capacity : 1024;
+            symbols = realloc(symbols, capacity * sizeof(*symbols));
+        }
+
+        s = &symbols[nb_symbols];
+        if(sscanf(line, "%lx %c %127s", &address, &type, s->name) != 3)
+            continue;
+
+        // Code symbols only
+        if(type != 'T' && type != 't' && type != 'W' && type != 'w')
+            continue;
+
+        s->address = address;
+        nb_symbols++;
+    }
+
+    return (pclose(f) == 0 && nb_symbols > 0) ? 0 : -1;
+}
+
+
+// Symbol containing an address (the closest one below it), NULL if none
+static const struct symbol* find_symbol(unsigned long address){
+    unsigned long low = 0, high = nb_symbols;
+
+    while(low < high){
+        unsigned long mid = (low + high) / 2;
+
+        if(symbols[mid].address <= address)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low ? &symbols[low - 1] : NULL;
+}
+
+
+static const struct symbol* find_symbol_by_name(const char* name){
+    unsigned long i;
+
+    for(i = 0; i < nb_symbols; i++)
+        if(strcmp(symbols[i].name, name) == 0)
+            return &symbols[i];
+
+    return NULL;
+}
+
+
+/* read_samples
+ *
+ * Description: Reads the sample lines. The PCs are moved to the executable addresses with the
+ *              reference symbol lines, which covers the position independent executables.
+ *
+ * Parameter:
+ *              - FILE* f: Samples log
+ *              - unsigned long* nb_lost: Where the number of samples lost is written
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void read_samples(FILE* f, unsigned long* nb_lost){
+    unsigned long capacity = 0, bias = 0, address, lost;
+    char line[512], name[128];
+    const struct symbol* reference;
+    unsigned cycles, evt[NB_EVT];
+    struct sample* s;
+    unsigned i;
+
+    *nb_lost = 0;
+
+    while(fgets(line, sizeof(line), f) != NULL){
+        if(sscanf(line, " M %127s %lx", name, &address) == 2){
+            reference = find_symbol_by_name(name);
+            bias = reference ? address - reference->address : 0;
+        }
+        else if(sscanf(line, " L %lu", &lost) == 1)
+            *nb_lost += lost;
+        else if(sscanf(line, " S %lx %u %u %u %u %u %u %u", &address, &cycles, &evt[0], &evt[1], &evt[2], &evt[3], &evt[4], &evt[5]) == 8){
+            if(nb_samples == capacity){
+                capacity = capacity ? 2 * capacity : 4096;
+                samples = realloc(samples, capacity * sizeof(*samples));
+            }
+
+            s = &samples[nb_samples++];
+            s->pc = address - bias;
+            s->cycles = cycles;
+            for(i = 0; i < NB_EVT; i++)
+                s->evt[i] = evt[i];
+        }
+    }
+}
+
+
+static int compare_pc(const void* a, const void* b){
+    unsigned long pa = ((const struct sample*)a)->pc, pb = ((const struct sample*)b)->pc;
+
+    return (pa > pb) - (pa < pb);
+}
+
+
+static int compare_bucket(const void* a, const void* b){
+    unsigned long na = ((const struct bucket*)a)->nb_samples, nb = ((const struct bucket*)b)->nb_samples;
+
+    return (na < nb) - (na > nb);
+}
+
+
+/* fold
+ *
+ * Description: Folds the samples (sorted by PC) into buckets, either by function or by address
+ *
+ * Parameter:
+ *              - int by_function: 1 = one bucket per function, 0 = one bucket per address
+ *              - unsigned long* nb_buckets: Where the number of buckets is written
+ *
+ * Returns:     The buckets, sorted by decreasing number of samples
+ *
+ * */
+static struct bucket* fold(int by_function, unsigned long* nb_buckets){
+    struct bucket* buckets = calloc(nb_samples ? nb_samples : 1, sizeof(*buckets));
+    struct bucket* b = NULL;
+    const struct symbol* sym;
+    unsigned long i, key;
+    unsigned j;
+
+    *nb_buckets = 0;
+
+    for(i = 0; i < nb_samples; i++){
+        sym = find_symbol(samples[i].pc);
+        key = by_function ? (sym ? sym->address : 0) : samples[i].pc;
+
+        if(b == NULL || b->key != key){
+            b = &buckets[(*nb_buckets)++];
+            b->key = key;
+            b->sym = sym;
+        }
+
+        b->nb_samples++;
+        b->cycles += samples[i].cycles;
+        for(j = 0; j < NB_EVT; j++)
+            b->evt[j] += samples[i].evt[j];
+    }
+
+    qsort(buckets, *nb_buckets, sizeof(*buckets), compare_bucket);
+    return buckets;
+}
+
+
+static void print_bucket(const struct bucket* b, const char* location){
+    unsigned j;
+
+    printf("%8lu %6.2f%% %12llu", b->nb_samples, 100.0 * b->nb_samples / nb_samples, b->cycles);
+    for(j = 0; j < NB_EVT; j++)
+        printf(" %10llu", b->evt[j]);
+    printf("  %s\n", location);
+}
+
+
+int main(int argc, char **argv){
+    unsigned long nb_lost, nb_buckets, top, i;
+    struct bucket* buckets;
+    char location[192];
+
+    if(argc < 2){
+        fprintf(stderr, "Usage: %s <executable> [top] < samples.txt\n", argv[0]);
+        return 1;
+    }
+
+    top = (argc > 2) ? strtoul(argv[2], NULL, 0) : DEFAULT_TOP_ADDRESSES;
+
+    if(load_symbols(argv[1]) < 0){
+        fprintf(stderr, "No symbols found in %s\n", argv[1]);
+        return 1;
+    }
+
+    read_samples(stdin, &nb_lost);
+    if(nb_samples == 0){
+        fprintf(stderr, "No samples\n");
+        return 1;
+    }
+
+    qsort(samples, nb_samples, sizeof(*samples), compare_pc);
+
+    printf("%lu samples, %lu lost\n\n", nb_samples, nb_lost);
+
+    printf("Function profile\n");
+    printf(" samples      %%       cycles       evt0       evt1       evt2       evt3       evt4       evt5  function\n");
+    buckets = fold(1, &nb_buckets);
+    for(i = 0; i < nb_buckets; i++)
+        print_bucket(&buckets[i], buckets[i].sym ? buckets[i].sym->name : "??");
+    free(buckets);
+
+    printf("\nAddress profile (top %lu)\n", top);
+    printf(" samples      %%       cycles       evt0       evt1       evt2       evt3       evt4       evt5  address\n");
+    buckets = fold(0, &nb_buckets);
+    for(i = 0; i < nb_buckets && i < top; i++){
+        if(buckets[i].sym)
+            snprintf(location, sizeof(location), "%lx %s+0x%lx", buckets[i].key, buckets[i].sym->name, buckets[i].key - buckets[i].sym->address);
+        else
+            snprintf(location, sizeof(location), "%lx ??", buckets[i].key);
+        print_bucket(&buckets[i], location);
+    }
+    free(buckets);
+
+    return 0;
+}
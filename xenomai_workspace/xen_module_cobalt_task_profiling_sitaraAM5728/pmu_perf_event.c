@@ -0,0 +1,425 @@
+/*--------------------------- pmu_perf_event.c ---------------------------
+ |  File pmu_perf_event.c
+ |
+ |  Description: The functions definition for the Linux perf_event
+ |               counter source are done here.
+ |               The cycle counter is the group leader and the events are
+ |               its members, so that all of them are scheduled together.
+ |               Three reading modes are used, from the cheapest one:
+ |                - rdpmc (x86 only): the counters run permanently and are
+ |                  read from User mode through the mmap'd page of each
+ |                  event (no system call per probe),
+ |                - group read: the group is enabled/disabled through
+ |                  ioctl and read with a single read() (PERF_FORMAT_GROUP),
+ |                - software: no hardware counter is available (virtual
+ |                  machine, container...), the task clock (ns) replaces
+ |                  the cycles and the events read 0.
+ |               The counters only follow the thread that opened them: they
+ |               are opened again when the probes are used from another
+ |               thread.
+ |
+ |  Version: 1.6
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "pmu_perf_event.h"
+
+
+// Reading modes
+#define PERF_MODE_NONE      0
+#define PERF_MODE_RDPMC     1
+#define PERF_MODE_GROUP     2
+#define PERF_MODE_SOFTWARE  3
+
+// Counters of the group: cycles (leader) then the event counters
+#define PERF_NB_COUNTERS (1 + PMU_NB_EVT_COUNTERS)
+
+static unsigned mode = PERF_MODE_NONE;
+
+// File descriptor of each counter (-1 if not available). Index 0 is the group leader
+static int fd[PERF_NB_COUNTERS] = {-1, -1, -1, -1, -1, -1, -1};
+
+// Position of each counter inside the group read buffer (0 if not available, the leader is 1)
+static unsigned pos[PERF_NB_COUNTERS];
+
+// Number of counters in the group, leader included
+static unsigned group_size = 0;
+
+// Self-monitoring page of each counter (rdpmc mode only)
+static struct perf_event_mmap_page* page[PERF_NB_COUNTERS];
+
+// Counter values at the start probe (rdpmc mode only)
+static unsigned long long start_value[PERF_NB_COUNTERS];
+
+// 64-bit counts since the start probe at the last read, truncated to 32 bits in the snapshot
+static unsigned long long last_value[PERF_NB_COUNTERS];
+
+// Thread followed by the counters and events it was opened with
+static pid_t owner = 0;
+static unsigned owner_events[PMU_NB_EVT_COUNTERS];
+static unsigned owner_nb_events = 0;
+
+
+/* perf_event_open
+ *
+ * Description: System call wrapper (glibc does not provide one)
+ *
+ * */
+static int perf_event_open(struct perf_event_attr* attr, pid_t pid, int cpu, int group_fd, unsigned long flags){
+    return (int)syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+
+int a15_event_to_perf(unsigned event_id, struct perf_event_attr* attr){
+#if defined(__arm__) || defined(__aarch64__)
+    // The generic events are not the A15 ones (e.g., bus cycles is 0x1D, not the 0x19 bus access): raw event numbers only
+    attr->type = PERF_TYPE_RAW;
+    attr->config = event_id;
+    return 0;
+#else
+    const unsigned long long L1D = PERF_COUNT_HW_CACHE_L1D;
+    const unsigned long long L1I = PERF_COUNT_HW_CACHE_L1I;
+    const unsigned long long LL = PERF_COUNT_HW_CACHE_LL;
+    const unsigned long long READ = PERF_COUNT_HW_CACHE_OP_READ << 8;
+    const unsigned long long ACCESS = (unsigned long long)PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16;
+    const unsigned long long MISS = (unsigned long long)PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+
+    attr->type = PERF_TYPE_HARDWARE;
+
+    switch(event_id){
+        case 0x08: attr->config = PERF_COUNT_HW_INSTRUCTIONS; return 0;
+        case 0x10: attr->config = PERF_COUNT_HW_BRANCH_MISSES; return 0;
+        case 0x11: attr->config = PERF_COUNT_HW_CPU_CYCLES; return 0;
+        case 0x12: attr->config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS; return 0;
+        case 0x19: attr->config = PERF_COUNT_HW_BUS_CYCLES; return 0;
+    }
+
+    attr->type = PERF_TYPE_HW_CACHE;
+
+    switch(event_id){
+        case 0x01: attr->config = L1I | READ | MISS; return 0;
+        case 0x03: attr->config = L1D | READ | MISS; return 0;
+        case 0x04: attr->config = L1D | READ | ACCESS; return 0;
+        case 0x14: attr->config = L1I | READ | ACCESS; return 0;
+        case 0x16: attr->config = LL | READ | ACCESS; return 0;
+        case 0x17: attr->config = LL | READ | MISS; return 0;
+    }
+
+    return -1;
+#endif
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+/* read_pmc
+ *
+ * Description: Reads a hardware counter from User mode with rdpmc. The User mode reads are only implemented for x86:
+ *              other architectures may also set cap_user_rdpmc (e.g., arm64 with kernel.perf_user_access = 1), but
+ *              they are read with read() (try_self_monitoring fails for them)
+ *
+ * */
+static inline unsigned long long read_pmc(unsigned index){
+    unsigned low, high;
+    __asm__ __volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(index));
+    return ((unsigned long long)high << 32) | low;
+}
+#endif
+
+
+/* read_self_monitoring
+ *
+ * Description: Reads a running counter through its mmap'd page (seqlock protocol of perf_event_mmap_page)
+ *
+ * Parameter:
+ *              - unsigned counter: Counter to read (0 = leader)
+ *              - unsigned long long* value: Where the counter value is written
+ *
+ * Returns:     0 on success, -1 if the counter is not currently on the hardware or the User mode reads are not implemented
+ *
+ * */
+static int read_self_monitoring(unsigned counter, unsigned long long* value){
+#if !defined(__x86_64__) && !defined(__i386__)
+    (void)counter;
+    (void)value;
+    return -1;
+#else
+    volatile struct perf_event_mmap_page* pc = page[counter];
+    unsigned seq, index;
+    unsigned long long count, pmc;
+    unsigned width;
+
+    do{
+        seq = pc->lock;
+        __sync_synchronize();
+
+        index = pc->index;
+        count = pc->offset;
+        if(!pc->cap_user_rdpmc || index == 0)
+            return -1;
+
+        width = pc->pmc_width;
+        pmc = read_pmc(index - 1);
+        pmc <<= 64 - width;
+        count += (long long)pmc >> (64 - width);
+
+        __sync_synchronize();
+    } while(pc->lock != seq);
+
+    *value = count;
+    return 0;
+#endif
+}
+
+
+/* read_group
+ *
+ * Description: Reads the whole group with a single system call
+ *
+ * Parameter:
+ *              - unsigned long long* value: Where the counters values are written (PERF_NB_COUNTERS elements)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static void read_group(unsigned long long* value){
+    // Group read layout: nr, then one value per counter in opening order
+    unsigned long long buffer[1 + PERF_NB_COUNTERS];
+    unsigned i;
+
+    memset(buffer, 0, sizeof(buffer));
+    if(read(fd[0], buffer, sizeof(buffer)) < 0)
+        perror("perf_event read");
+
+    for(i = 0; i < PERF_NB_COUNTERS; i++)
+        value[i] = pos[i] ? buffer[pos[i]] : 0;
+}
+
+
+/* open_counter
+ *
+ * Description: Opens one counter of the group
+ *
+ * Parameter:
+ *              - unsigned counter: Counter to open (0 = leader)
+ *              - struct perf_event_attr* attr: Counter type and config, the rest is filled here
+ *
+ * Returns:     0 on success, -1 otherwise
+ *
+ * */
+static int open_counter(unsigned counter, struct perf_event_attr* attr){
+    attr->size = sizeof(*attr);
+    attr->disabled = (counter == 0);
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_GROUP;
+
+    fd[counter] = perf_event_open(attr, 0, -1, (counter == 0) ? -1 : fd[0], 0);
+    if(fd[counter] < 0)
+        return -1;
+
+    pos[counter] = ++group_size;
+    return 0;
+}
+
+
+/* close_counters
+ *
+ * Description: Releases every counter and self-monitoring page
+ *
+ * */
+static void close_counters(void){
+    unsigned i;
+
+    for(i = 0; i < PERF_NB_COUNTERS; i++){
+        if(page[i] != NULL)
+            munmap(page[i], sysconf(_SC_PAGESIZE));
+        if(fd[i] >= 0)
+            close(fd[i]);
+
+        page[i] = NULL;
+        fd[i] = -1;
+        pos[i] = 0;
+    }
+
+    group_size = 0;
+    mode = PERF_MODE_NONE;
+}
+
+
+/* try_self_monitoring
+ *
+ * Description: Maps the page of every counter and checks that all of them can be read with rdpmc.
+ *              The group is then left enabled.
+ *
+ * Returns:     0 if the rdpmc mode can be used, -1 otherwise
+ *
+ * */
+static int try_self_monitoring(void){
+    unsigned long long value;
+    unsigned i;
+
+#if !defined(__x86_64__) && !defined(__i386__)
+    // No User mode read implemented for this architecture: group read
+    return -1;
+#endif
+
+    for(i = 0; i < PERF_NB_COUNTERS; i++){
+        if(fd[i] < 0)
+            continue;
+
+        page[i] = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd[i], 0);
+        if(page[i] == MAP_FAILED){
+            page[i] = NULL;
+            return -1;
+        }
+    }
+
+    ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    for(i = 0; i < PERF_NB_COUNTERS; i++)
+        if(fd[i] >= 0 && read_self_monitoring(i, &value) < 0){
+            ioctl(fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            return -1;
+        }
+
+    return 0;
+}
+
+
+static int perf_event_source_init(const unsigned* event_ids, unsigned nb_events){
+    static int software_reported = 0;
+    struct perf_event_attr attr;
+    unsigned i;
+
+    if(nb_events > PMU_NB_EVT_COUNTERS)
+        return -1;
+
+    close_counters();
+
+    owner = (pid_t)syscall(SYS_gettid);
+    owner_nb_events = nb_events;
+    for(i = 0; i < nb_events; i++)
+        owner_events[i] = event_ids[i];
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+
+    if(open_counter(0, &attr) < 0){
+        // No hardware counters: fall back to the task clock
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_TASK_CLOCK;
+
+        if(open_counter(0, &attr) < 0){
+            perror("perf_event_open");
+            return -1;
+        }
+
+        if(!software_reported)
+            printf("perf_event: no hardware counters, task clock (ns) is used instead of cycles and events read 0 \n");
+        software_reported = 1;
+
+        mode = PERF_MODE_SOFTWARE;
+        return 0;
+    }
+
+    for(i = 0; i < nb_events; i++){
+        memset(&attr, 0, sizeof(attr));
+
+        if(a15_event_to_perf(event_ids[i], &attr) < 0){
+            printf("perf_event: event 0x%X not available, counter %u reads 0 \n", event_ids[i], i);
+            continue;
+        }
+
+        if(open_counter(1 + i, &attr) < 0)
+            printf("perf_event: event 0x%X could not be opened, counter %u reads 0 \n", event_ids[i], i);
+    }
+
+    mode = (try_self_monitoring() == 0) ? PERF_MODE_RDPMC : PERF_MODE_GROUP;
+
+    return 0;
+}
+
+
+static void perf_event_source_start(void){
+    unsigned i;
+
+    // Measurement done by another thread than the one which opened the counters
+    if(mode != PERF_MODE_NONE && (pid_t)syscall(SYS_gettid) != owner)
+        perf_event_source_init(owner_events, owner_nb_events);
+
+    if(mode == PERF_MODE_RDPMC){
+        // The counters keep running, only their current value is taken
+        for(i = 0; i < PERF_NB_COUNTERS; i++)
+            if(fd[i] >= 0)
+                read_self_monitoring(i, &start_value[i]);
+        return;
+    }
+
+    ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+
+static void perf_event_source_read(struct pmu_snapshot* snapshot){
+    unsigned long long value[PERF_NB_COUNTERS];
+    unsigned i;
+
+    if(mode == PERF_MODE_RDPMC){
+        memset(value, 0, sizeof(value));
+
+        // Leader last, as in the ARMv7 snapshot
+        for(i = PERF_NB_COUNTERS; i-- > 0;)
+            if(fd[i] >= 0 && read_self_monitoring(i, &value[i]) == 0)
+                value[i] -= start_value[i];
+    }
+    else
+        read_group(value);
+
+    for(i = 0; i < PERF_NB_COUNTERS; i++)
+        last_value[i] = value[i];
+
+    snapshot->cycles = (unsigned)value[0];
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        snapshot->evt[i] = (unsigned)value[1 + i];
+}
+
+
+static void perf_event_source_stop(struct pmu_snapshot* snapshot){
+
+    // In rdpmc mode the counters keep running, the values are taken relative to the start probe
+    if(mode != PERF_MODE_RDPMC)
+        ioctl(fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    perf_event_source_read(snapshot);
+}
+
+
+void pmu_perf_event_wraps(struct pmu_wrap_tracker* tracker){
+    unsigned i;
+
+    tracker->cycles_high = last_value[0] & ~0xFFFFFFFFULL;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        tracker->evt_high[i] = last_value[1 + i] & ~0xFFFFFFFFULL;
+}
+
+
+const char* pmu_perf_event_mode(void){
+    switch(mode){
+        case PERF_MODE_RDPMC:    return "rdpmc";
+        case PERF_MODE_GROUP:    return "group read";
+        case PERF_MODE_SOFTWARE: return "software";
+    }
+
+    return "not initialized";
+}
+
+
+const struct pmu_counter_source pmu_perf_event_source = {"perf_event", perf_event_source_init, perf_event_source_start, perf_event_source_stop, perf_event_source_read};
@@ -0,0 +1,66 @@
+/*--------------------------- pmu_perf_event.h ---------------------------
+ |  File pmu_perf_event.h
+ |
+ |  Description: Linux perf_event implementation of the counter source.
+ |               It does not require the user_enable_pmu module and runs
+ |               on any Linux machine, so that the probe calibration can
+ |               be exercised on a host.
+ |
+ |  Version: 1.4
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_PERF_EVENT_H_
+#define PMU_PERF_EVENT_H_
+
+#include <linux/perf_event.h>
+#include "pmu_counter_source.h"
+#include "pmu_counter64.h"
+
+// perf_event implementation of the counter source
+extern const struct pmu_counter_source pmu_perf_event_source;
+
+
+/* a15_event_to_perf
+ *
+ * Description: Translates an ARM Cortex A15 event number into a perf_event configuration.
+ *              On ARM, every event is passed raw, so that the counts match the ARMv7 source for the same
+ *              event numbers. On other hosts, the nearest generic perf event is used when one exists
+ *              (read-only cache events, bus cycles for bus accesses): the counts are then only indicative.
+ *
+ * Parameter:
+ *              - unsigned event_id: ARM Cortex A15 event number
+ *              - struct perf_event_attr* attr: Attribute whose type and config are set
+ *
+ * Returns:     0 if the event can be counted, -1 otherwise
+ *
+ * */
+int a15_event_to_perf(unsigned event_id, struct perf_event_attr* attr);
+
+
+/* pmu_perf_event_wraps
+ *
+ * Description: perf_event counts are 64-bit while the snapshots hold 32 bits: gives the upper parts of the
+ *              counts of the last read or stop, so that pmu_wrap_extend rebuilds the complete values
+ *
+ * Parameter:
+ *              - struct pmu_wrap_tracker* tracker: Where the upper parts are written
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_perf_event_wraps(struct pmu_wrap_tracker* tracker);
+
+
+/* pmu_perf_event_mode
+ *
+ * Description: Tells how the counters are read since the last init of pmu_perf_event_source
+ *
+ * Parameter:   None
+ *
+ * Returns:     "rdpmc" (User mode reads, no system call), "group read" (one read() per probe),
+ *              "software" (task clock instead of cycles, events read 0) or "not initialized"
+ *
+ * */
+const char* pmu_perf_event_mode(void);
+
+#endif /* PMU_PERF_EVENT_H_ */
@@ -0,0 +1,215 @@
+/*--------------------------- pmu_perf_sampling.c ------------------------
+ |  File pmu_perf_sampling.c
+ |
+ |  Description: The functions definition for the perf_event statistical
+ |               sampling are done here
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "pmu_perf_event.h"
+#include "pmu_perf_sampling.h"
+
+
+// Data pages of the ring buffer (power of two)
+#define SAMPLING_RING_PAGES 64
+
+// Counters of the group: sampled event (leader), cycles and the other event counters
+#define SAMPLING_NB_COUNTERS (1 + PMU_NB_EVT_COUNTERS)
+
+static struct pmu_sample_buffer* buffer = NULL;
+
+// Group file descriptors in opening order (-1 if not available)
+static int fd[SAMPLING_NB_COUNTERS] = {-1, -1, -1, -1, -1, -1, -1};
+static unsigned group_size = 0;
+
+// Position in the group of the cycles and of each event counter (-1 if not counted)
+static int cycles_pos;
+static int evt_pos[PMU_NB_EVT_COUNTERS];
+
+// Ring buffer: control page followed by the data pages
+static struct perf_event_mmap_page* ring = NULL;
+static size_t ring_size = 0;
+
+
+static int perf_event_open(struct perf_event_attr* attr, pid_t pid, int cpu, int group_fd, unsigned long flags){
+    return (int)syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+
+// Opens a member of the group and returns its position, -1 on failure
+static int open_member(struct perf_event_attr* attr){
+    attr->size = sizeof(*attr);
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+
+    fd[group_size] = perf_event_open(attr, 0, -1, fd[0], 0);
+    if(fd[group_size] < 0)
+        return -1;
+
+    return (int)group_size++;
+}
+
+
+// Copies "length" bytes from the ring data at "offset", handling the wrap at the end of the ring
+static void ring_copy(unsigned long long offset, void* destination, size_t length){
+    const unsigned char* data = (const unsigned char*)ring + sysconf(_SC_PAGESIZE);
+    size_t data_size = ring_size - sysconf(_SC_PAGESIZE);
+    unsigned char* d = destination;
+    size_t i;
+
+    for(i = 0; i < length; i++)
+        d[i] = data[(offset + i) & (data_size - 1)];
+}
+
+
+int pmu_perf_sampling_start(struct pmu_sample_buffer* sample_buffer, const unsigned* event_ids){
+    struct perf_event_attr attr;
+    struct pmu_snapshot origin;
+    unsigned i;
+
+    if(sample_buffer->sampled_counter >= PMU_NB_EVT_COUNTERS)
+        return -1;
+
+    pmu_perf_sampling_stop();
+
+    buffer = sample_buffer;
+    cycles_pos = -1;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        evt_pos[i] = -1;
+
+    // Leader: sampled event, one sample every "period" events
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sample_period = buffer->period;
+    attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_READ;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    if(a15_event_to_perf(event_ids[buffer->sampled_counter], &attr) == 0)
+        fd[0] = perf_event_open(&attr, 0, -1, -1, 0);
+
+    if(fd[0] < 0){
+        // No hardware counters: sample the task clock ("period" ns), the events read 0
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_TASK_CLOCK;
+
+        fd[0] = perf_event_open(&attr, 0, -1, -1, 0);
+        if(fd[0] < 0){
+            perror("perf_event_open");
+            return -1;
+        }
+
+        printf("perf_event sampling: no hardware counters, the task clock is sampled every %u ns \n", buffer->period);
+        group_size = 1;
+        cycles_pos = 0;
+    }
+    else{
+        group_size = 1;
+        evt_pos[buffer->sampled_counter] = 0;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        cycles_pos = open_member(&attr);
+
+        for(i = 0; i < PMU_NB_EVT_COUNTERS; i++){
+            if(i == buffer->sampled_counter)
+                continue;
+
+            memset(&attr, 0, sizeof(attr));
+            if(a15_event_to_perf(event_ids[i], &attr) == 0)
+                evt_pos[i] = open_member(&attr);
+        }
+    }
+
+    ring_size = (1 + SAMPLING_RING_PAGES) * sysconf(_SC_PAGESIZE);
+    ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd[0], 0);
+    if(ring == MAP_FAILED){
+        perror("perf_event mmap");
+        ring = NULL;
+        pmu_perf_sampling_stop();
+        return -1;
+    }
+
+    // The counters start from 0
+    memset(&origin, 0, sizeof(origin));
+    pmu_sample_set_origin(buffer, &origin);
+
+    ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    return 0;
+}
+
+
+void pmu_perf_sampling_drain(void){
+    struct perf_event_header header;
+    unsigned long long record[2 + SAMPLING_NB_COUNTERS];
+    unsigned long long head, tail;
+    struct pmu_snapshot raw;
+    unsigned i;
+
+    if(ring == NULL)
+        return;
+
+    head = ring->data_head;
+    __sync_synchronize();
+    tail = ring->data_tail;
+
+    while(tail < head){
+        ring_copy(tail, &header, sizeof(header));
+
+        if(header.type == PERF_RECORD_SAMPLE && header.size - sizeof(header) <= sizeof(record)){
+            // ip, nr, values[nr]
+            ring_copy(tail + sizeof(header), record, header.size - sizeof(header));
+
+            raw.cycles = (cycles_pos >= 0 && (unsigned)cycles_pos < record[1]) ? (unsigned)record[2 + cycles_pos] : 0;
+            for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+                raw.evt[i] = (evt_pos[i] >= 0 && (unsigned)evt_pos[i] < record[1]) ? (unsigned)record[2 + evt_pos[i]] : 0;
+
+            pmu_sample_record(buffer, (unsigned long)record[0], &raw);
+        }
+        else if(header.type == PERF_RECORD_LOST){
+            // id, lost
+            ring_copy(tail + sizeof(header), record, 2 * sizeof(record[0]));
+            pmu_sample_lost(buffer, (unsigned)record[1]);
+        }
+
+        tail += header.size;
+    }
+
+    // The records are consumed before the space is given back to the kernel
+    __sync_synchronize();
+    ring->data_tail = tail;
+}
+
+
+void pmu_perf_sampling_stop(void){
+    unsigned i;
+
+    if(fd[0] >= 0)
+        ioctl(fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    pmu_perf_sampling_drain();
+
+    if(ring != NULL)
+        munmap(ring, ring_size);
+    ring = NULL;
+
+    for(i = 0; i < SAMPLING_NB_COUNTERS; i++){
+        if(fd[i] >= 0)
+            close(fd[i]);
+        fd[i] = -1;
+    }
+
+    group_size = 0;
+}
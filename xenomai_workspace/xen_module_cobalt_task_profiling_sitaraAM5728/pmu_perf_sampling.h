@@ -0,0 +1,59 @@
+/*--------------------------- pmu_perf_sampling.h ------------------------
+ |  File pmu_perf_sampling.h
+ |
+ |  Description: Statistical sampling through Linux perf_event. The
+ |               sampled event leads a group with the cycles and the other
+ |               events; the kernel handles the overflow interrupt and
+ |               writes the interrupted PC and the group values into a
+ |               ring buffer, which is drained into a pmu_sample_buffer.
+ |               The counters follow the calling thread.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_PERF_SAMPLING_H_
+#define PMU_PERF_SAMPLING_H_
+
+#include "pmu_sampling.h"
+
+
+/* pmu_perf_sampling_start
+ *
+ * Description: Opens the sampling group for the calling thread and starts it.
+ *              Without hardware counters, the task clock (ns) is sampled instead and the events read 0.
+ *
+ * Parameter:
+ *              - struct pmu_sample_buffer* buffer: Buffer receiving the samples (its sampled counter and period are used)
+ *              - const unsigned* event_ids: ARM Cortex A15 events of counters 0 to 5
+ *
+ * Returns:     0 on success, -1 otherwise
+ *
+ * */
+int pmu_perf_sampling_start(struct pmu_sample_buffer* buffer, const unsigned* event_ids);
+
+
+/* pmu_perf_sampling_drain
+ *
+ * Description: Moves the samples written by the kernel since the last call into the buffer.
+ *              Must be called often enough for the ring buffer not to fill up (lost samples are accounted).
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_perf_sampling_drain(void);
+
+
+/* pmu_perf_sampling_stop
+ *
+ * Description: Drains the last samples and closes the sampling group
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void pmu_perf_sampling_stop(void);
+
+#endif /* PMU_PERF_SAMPLING_H_ */
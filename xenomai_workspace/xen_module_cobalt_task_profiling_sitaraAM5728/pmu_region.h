@@ -0,0 +1,130 @@
+/*--------------------------- pmu_region.h -------------------------------
+ |  File pmu_region.h
+ |
+ |  Description: Nested region markers for intra-task attribution.
+ |               region_begin/region_end read the free-running PMU and
+ |               EMIF counters; every closed region appends one compact
+ |               record (begin timestamp, nesting depth, counters deltas)
+ |               to a fixed-size ring buffer, which can be placed in any
+ |               memory (DDR, MSMC SRAM...) and is dumped after the run.
+ |               When the ring is full, the oldest records are overwritten.
+ |               Regions are recorded when they end, so an inner region
+ |               appears before the region containing it.
+ |               The records of a region can also be folded into derived
+ |               metrics statistics (e.g., per-phase ACOR) before the dump.
+ |
+ |  Version: 1.2
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_REGION_H_
+#define PMU_REGION_H_
+
+#include "pmu_counter_source.h"
+#include "pmu_metrics.h"
+
+// Maximum nesting depth of the regions
+#define PMU_REGION_MAX_DEPTH 8
+
+// EMIF counters per record: counter 1, counter 2 and timer of up to two EMIFs
+#define PMU_REGION_NB_EMIF_COUNTERS 6
+
+// Counters read at a region boundary
+struct pmu_region_counters{
+    struct pmu_snapshot pmu;
+    unsigned emif[PMU_REGION_NB_EMIF_COUNTERS];
+};
+
+// A closed region
+struct pmu_region_record{
+    unsigned short id;
+    unsigned short depth;
+
+    // Cycles between the beginning of the outermost region containing it and its beginning (0 for an outermost region).
+    // Robust to counter resets between two outermost regions (e.g., one per task period)
+    unsigned timestamp;
+
+    // Counters increments between region_begin and region_end
+    struct pmu_region_counters delta;
+};
+
+// Reads the free-running counters (the EMIF counters not available are set to 0)
+typedef void (*pmu_region_reader)(struct pmu_region_counters* counters);
+
+
+/* region_init
+ *
+ * Description: Sets the ring buffer and the counters reader, and empties the ring.
+ *              The PMU and EMIF counters must be running while regions are measured.
+ *              Markers do nothing before region_init and after a region_init with a NULL reader,
+ *              so they can be left in code that is not always profiled.
+ *
+ * Parameter:
+ *              - struct pmu_region_record* storage: Preallocated ring buffer
+ *              - unsigned capacity: Number of records of the ring buffer
+ *              - pmu_region_reader read: Counters reader (NULL disables the markers)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void region_init(struct pmu_region_record* storage, unsigned capacity, pmu_region_reader read);
+
+
+/* region_begin
+ *
+ * Description: Opens a region inside the current one. Regions deeper than PMU_REGION_MAX_DEPTH are not recorded.
+ *
+ * Parameter:
+ *              - unsigned id: Region identifier (e.g., the phase number)
+ *
+ * Returns:     Nothing
+ *
+ * */
+void region_begin(unsigned id);
+
+
+/* region_end
+ *
+ * Description: Closes the current region and appends its record to the ring.
+ *              An id not matching the current region closes the innermost open region with this id, the regions left open
+ *              inside it being dropped and counted as unbalanced. An id that is not open is counted as unbalanced and ignored.
+ *
+ * Parameter:
+ *              - unsigned id: Region identifier given to region_begin
+ *
+ * Returns:     Nothing
+ *
+ * */
+void region_end(unsigned id);
+
+
+/* region_dump
+ *
+ * Description: Prints the records, oldest first, as
+ *              "R <id> <depth> <timestamp> <cycles> <evt0> ... <evt5> <emif0> ... <emif5>",
+ *              followed by "O <records overwritten> <unbalanced markers>", then empties the ring
+ *
+ * Parameter:   None
+ *
+ * Returns:     Nothing
+ *
+ * */
+void region_dump(void);
+
+
+/* region_stats_add
+ *
+ * Description: Adds the derived metrics of every record of a region still in the ring to the statistics,
+ *              one run per record (to be called before region_dump, which empties the ring).
+ *              EMIF counters 1 and 2 are taken as the accesses and activates, summed over both EMIFs.
+ *
+ * Parameter:
+ *              - unsigned id: Region identifier
+ *              - const unsigned* event_ids: Events of the ARM counters 0 to 5 (NULL: EMIF metrics only)
+ *              - struct pmu_metrics_stats* stats: Statistics to update
+ *
+ * Returns:     The number of records added
+ *
+ * */
+unsigned region_stats_add(unsigned id, const unsigned* event_ids, struct pmu_metrics_stats* stats);
+
+#endif /* PMU_REGION_H_ */
@@ -0,0 +1,224 @@
+/*--------------------------- pmu_xcore.h --------------------------------
+ |  File pmu_xcore.h
+ |
+ |  Description: Cross-core PMU harvesting. Every participating core
+ |               publishes its free-running counters into its own
+ |               cache-line-aligned slot of a shared exchange area when
+ |               the collector (arm0, the victim) requests a new epoch.
+ |               The collector requests an epoch before and after each
+ |               measured run and reads every slot, so that the counters
+ |               increments of the aggressors during the run are known.
+ |
+ |               Aggressors publish at their poll points only (e.g., the
+ |               phase boundaries of their task), so an epoch is answered
+ |               with a delay up to one poll interval: the aggressor cycles
+ |               are published with the events, from which the rates are
+ |               derived. An aggressor about to sleep publishes itself as
+ |               idle, its counters are then taken as they are; its first
+ |               poll after waking up publishes it again as running, so
+ |               that the collector waits for its next answer.
+ |
+ |               Slots are written with a sequence number (odd while being
+ |               written), so a reader never sees a half-written snapshot.
+ |               The functions are inline since the header is shared by
+ |               the arm0 and arm1 images and by the Linux harness.
+ |
+ |  Version: 1.1
+ *-----------------------------------------------------------------------*/
+
+#ifndef PMU_XCORE_H_
+#define PMU_XCORE_H_
+
+#include "pmu_counter_source.h"
+
+// Number of slots (one per core)
+#define PMU_XCORE_MAX_CORES 4
+
+// Cache line size of the ARM Cortex A15
+#define PMU_XCORE_LINE_SIZE 64
+
+// Keystone II exchange area: last 64 KB of the MSMC SRAM, left out of the MSMC_SRAM region of the arm0 and arm1 linker scripts
+#define PMU_XCORE_AREA_ADDRESS 0x0C5F0000
+
+// Slot of a core, alone in its cache line
+struct pmu_xcore_slot{
+    volatile unsigned sequence;
+    volatile unsigned epoch;
+    volatile unsigned active;
+    volatile unsigned idle;
+    volatile unsigned cycles;
+    volatile unsigned evt[PMU_NB_EVT_COUNTERS];
+} __attribute__((aligned(PMU_XCORE_LINE_SIZE)));
+
+// Exchange area: epoch requested by the collector, in its own cache line, and the slots
+struct pmu_xcore_area{
+    volatile unsigned epoch __attribute__((aligned(PMU_XCORE_LINE_SIZE)));
+    struct pmu_xcore_slot slot[PMU_XCORE_MAX_CORES];
+};
+
+
+/* pmu_xcore_init
+ *
+ * Description: Clears the exchange area. Done once by the collector before the first request.
+ *              A core that already published becomes active again at its next poll.
+ *
+ * Parameter:
+ *              - struct pmu_xcore_area* area: Exchange area
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void pmu_xcore_init(struct pmu_xcore_area* area){
+    unsigned i;
+
+    area->epoch = 0;
+    for(i = 0; i < PMU_XCORE_MAX_CORES; i++){
+        area->slot[i].sequence = 0;
+        area->slot[i].epoch = 0;
+        area->slot[i].active = 0;
+        area->slot[i].idle = 0;
+    }
+    __sync_synchronize();
+}
+
+
+/* pmu_xcore_publish
+ *
+ * Description: Writes the current counters of the calling core into its slot
+ *
+ * Parameter:
+ *              - struct pmu_xcore_area* area: Exchange area
+ *              - unsigned core: Slot of the calling core
+ *              - unsigned epoch: Epoch answered
+ *              - unsigned idle: 1 if the core stops running its task until its next poll, 0 otherwise
+ *              - void (*read)(struct pmu_snapshot*): Reads the free-running counters of the calling core
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void pmu_xcore_publish(struct pmu_xcore_area* area, unsigned core, unsigned epoch, unsigned idle, void (*read)(struct pmu_snapshot*)){
+    struct pmu_xcore_slot* slot = &area->slot[core];
+    struct pmu_snapshot snapshot;
+    unsigned i;
+
+    read(&snapshot);
+
+    slot->sequence++;
+    __sync_synchronize();
+
+    slot->epoch = epoch;
+    slot->idle = idle;
+    slot->cycles = snapshot.cycles;
+    for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+        slot->evt[i] = snapshot.evt[i];
+    slot->active = 1;
+
+    __sync_synchronize();
+    slot->sequence++;
+}
+
+
+/* pmu_xcore_poll
+ *
+ * Description: Poll point of an aggressor: publishes its counters if a new epoch was requested, or if the core published itself
+ *              as idle (first poll after waking up: the idle snapshot must no longer answer the requests). Two shared reads otherwise.
+ *
+ * Parameter:
+ *              - struct pmu_xcore_area* area: Exchange area
+ *              - unsigned core: Slot of the calling core
+ *              - unsigned* last_epoch: Last epoch answered by the calling core
+ *              - void (*read)(struct pmu_snapshot*): Reads the free-running counters of the calling core
+ *
+ * Returns:     1 if the counters were published, 0 otherwise
+ *
+ * */
+static inline int pmu_xcore_poll(struct pmu_xcore_area* area, unsigned core, unsigned* last_epoch, void (*read)(struct pmu_snapshot*)){
+    unsigned epoch = area->epoch;
+
+    if(epoch == *last_epoch && !area->slot[core].idle)
+        return 0;
+
+    pmu_xcore_publish(area, core, epoch, 0, read);
+    *last_epoch = epoch;
+
+    return 1;
+}
+
+
+/* pmu_xcore_idle
+ *
+ * Description: Aggressor side, before sleeping: publishes its counters as idle, so that the collector does not wait for it
+ *
+ * Parameter:
+ *              - struct pmu_xcore_area* area: Exchange area
+ *              - unsigned core: Slot of the calling core
+ *              - unsigned* last_epoch: Last epoch answered by the calling core
+ *              - void (*read)(struct pmu_snapshot*): Reads the free-running counters of the calling core
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void pmu_xcore_idle(struct pmu_xcore_area* area, unsigned core, unsigned* last_epoch, void (*read)(struct pmu_snapshot*)){
+    unsigned epoch = area->epoch;
+
+    pmu_xcore_publish(area, core, epoch, 1, read);
+    *last_epoch = epoch;
+}
+
+
+/* pmu_xcore_request
+ *
+ * Description: Collector side: asks every core to publish its counters for a new epoch
+ *
+ * Parameter:
+ *              - struct pmu_xcore_area* area: Exchange area
+ *              - unsigned epoch: New epoch (different from the previous one)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void pmu_xcore_request(struct pmu_xcore_area* area, unsigned epoch){
+    __sync_synchronize();
+    area->epoch = epoch;
+    __sync_synchronize();
+}
+
+
+/* pmu_xcore_collect
+ *
+ * Description: Collector side: waits until a core answered an epoch (or published itself as idle) and copies its counters
+ *
+ * Parameter:
+ *              - struct pmu_xcore_area* area: Exchange area
+ *              - unsigned core: Slot to read
+ *              - unsigned epoch: Epoch requested
+ *              - unsigned timeout: Maximum number of polls of the slot
+ *              - struct pmu_snapshot* snapshot: Where the counters of the core are written
+ *
+ * Returns:     0 on success, -1 if the core is not active or did not answer in time
+ *
+ * */
+static inline int pmu_xcore_collect(struct pmu_xcore_area* area, unsigned core, unsigned epoch, unsigned timeout, struct pmu_snapshot* snapshot){
+    struct pmu_xcore_slot* slot = &area->slot[core];
+    unsigned sequence, answered, i;
+
+    for(; timeout > 0; timeout--){
+        sequence = slot->sequence;
+        if(sequence & 1)
+            continue;
+        __sync_synchronize();
+
+        answered = slot->active && (slot->epoch == epoch || slot->idle);
+        snapshot->cycles = slot->cycles;
+        for(i = 0; i < PMU_NB_EVT_COUNTERS; i++)
+            snapshot->evt[i] = slot->evt[i];
+
+        __sync_synchronize();
+        if(slot->sequence == sequence && answered)
+            return 0;
+    }
+
+    return -1;
+}
+
+#endif /* PMU_XCORE_H_ */
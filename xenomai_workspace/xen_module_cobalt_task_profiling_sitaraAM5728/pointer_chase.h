@@ -0,0 +1,333 @@
+/*--------------------------- pointer_chase.h ----------------------------
+ |  File pointer_chase.h
+ |
+ |  Description: Prefetcher-proof pointer chasing. The nodes of a buffer
+ |               (one every cache line or every page) are linked into a
+ |               single random cycle by a Sattolo permutation, so that
+ |               neither the L1 nor the L2 data prefetcher can guess the
+ |               next address and each hop costs one full load latency.
+ |
+ |               Nodes may be grouped in windows (e.g., one SDRAM row): the
+ |               chain visits every node of a window in a random order
+ |               before it jumps to a random window, so that the hops out of
+ |               the caches hit the open row. Without windows, successive
+ |               hops fall in random rows (row misses).
+ |
+ |               A sweep doubles the working set from
+ |               POINTER_CHASE_MIN_SIZE up to the buffer size and reports
+ |               the time per hop of each size; the latency plateaus of the
+ |               memory levels (L1, L2, DDR, ...) are the medians of the
+ |               sizes that fit well inside a level and well outside the
+ |               level below.
+ |
+ |               The functions are inline since the header is shared by the
+ |               bare-metal and the Linux profilers. Times are in the unit
+ |               of the measure function (cycles or nanoseconds).
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef POINTER_CHASE_H_
+#define POINTER_CHASE_H_
+
+#include <stdio.h>
+
+// Node granularities (bytes): cache line of the A15 and of the C66x L1D, small page
+#define POINTER_CHASE_LINE_SIZE 64
+#define POINTER_CHASE_PAGE_SIZE 4096
+
+// Smallest working set of a sweep (bytes)
+#define POINTER_CHASE_MIN_SIZE (4*1024)
+
+// Hops of the unrolled loop, and fewest hops timed for a working set (small sets are walked several times)
+#define POINTER_CHASE_UNROLL 16
+#define POINTER_CHASE_MIN_HOPS (64*1024)
+
+// Seed of the permutations (the same chains on every run)
+#define POINTER_CHASE_SEED 0x2545F491
+
+// Working set of a sweep and its measurement
+struct pointer_chase_point{
+    unsigned size;
+    unsigned nb_hops;
+    unsigned long long time;
+};
+
+// A memory level: name and capacity (bytes, 0 for the memory behind every cache)
+struct pointer_chase_level{
+    const char* name;
+    unsigned size;
+};
+
+// Time of nb_hops hops from head, e.g., pointer_chase_run between the probes of the platform
+typedef unsigned long long (*pointer_chase_measure)(void* head, unsigned nb_hops);
+
+// Last node reached by a run, so that the loads of the chain are not optimized out
+static void* volatile pointer_chase_sink;
+
+
+/* pointer_chase_random
+ *
+ * Description: xorshift32 pseudo-random generator (no libc rand on the bare-metal targets)
+ *
+ * Parameter:
+ *              - unsigned* state: Generator state, not 0
+ *
+ * Returns:     The next value
+ *
+ * */
+static inline unsigned pointer_chase_random(unsigned* state){
+    unsigned x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+
+/* pointer_chase_node
+ *
+ * Description: Address of a node. Nodes coarser than a cache line move one line further in their block each time, so that
+ *              they do not all fall in the same cache set
+ *
+ * Parameter:
+ *              - unsigned char* buffer: Buffer of the chain
+ *              - unsigned index: Node index
+ *              - unsigned granularity: Bytes between two nodes
+ *
+ * Returns:     The node (two pointers: next node, and a scratch word used while building)
+ *
+ * */
+static inline void** pointer_chase_node(unsigned char* buffer, unsigned index, unsigned granularity){
+    unsigned offset = (granularity > POINTER_CHASE_LINE_SIZE) ? (index * POINTER_CHASE_LINE_SIZE) % granularity : 0;
+
+    return (void**)(buffer + (unsigned long)index * granularity + offset);
+}
+
+
+/* pointer_chase_build
+ *
+ * Description: Links the nodes of the first size bytes of a buffer into a single random cycle. A Sattolo shuffle of each
+ *              window gives a random cycle over its nodes, a Sattolo shuffle of the windows gives the order of the windows,
+ *              then the last node of each window cycle is redirected to the first node of the next window. Node indexes are
+ *              kept in the nodes while building, so no memory besides the buffer is needed
+ *
+ * Parameter:
+ *              - unsigned char* buffer: Buffer of the chain (aligned on window)
+ *              - unsigned size: Bytes of the chain, multiple of window
+ *              - unsigned granularity: Bytes between two nodes (POINTER_CHASE_LINE_SIZE or _PAGE_SIZE)
+ *              - unsigned window: Bytes visited before moving to another window, multiple of granularity (0: granularity,
+ *                                 i.e., every hop goes anywhere in the chain)
+ *              - unsigned seed: Seed of the permutations, not 0
+ *
+ * Returns:     The first node, NULL if the sizes do not fit
+ *
+ * */
+static inline void* pointer_chase_build(unsigned char* buffer, unsigned size, unsigned granularity, unsigned window, unsigned seed){
+    unsigned nb_nodes, per_window, nb_windows, first, last, w, k, j;
+    void* swap;
+    void** node;
+
+    if(window == 0)
+        window = granularity;
+    if(granularity < 2 * sizeof(void*) || window % granularity != 0 || size < window || size % window != 0)
+        return NULL;
+
+    nb_nodes = size / granularity;
+    per_window = window / granularity;
+    nb_windows = nb_nodes / per_window;
+
+    // Identity: every node is its own successor, every window its own next window
+    for(k = 0; k < nb_nodes; k++){
+        node = pointer_chase_node(buffer, k, granularity);
+        node[0] = (void*)(unsigned long)k;
+        node[1] = (void*)(unsigned long)(k / per_window);
+    }
+
+    // Sattolo: a swap with a strictly lower position only leaves single-cycle permutations
+    for(w = 0; w < nb_windows; w++){
+        first = w * per_window;
+        for(k = per_window - 1; k > 0; k--){
+            j = pointer_chase_random(&seed) % k;
+            swap = pointer_chase_node(buffer, first + k, granularity)[0];
+            pointer_chase_node(buffer, first + k, granularity)[0] = pointer_chase_node(buffer, first + j, granularity)[0];
+            pointer_chase_node(buffer, first + j, granularity)[0] = swap;
+        }
+    }
+
+    for(k = nb_windows - 1; k > 0; k--){
+        j = pointer_chase_random(&seed) % k;
+        swap = pointer_chase_node(buffer, k * per_window, granularity)[1];
+        pointer_chase_node(buffer, k * per_window, granularity)[1] = pointer_chase_node(buffer, j * per_window, granularity)[1];
+        pointer_chase_node(buffer, j * per_window, granularity)[1] = swap;
+    }
+
+    // The node closing the cycle of a window goes to the first node of the next window
+    for(w = 0; w < nb_windows; w++){
+        first = w * per_window;
+        last = first;
+        while((unsigned long)pointer_chase_node(buffer, last, granularity)[0] != first)
+            last = (unsigned)(unsigned long)pointer_chase_node(buffer, last, granularity)[0];
+
+        pointer_chase_node(buffer, last, granularity)[0] = (void*)((unsigned long)pointer_chase_node(buffer, first, granularity)[1] * per_window);
+    }
+
+    // Indexes to addresses
+    for(k = 0; k < nb_nodes; k++){
+        node = pointer_chase_node(buffer, k, granularity);
+        node[0] = pointer_chase_node(buffer, (unsigned)(unsigned long)node[0], granularity);
+    }
+
+    return pointer_chase_node(buffer, 0, granularity);
+}
+
+
+/* pointer_chase_run
+ *
+ * Description: Follows the chain, POINTER_CHASE_UNROLL dependent loads per iteration
+ *
+ * Parameter:
+ *              - void* head: Node to start from
+ *              - unsigned nb_hops: Hops (rounded up to a multiple of POINTER_CHASE_UNROLL)
+ *
+ * Returns:     The last node reached
+ *
+ * */
+#define POINTER_CHASE_HOP(p) p = *(void* volatile*)p;
+#define POINTER_CHASE_HOPS(p) POINTER_CHASE_HOP(p) POINTER_CHASE_HOP(p) POINTER_CHASE_HOP(p) POINTER_CHASE_HOP(p)
+
+static inline void* pointer_chase_run(void* head, unsigned nb_hops){
+    void* p = head;
+    unsigned i;
+
+    for(i = 0; i < nb_hops; i += POINTER_CHASE_UNROLL){
+        POINTER_CHASE_HOPS(p) POINTER_CHASE_HOPS(p) POINTER_CHASE_HOPS(p) POINTER_CHASE_HOPS(p)
+    }
+
+    return p;
+}
+
+
+// Time per hop of a working set, in thousandths of the time unit
+static inline unsigned long long pointer_chase_hop_time(const struct pointer_chase_point* point){
+    return (point->nb_hops == 0) ? 0 : (point->time * 1000) / point->nb_hops;
+}
+
+
+/* pointer_chase_sweep
+ *
+ * Description: Builds and measures the chain of each working set, from POINTER_CHASE_MIN_SIZE doubling up to size. The chain
+ *              is walked once before it is timed (so that the caches hold what fits), and is timed over at least
+ *              POINTER_CHASE_MIN_HOPS hops. Writes "<prefix> <size> <granularity> <window> <hops> <time> <time per hop>" for
+ *              each working set
+ *
+ * Parameter:
+ *              - const char* prefix: Name of the sweep
+ *              - unsigned char* buffer: Buffer of the chains (aligned on window)
+ *              - unsigned size: Largest working set (bytes)
+ *              - unsigned granularity, unsigned window: Chains (see pointer_chase_build)
+ *              - pointer_chase_measure measure: Timing of a run
+ *              - struct pointer_chase_point* points, unsigned max_points: Where the working sets are written
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     The number of working sets measured
+ *
+ * */
+static inline unsigned pointer_chase_sweep(const char* prefix, unsigned char* buffer, unsigned size, unsigned granularity, unsigned window,
+                                           pointer_chase_measure measure, struct pointer_chase_point* points, unsigned max_points, void (*write_line)(char* line)){
+    unsigned long long hop_time;
+    unsigned set, nb_nodes, nb_points = 0;
+    char line[256];
+    void* head;
+
+    for(set = POINTER_CHASE_MIN_SIZE; set <= size && nb_points < max_points; set *= 2){
+        head = pointer_chase_build(buffer, set, granularity, window, POINTER_CHASE_SEED);
+        if(head == NULL)
+            continue;
+
+        nb_nodes = set / granularity;
+        pointer_chase_sink = pointer_chase_run(head, nb_nodes);
+
+        points[nb_points].size = set;
+        points[nb_points].nb_hops = (nb_nodes > POINTER_CHASE_MIN_HOPS) ? nb_nodes : POINTER_CHASE_MIN_HOPS;
+        points[nb_points].nb_hops = (points[nb_points].nb_hops + POINTER_CHASE_UNROLL - 1) / POINTER_CHASE_UNROLL * POINTER_CHASE_UNROLL;
+        points[nb_points].time = measure(head, points[nb_points].nb_hops);
+
+        hop_time = pointer_chase_hop_time(&points[nb_points]);
+        snprintf(line, sizeof(line), "%s %u %u %u %u %llu %llu.%03llu \n\r", prefix, set, granularity, (window == 0) ? granularity : window,
+                 points[nb_points].nb_hops, points[nb_points].time, hop_time / 1000, hop_time % 1000);
+        write_line(line);
+
+        nb_points++;
+    }
+
+    return nb_points;
+}
+
+
+/* pointer_chase_plateau
+ *
+ * Description: Median time per hop of the working sets in [lower, upper]
+ *
+ * Parameter:
+ *              - const struct pointer_chase_point* points, unsigned nb_points: Working sets of a sweep
+ *              - unsigned lower, unsigned upper: Bounds of the working sets (bytes, upper 0: no upper bound)
+ *
+ * Returns:     The median, in thousandths of the time unit, 0 when no working set is in the bounds
+ *
+ * */
+static inline unsigned long long pointer_chase_plateau(const struct pointer_chase_point* points, unsigned nb_points, unsigned lower, unsigned upper){
+    unsigned long long times[32], time;
+    unsigned i, j, nb_times = 0;
+
+    for(i = 0; i < nb_points && nb_times < sizeof(times)/sizeof(times[0]); i++){
+        if(points[i].size < lower || (upper != 0 && points[i].size > upper))
+            continue;
+
+        // Insertion sort
+        time = pointer_chase_hop_time(&points[i]);
+        for(j = nb_times; j > 0 && times[j - 1] > time; j--)
+            times[j] = times[j - 1];
+        times[j] = time;
+        nb_times++;
+    }
+
+    return (nb_times == 0) ? 0 : times[nb_times / 2];
+}
+
+
+/* pointer_chase_print_plateaus
+ *
+ * Description: Writes "plateau <prefix> <level> <time per hop>" for each level, the working sets of a level being those of at
+ *              most half its capacity and at least twice the capacity of the level below (transitions are left out). Levels
+ *              without any such working set are not written
+ *
+ * Parameter:
+ *              - const char* prefix: Name of the sweep
+ *              - const struct pointer_chase_point* points, unsigned nb_points: Working sets of the sweep
+ *              - const struct pointer_chase_level* levels, unsigned nb_levels: Levels, from the closest to the core
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void pointer_chase_print_plateaus(const char* prefix, const struct pointer_chase_point* points, unsigned nb_points,
+                                                const struct pointer_chase_level* levels, unsigned nb_levels, void (*write_line)(char* line)){
+    unsigned long long plateau;
+    unsigned l, lower = 0;
+    char line[256];
+
+    for(l = 0; l < nb_levels; l++){
+        plateau = pointer_chase_plateau(points, nb_points, lower, levels[l].size / 2);
+        if(plateau != 0){
+            snprintf(line, sizeof(line), "plateau %s %s %llu.%03llu \n\r", prefix, levels[l].name, plateau / 1000, plateau % 1000);
+            write_line(line);
+        }
+        lower = 2 * levels[l].size;
+    }
+}
+
+#endif /* POINTER_CHASE_H_ */
@@ -0,0 +1,318 @@
+/*--------------------------- stream_kernels.h ---------------------------
+ |  File stream_kernels.h
+ |
+ |  Description: STREAM-style bandwidth kernels (copy, scale, add, triad)
+ |               over three arrays of 32-bit words, vectorized for each
+ |               target: NEON vld1/vst1 on the Cortex-A15, _amem8 and
+ |               _dadd on the C66x, AVX2 or SSE4.1 on a host, plain C
+ |               otherwise. Unlike the scalar benchmarks, they can
+ |               saturate the EMIF: they give the bandwidth ceiling of
+ |               the platform and serve as a peak-bandwidth aggressor.
+ |
+ |               The achieved bandwidth is counted as STREAM does (bytes
+ |               read and written by the kernel, write allocations left
+ |               out) over the execution time, and is reported next to
+ |               the bandwidth seen by the EMIF over its PERF_CNT_TIM
+ |               cycles and the utilization of its data bus.
+ |
+ |               The functions are inline since the header is shared by
+ |               the victim and the aggressor images.
+ |
+ |  Version: 1.0
+ *-----------------------------------------------------------------------*/
+
+#ifndef STREAM_KERNELS_H_
+#define STREAM_KERNELS_H_
+
+#include <stdio.h>
+
+// Kernels
+#define STREAM_COPY  0
+#define STREAM_SCALE 1
+#define STREAM_ADD   2
+#define STREAM_TRIAD 3
+#define STREAM_NB_KERNELS 4
+
+// Scalar of the scale and triad kernels
+#define STREAM_SCALAR 3
+
+// Array sizes and offsets must be a multiple of this number of words (64 bytes, every vector width)
+#define STREAM_WORDS_ALIGN 16
+
+// Kernel names, and words read and written per element, by kernel
+static const char* const STREAM_KERNEL_NAMES[STREAM_NB_KERNELS] = {"copy", "scale", "add", "triad"};
+static const unsigned STREAM_KERNEL_WORDS[STREAM_NB_KERNELS] = {2, 2, 3, 3};
+
+// Vector of the target: words, unaligned load and store, add, multiply by a scalar
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define STREAM_VECTOR_WORDS 4
+#define STREAM_VLOAD(p) vld1q_u32(p)
+#define STREAM_VSTORE(p, v) vst1q_u32(p, v)
+#define STREAM_VADD(x, y) vaddq_u32(x, y)
+#define STREAM_VMUL(x, q) vmulq_n_u32(x, q)
+#elif defined(_TMS320C6X)
+#include <c6x.h>
+// Two words per 8-byte aligned access (arrays are 8-byte aligned)
+#define STREAM_VECTOR_WORDS 2
+#define STREAM_VLOAD(p) _amem8((void*)(p))
+#define STREAM_VSTORE(p, v) (_amem8((void*)(p)) = (v))
+#define STREAM_VADD(x, y) _dadd(x, y)
+#define STREAM_VMUL(x, q) _itoll(_mpy32(_hill(x), q), _mpy32(_loll(x), q))
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define STREAM_VECTOR_WORDS 8
+#define STREAM_VLOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define STREAM_VSTORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define STREAM_VADD(x, y) _mm256_add_epi32(x, y)
+#define STREAM_VMUL(x, q) _mm256_mullo_epi32(x, _mm256_set1_epi32(q))
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define STREAM_VECTOR_WORDS 4
+#define STREAM_VLOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define STREAM_VSTORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define STREAM_VADD(x, y) _mm_add_epi32(x, y)
+#define STREAM_VMUL(x, q) _mm_mullo_epi32(x, _mm_set1_epi32(q))
+#else
+#define STREAM_VECTOR_WORDS 1
+#define STREAM_VLOAD(p) (*(p))
+#define STREAM_VSTORE(p, v) (*(p) = (v))
+#define STREAM_VADD(x, y) ((x) + (y))
+#define STREAM_VMUL(x, q) ((x) * (q))
+#endif
+
+// Arrays of the kernels
+struct stream_arrays{
+    unsigned* a;
+    unsigned* b;
+    unsigned* c;
+    unsigned nb_words;
+};
+
+// Platform constants turning the counters into bandwidths
+struct stream_platform{
+    const char* name;
+
+    // Clock of the execution time (MHz, 1000 for nanoseconds)
+    unsigned time_mhz;
+
+    // Clock of PERF_CNT_TIM (MHz), bytes of an EMIF access, data bus bytes per PERF_CNT_TIM cycle at its peak
+    unsigned emif_mhz;
+    unsigned emif_access_bytes;
+    unsigned emif_peak_bytes;
+};
+
+// Counters of a kernel run
+struct stream_result{
+    unsigned kernel;
+    unsigned nb_words;
+    unsigned long long time;
+    unsigned long long emif_cycles;
+    unsigned long long emif_accesses;
+};
+
+
+/* stream_arrays_init
+ *
+ * Description: Places the three arrays from a base address, offset_words apart, and fills them (a = 1, b = 2, c = 0)
+ *
+ * Parameter:
+ *              - struct stream_arrays* arrays: Arrays to place
+ *              - unsigned* base: First word of a (8-byte aligned)
+ *              - unsigned nb_words: Words of each array
+ *              - unsigned offset_words: Words left between two arrays (e.g., to move b and c to other banks)
+ *
+ * Returns:     0 on success, -1 if nb_words or offset_words is not a multiple of STREAM_WORDS_ALIGN
+ *
+ * */
+static inline int stream_arrays_init(struct stream_arrays* arrays, unsigned* base, unsigned nb_words, unsigned offset_words){
+    unsigned i;
+
+    if(nb_words == 0 || nb_words % STREAM_WORDS_ALIGN != 0 || offset_words % STREAM_WORDS_ALIGN != 0)
+        return -1;
+
+    arrays->a = base;
+    arrays->b = arrays->a + nb_words + offset_words;
+    arrays->c = arrays->b + nb_words + offset_words;
+    arrays->nb_words = nb_words;
+
+    for(i = 0; i < nb_words; i++){
+        arrays->a[i] = 1;
+        arrays->b[i] = 2;
+        arrays->c[i] = 0;
+    }
+
+    return 0;
+}
+
+
+// Kernels: c = a, b = q.c, c = a + b and a = b + q.c
+static inline void stream_copy(unsigned* c, const unsigned* a, unsigned nb_words){
+    unsigned i;
+
+    for(i = 0; i < nb_words; i += STREAM_VECTOR_WORDS)
+        STREAM_VSTORE(c + i, STREAM_VLOAD(a + i));
+}
+
+
+static inline void stream_scale(unsigned* b, const unsigned* c, unsigned nb_words){
+    unsigned i;
+
+    for(i = 0; i < nb_words; i += STREAM_VECTOR_WORDS)
+        STREAM_VSTORE(b + i, STREAM_VMUL(STREAM_VLOAD(c + i), STREAM_SCALAR));
+}
+
+
+static inline void stream_add(unsigned* c, const unsigned* a, const unsigned* b, unsigned nb_words){
+    unsigned i;
+
+    for(i = 0; i < nb_words; i += STREAM_VECTOR_WORDS)
+        STREAM_VSTORE(c + i, STREAM_VADD(STREAM_VLOAD(a + i), STREAM_VLOAD(b + i)));
+}
+
+
+static inline void stream_triad(unsigned* a, const unsigned* b, const unsigned* c, unsigned nb_words){
+    unsigned i;
+
+    for(i = 0; i < nb_words; i += STREAM_VECTOR_WORDS)
+        STREAM_VSTORE(a + i, STREAM_VADD(STREAM_VLOAD(b + i), STREAM_VMUL(STREAM_VLOAD(c + i), STREAM_SCALAR)));
+}
+
+
+/* stream_run
+ *
+ * Description: Runs a kernel once over the whole arrays
+ *
+ * Parameter:
+ *              - const struct stream_arrays* arrays: Arrays (see stream_arrays_init)
+ *              - unsigned kernel: STREAM_COPY, STREAM_SCALE, STREAM_ADD or STREAM_TRIAD
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void stream_run(const struct stream_arrays* arrays, unsigned kernel){
+    switch(kernel){
+        case STREAM_COPY:
+            stream_copy(arrays->c, arrays->a, arrays->nb_words);
+            break;
+        case STREAM_SCALE:
+            stream_scale(arrays->b, arrays->c, arrays->nb_words);
+            break;
+        case STREAM_ADD:
+            stream_add(arrays->c, arrays->a, arrays->b, arrays->nb_words);
+            break;
+        default:
+            stream_triad(arrays->a, arrays->b, arrays->c, arrays->nb_words);
+            break;
+    }
+}
+
+
+// Bytes read and written by a run (STREAM counting)
+static inline unsigned long long stream_bytes(const struct stream_result* result){
+    return (unsigned long long)STREAM_KERNEL_WORDS[result->kernel] * result->nb_words * sizeof(unsigned);
+}
+
+
+// Achieved bandwidth of a run (MB/s), 0 without time
+static inline unsigned long long stream_mbps(const struct stream_platform* platform, const struct stream_result* result){
+    return (result->time == 0) ? 0 : stream_bytes(result) * platform->time_mhz / result->time;
+}
+
+
+// Bandwidth seen by the EMIF over its timer (MB/s), 0 without timer cycles
+static inline unsigned long long stream_emif_mbps(const struct stream_platform* platform, const struct stream_result* result){
+    if(result->emif_cycles == 0)
+        return 0;
+
+    return result->emif_accesses * platform->emif_access_bytes * platform->emif_mhz / result->emif_cycles;
+}
+
+
+// Utilization of the EMIF data bus (per mille of its peak), 0 without timer cycles
+static inline unsigned stream_emif_permille(const struct stream_platform* platform, const struct stream_result* result){
+    if(result->emif_cycles == 0)
+        return 0;
+
+    return (unsigned)(result->emif_accesses * platform->emif_access_bytes * 1000 / (result->emif_cycles * platform->emif_peak_bytes));
+}
+
+
+// Formats "<kernel> <bytes> <time> <MB/s> <EMIF cycles> <EMIF accesses> <EMIF MB/s> <EMIF utilization (per mille)>" after a prefix
+static inline void stream_format(const struct stream_platform* platform, const struct stream_result* result, const char* prefix, char* line, unsigned size){
+    snprintf(line, size, "%s%s %llu %llu %llu %llu %llu %llu %u \n\r", prefix, STREAM_KERNEL_NAMES[result->kernel], stream_bytes(result), result->time,
+             stream_mbps(platform, result), result->emif_cycles, result->emif_accesses, stream_emif_mbps(platform, result), stream_emif_permille(platform, result));
+}
+
+
+/* stream_print
+ *
+ * Description: Writes "<kernel> <bytes> <time> <MB/s> <EMIF cycles> <EMIF accesses> <EMIF MB/s> <EMIF utilization (per mille)>"
+ *
+ * Parameter:
+ *              - const struct stream_platform* platform: Platform constants
+ *              - const struct stream_result* result: Counters of the run
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void stream_print(const struct stream_platform* platform, const struct stream_result* result, void (*write_line)(char* line)){
+    char line[256];
+
+    stream_format(platform, result, "", line, sizeof(line));
+    write_line(line);
+}
+
+
+/* stream_ceiling_update
+ *
+ * Description: Keeps the run of highest achieved bandwidth of each kernel
+ *
+ * Parameter:
+ *              - const struct stream_platform* platform: Platform constants
+ *              - struct stream_result* best: STREAM_NB_KERNELS best runs, cleared to 0 before the first update
+ *              - const struct stream_result* result: Counters of the run
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void stream_ceiling_update(const struct stream_platform* platform, struct stream_result* best, const struct stream_result* result){
+    if(best[result->kernel].time == 0 || stream_mbps(platform, result) > stream_mbps(platform, &best[result->kernel]))
+        best[result->kernel] = *result;
+}
+
+
+/* stream_print_ceiling
+ *
+ * Description: Writes the best run of each kernel prefixed by "ceiling", then "ceiling <platform> <MB/s>", the highest of them
+ *
+ * Parameter:
+ *              - const struct stream_platform* platform: Platform constants
+ *              - const struct stream_result* best: STREAM_NB_KERNELS best runs (see stream_ceiling_update)
+ *              - void (*write_line)(char* line): Output function (e.g., write_UART_THR)
+ *
+ * Returns:     Nothing
+ *
+ * */
+static inline void stream_print_ceiling(const struct stream_platform* platform, const struct stream_result* best, void (*write_line)(char* line)){
+    unsigned long long ceiling = 0;
+    unsigned kernel;
+    char line[256];
+
+    for(kernel = 0; kernel < STREAM_NB_KERNELS; kernel++){
+        if(best[kernel].time == 0)
+            continue;
+
+        stream_format(platform, &best[kernel], "ceiling ", line, sizeof(line));
+        write_line(line);
+
+        if(stream_mbps(platform, &best[kernel]) > ceiling)
+            ceiling = stream_mbps(platform, &best[kernel]);
+    }
+
+    snprintf(line, sizeof(line), "ceiling %s %llu \n\r", platform->name, ceiling);
+    write_line(line);
+}
+
+#endif /* STREAM_KERNELS_H_ */